@@ -0,0 +1,94 @@
+#!/bin/sh
+#
+# Regression checks for vesta, run by "make check" in src/.
+# Each check prints "PASS:" or "FAIL:" and the script exits
+# non-zero if any check fails.
+
+VESTA=${VESTA:-./vesta}
+LIB=${LIB:-../tech/osu035/osu035_stdcells.lib}
+TESTS=`dirname $0`
+TMP=${TMPDIR:-/tmp}/vesta_check.$$
+fails=0
+
+mkdir -p $TMP
+trap "rm -rf $TMP" 0
+
+pass() {
+    echo "PASS:  $1"
+}
+
+fail() {
+    echo "FAIL:  $1"
+    fails=`expr $fails + 1`
+}
+
+# The rising and falling columns of an SDF IOPATH come from the
+# rise and fall tables.  In osu035, NAND2X1 is slower to fall
+# than to rise from input B, so the falling column is the larger.
+
+$VESTA -p 1000 -f $TMP/edges.sdf $TESTS/sdf_edges.v $LIB > $TMP/edges.out 2>&1
+iopath=`grep "IOPATH B Y" $TMP/edges.sdf`
+rise=`echo "$iopath" | sed -e 's/.*IOPATH B Y ([^:]*::\([^)]*\)) ([^:]*::\([^)]*\)).*/\1/'`
+fall=`echo "$iopath" | sed -e 's/.*IOPATH B Y ([^:]*::\([^)]*\)) ([^:]*::\([^)]*\)).*/\2/'`
+if test -z "$iopath"; then
+    fail "SDF has no IOPATH from B to Y"
+elif awk "BEGIN {exit !($fall > $rise)}"; then
+    pass "SDF IOPATH rise ($rise ps) and fall ($fall ps) delays"
+else
+    fail "SDF IOPATH rise and fall delays are swapped or merged:  $iopath"
+fi
+
+# A timing model of a module must be no more optimistic than the
+# flattened module:  at each register input, the longest path of
+# the model is no shorter, and its shortest path no longer, than
+# those of the flattened design.  Clocks are propagated, as the
+# model includes the clock insertion delay inside the module.
+
+endpoints() {
+    awk '/^Top .* maximum/ {m = "max"} /^Top .* minimum/ {m = "min"}
+	/^Path group/ {g = $3}
+	/^Path .* delay / && !/output pin/ {
+	    for (i = 1; $i != "delay"; i++);
+	    print m, g, $(i - 1), $(i + 1)
+	}' $1
+}
+
+$VESTA -c -p 1000 -n 100 $TESTS/etm_hier.v $LIB > $TMP/model.out 2>&1
+$VESTA -c -p 1000 -n 100 -F '*' $TESTS/etm_hier.v $LIB > $TMP/flat.out 2>&1
+endpoints $TMP/flat.out > $TMP/flat.ends
+endpoints $TMP/model.out > $TMP/model.ends
+if awk 'BEGIN {bad = 0; n = 0}
+	{
+	    k = $1 " " $2 " " $3
+	    v = (FILENAME == ARGV[1]) ? "f" : "m"
+	    if (!((v, k) in d) || (($1 == "max") ? ($4 > d[v, k]) : ($4 < d[v, k])))
+		d[v, k] = $4
+	    if (v == "m") keys[k] = 1
+	}
+	END {
+	    for (k in keys) {
+		n++
+		split(k, w, " ")
+		if (!(("f", k) in d)) {
+		    print "    no flattened path to " w[3] " (" w[2] ")"
+		    bad = 1
+		}
+		else if ((w[1] == "max" && d["m", k] < d["f", k] - 0.01) ||
+			(w[1] == "min" && d["m", k] > d["f", k] + 0.01)) {
+		    print "    " w[1] " delay to " w[3] " (" w[2] "):  model " \
+			    d["m", k] " ps, flattened " d["f", k] " ps"
+		    bad = 1
+		}
+	    }
+	    exit (bad || (n == 0))
+	}' $TMP/flat.ends $TMP/model.ends; then
+    pass "Timing model paths to registers bound the flattened paths"
+else
+    fail "Timing model is more optimistic than the flattened module"
+fi
+
+if test $fails -gt 0; then
+    echo "$fails check(s) failed."
+    exit 1
+fi
+exit 0
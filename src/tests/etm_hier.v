@@ -0,0 +1,39 @@
+module core (clk, rst, a, b, y, z);
+input clk;
+input rst;
+input a;
+input b;
+output y;
+output z;
+wire n1, n2, n3, n4, q1, q2, q3, clkb, clkb2, div;
+
+CLKBUF1 cb1 (.A(clk), .Y(clkb));
+BUFX2 cb2 (.A(clkb), .Y(clkb2));
+DFFPOSX1 f1 (.D(n1), .CLK(clkb), .Q(q1));
+DFFPOSX1 f2 (.D(n2), .CLK(clkb2), .Q(q2));
+DFFNEGX1 f3 (.D(n3), .CLK(clkb), .Q(q3));
+NAND2X1 g1 (.A(a), .B(q2), .Y(n1));
+XOR2X1 g2 (.A(q1), .B(b), .Y(n2));
+INVX1 g3 (.A(n2), .Y(n3));
+AND2X2 g4 (.A(q3), .B(q1), .Y(n4));
+BUFX2 g5 (.A(n4), .Y(y));
+DFFSR f4 (.D(q3), .CLK(clkb2), .R(rst), .S(b), .Q(z));
+endmodule
+
+module top (clk, rst, a, b, y, z, w);
+input clk;
+input rst;
+input a;
+input b;
+output y;
+output z;
+output w;
+wire y1, z1, y2, t1, t2;
+
+core u1 (.clk(clk), .rst(rst), .a(a), .b(b), .y(y1), .z(z1));
+core u2 (.clk(clk), .rst(rst), .a(t1), .b(z1), .y(y2), .z(z));
+DFFPOSX1 r1 (.D(y1), .CLK(clk), .Q(t1));
+INVX1 i1 (.A(y2), .Y(t2));
+DFFPOSX1 r2 (.D(t2), .CLK(clk), .Q(w));
+BUFX2 o1 (.A(t2), .Y(y));
+endmodule
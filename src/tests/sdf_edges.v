@@ -0,0 +1,7 @@
+module top (a, b, y);
+input a;
+input b;
+output y;
+
+NAND2X1 g1 (.A(a), .B(b), .Y(y));
+endmodule
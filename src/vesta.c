@@ -14,10 +14,44 @@
 /*								*/
 /*		-d <delay_file>	Wiring delays (see below)	*/
 /*		-p <value>  	Clock period, in ps		*/
+/*		-n <number>	Paths reported per path group	*/
 /*		-l <value>	Output load, in fF		*/
+/*		-w <name>	Wire load model name		*/
+/*		-r <drc_file>	Design rule violations output	*/
+/*		-x <endpoint|N>	Extract fan-in cone of endpoint	*/
+/*				or of N worst paths		*/
+/*		-o <file.v>	Fan-in cone output file		*/
+/*		-k <file>	Clock latency and skew report	*/
 /*		-v <level>	set verbose mode		*/
 /*		-V		report version number		*/
 /*		-e		exhaustive search		*/
+/*		-L		parse only cells that are used	*/
+/*		-b <inst/pin>	break loops at this gate input	*/
+/*		-F <inst>	flatten this module instance	*/
+/*				("*" for all) in place of its	*/
+/*				extracted timing model		*/
+/*		-D <derate_file> On-chip variation derates	*/
+/*		-c		propagated clocks with clock	*/
+/*				reconvergence pessimism removal	*/
+/*		-C <file>	Net criticality output, for	*/
+/*				timing-driven placement		*/
+/*		-z <file>	Slack of every pin output	*/
+/*		-P <inst/pin>	Report the slack of one pin	*/
+/*		-a <file.spef>	Wire parasitics, replacing the	*/
+/*				wire load model estimate	*/
+/*		-m <file>	Per-net pi models, for driver	*/
+/*				effective capacitance		*/
+/*		-f <file.sdf>	SDF delays for gate-level	*/
+/*				simulation			*/
+/*		-s <file>	save the timing graph database	*/
+/*		-S <file>	load a saved timing graph in	*/
+/*				place of <name.v> <name.lib>	*/
+/*		-A <number>	Re-time this many worst paths by	*/
+/*				path-based analysis		*/
+/*		-T		Round delays to a fixed time	*/
+/*				step, for results that do not	*/
+/*				depend on the thread count	*/
+/*		-j <number>	maximum number of threads	*/
 /*								*/
 /*	Currently the only output this tool generates is a	*/
 /*	list of paths with negative slack.  If no paths have	*/
@@ -27,7 +61,17 @@
 /*	clock period is set to equal the delay of the longest	*/
 /*	delay path, and the 20 paths with the smallest positive	*/
 /*	slack are output, following a statement indicated the	*/
-/*	computed minimum clock period.				*/
+/*	computed minimum clock period.  Paths are grouped by	*/
+/*	launching and capturing clock and by type (input or	*/
+/*	register to register or output), and each group is	*/
+/*	reported with its worst and total negative slack.	*/
+/*	The asynchronous set and reset inputs of flops are	*/
+/*	checked against their recovery and removal times, and	*/
+/*	the enables of gates on the clock network against the	*/
+/*	clock at the gate (clock gating setup and hold).	*/
+/*	Each module instanced by another is timed once, and	*/
+/*	its instances are replaced by its extracted timing	*/
+/*	model, unless flattened with -F.			*/
 /*--------------------------------------------------------------*/
 
 /*--------------------------------------------------------------*/
@@ -52,10 +96,21 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <math.h>	// Temporary, for fabs()
+#include <unistd.h>	// For sysconf()
+#include <pthread.h>
+#include <fcntl.h>	// For open()
+#include <sys/mman.h>	// For mmap()
+#include <sys/stat.h>	// For fstat()
  
 #define LIB_LINE_MAX  65535
 
-int fileCurrentLine;
+// Line count and tokenizer state (see advancetoken()) are kept per
+// thread, so that the liberty file and the verilog netlist can be
+// read at the same time.
+
+__thread int fileCurrentLine;
+__thread char tokenline[LIB_LINE_MAX];
+__thread char *tokenpos = NULL;
 
 // Analysis types --- note that maximum flop-to-flop delay
 // requires calculating minimum clock skew time, and vice
@@ -65,6 +120,11 @@ int fileCurrentLine;
 #define MINIMUM_TIME	0
 #define MAXIMUM_TIME	1
 
+// Resolution of delays with --fixed-time (see fixed_time()), in ps.
+// A power of two, so that sums of delays are exact in a double.
+
+#define TIME_STEP	(1.0 / 1024.0)
+
 // Multiple-use definition
 #define	UNKNOWN		-1
 
@@ -148,6 +208,7 @@ int fileCurrentLine;
 #define TERMINAL	0x08	// DFF input (path terminal)
 #define LATCHTERM	0x10	// Latch input (dependent path terminal)
 #define ENABLE		0x20	// Latch enable (path start)
+#define GATING		0x40	// Clock gating input (path terminal)
 
 // Cell types
 #define GATE		0x00	// Combinatorial gate (default)
@@ -212,15 +273,27 @@ typedef struct _lutable {
         double *caps;	// Cap array (units fF)
         double *cons;	// Constrained pin transition time array (units ps)
     } idx2;
-    double *values;	// Matrix of values (used locally, not for templates)
+    double *values;	// Matrix of values, size1 rows of size2 (not for templates)
+    double *rspan1;	// Reciprocal spans of idx1 (see table_finish())
+    double *rspan2;	// Reciprocal spans of idx2
+    double (*vecfunc)(lutableptr, double *, double);	// vector_get_value() kernel
+    double (*binfunc)(lutableptr, double, double);	// binomial_get_value() kernel
     lutableptr next;
 } lutable;
 
+// Find the index "i" of the upper of the two entries of the ascending
+// array "idx" of "n" entries that bound "x", or of the nearest two
+// entries if extrapolating.  Requires n >= 2.
+
+#define TABLE_SEARCH(idx, n, x, i) \
+    for (i = 1; i < (n) - 1; i++) if ((idx)[i] > (x)) break
+
 typedef struct _pin *pinptr;
 typedef struct _cell *cellptr;
 
 typedef struct _pin {
     char *name;
+    char *alias;	// Module pin that a timing model pin stands for, or NULL
     short type;
 
     double capr;	// Capacitance for rising input
@@ -231,6 +304,12 @@ typedef struct _pin {
     lutable *propdelf;	// Reference table for falling output prop delay relative to driver
     lutable *transr;	// Reference table for transition rise time
     lutable *transf;	// Reference table for transition fall time
+    lutable *minpropdelr;	// Early (minimum) tables, with the same indexes,
+    lutable *minpropdelf;	// for timing models (see make_etm()), or NULL
+    lutable *mintransr;	// to use the tables above
+    lutable *mintransf;
+    lutable *recovery;	// Recovery time table for releasing a set or reset
+    lutable *removal;	// Removal time table for releasing a set or reset
 
     cellptr refcell;	// Pointer back to parent cell
 
@@ -245,9 +324,77 @@ typedef struct _cell {
     double area;
     double maxtrans;	/* Maximum transition time */
     double maxcap;	/* Maximum allowable load */
+    int	   libindex;	/* Index of unparsed cell group (lazy mode), or -1 */
+    double early;	/* Early (minimum) delay derate, or 0 for global */
+    double late;	/* Late (maximum) delay derate, or 0 for global */
     cellptr next;
 } cell;
 
+// Wire load model (liberty "wire_load" group).  Wire length is
+// estimated from the fanout of a net, and the length is multiplied
+// by capacitance and resistance per unit length.
+
+typedef struct _wireload *wireloadptr;
+
+typedef struct _wireload {
+    char   *name;
+    double capacitance;	/* Capacitance per unit length (fF) */
+    double resistance;	/* Resistance per unit length (kOhm) */
+    double slope;	/* Length added per fanout beyond the table */
+    int    entries;	/* Number of fanout_length entries */
+    int    *fanout;	/* Fanout values, in ascending order */
+    double *length;	/* Wire length for each fanout value */
+    wireloadptr next;
+} wireload;
+
+// One "wire_load_from_area" entry of a liberty "wire_load_selection" group
+
+typedef struct _wlselect *wlselptr;
+
+typedef struct _wlselect {
+    char   *name;	/* Name of the selection group */
+    double minarea;	/* Range of design area . . . */
+    double maxarea;
+    char   *wlname;	/* . . . for which this wire load model is used */
+    wlselptr next;
+} wlselect;
+
+// Lazy liberty loading:  A brace-matching scan of the liberty file
+// records the position of each cell group.  Cell groups are skipped
+// when reading the library, and each cell is parsed when it is first
+// instanced in the netlist.
+
+typedef struct _libindex {
+    char *name;		/* Cell name */
+    long start;		/* File offset of the "cell" keyword */
+    long end;		/* File offset just past the closing brace */
+    int  startline;	/* Number of lines before "start" */
+    int  endline;	/* Number of lines before "end" */
+} libindex;
+
+typedef struct _lazyload {
+    FILE     *file;	/* Liberty file, kept open for reading cells */
+    lutable  *tables;	/* Table templates */
+    double   time_unit;	/* Library time unit multiplier */
+    double   cap_unit;	/* Library capacitance unit multiplier */
+    libindex *cells;	/* Cell groups, in file order */
+    int      numcells;
+    int      next;	/* Next cell group expected by libertyRead() */
+    int      numparsed;	/* Number of cells parsed so far */
+} lazyload;
+
+// Liberty file reader arguments and results (see libertyReadThread())
+
+typedef struct _libreadargs {
+    FILE     *flib;
+    char     lazy;
+    lutable  *tables;
+    cell     *cells;
+    wireload *wireloads;
+    wlselect *wlselections;
+    int	     lines;		/* Number of lines read */
+} libreadargs;
+
 /*--------------------------------------------------------------*/
 /* Verilog netlist database					*/
 /*--------------------------------------------------------------*/
@@ -255,6 +402,7 @@ typedef struct _cell {
 typedef struct _net *netptr;
 typedef struct _connect *connptr;
 typedef struct _delaydata *ddataptr;
+typedef struct _clockdata *clkptr;
 
 typedef struct _net {
    char *name;
@@ -264,10 +412,25 @@ typedef struct _net {
    connptr *receivers;
    double loadr;	/* Total load capacitance for rising input */
    double loadf;	/* Total load capacitance for falling input */
+   double slew;		/* Worst transition time found on the net */
+   double wirecap;	/* Wire capacitance from parasitics, or -1 if none */
+   double cnear;	/* Pi model near capacitance (see readPiModels()) */
+   double rpi;		/* Pi model resistance, or -1 if no pi model */
+   double cfar;		/* Pi model far capacitance */
+   double ceff[2];	/* Effective capacitance seen by the driver, by edge */
+   unsigned char flags;	/* Marks used when extracting fan-in cones */
+   clkptr clkdata;	/* Clock arrival times, if in the clock network */
+   double arrival[2];	/* Latest arrival, by edge (see compute_arrival_times()) */
+   double atrans[2];	/* Transition time at the latest arrival */
+   double minarrival[2];	/* Earliest arrival, by edge */
+   double mintrans[2];	/* Transition time at the earliest arrival */
+   double required[2];	/* Latest time meeting setup, by edge */
+   double minrequired[2];	/* Earliest time meeting hold, by edge */
    netptr next;
 } net;
 
 typedef struct _instance *instptr;
+typedef struct _pathgroup *groupptr;
 
 typedef struct _connect {
    double   metric;		/* Delay metric at connection */
@@ -275,10 +438,20 @@ typedef struct _connect {
    pinptr   refpin;
    netptr   refnet;
    ddataptr tag;		/* Tag value for checking for loops and endpoints */
+   ddataptr worst;		/* Worst path ending here (see add_group_path()) */
+   double   wiredelay;		/* Wire delay from the net driver to this receiver */
+   double   required[2];	/* Setup required time by edge (see net_required()) */
+   double   minrequired[2];	/* Hold required time by edge */
    double   *prvector;		/* Prop delay rising (at load condition) vector */
    double   *pfvector;		/* Prop delay falling (at load condition) vector */
+   double   *prminvector;	/* Prop delay rising, derated for minimum timing */
+   double   *pfminvector;	/* Prop delay falling, derated for minimum timing */
    double   *trvector;		/* Transition time rising (at load condition) vector */
    double   *tfvector;		/* Transition time falling (at load condition) vector */
+   double   *trminvector;	/* Transition time rising, for minimum timing */
+   double   *tfminvector;	/* Transition time falling, for minimum timing */
+   char	    *pinname;		/* Pin name, until bound to refpin by bindCells() */
+   unsigned char flags;		/* Loop-breaking flags (see break_loops()) */
    connptr  next;
 } connect;
 
@@ -287,9 +460,69 @@ typedef struct _instance {
    cellptr refcell;
    connptr in_connects;
    connptr out_connects;
+   char *cellname;	/* Cell name, until bound to refcell by bindCells() */
+   unsigned char flags;	/* Marks used when extracting fan-in cones */
+   int index;		/* Position in topological order (see break_loops()) */
+   int depth;		/* Logic depth of paths through the gate (for AOCV) */
+   double borrow;	/* Latch:  time borrowed past the opening edge */
+   double opentime;	/* Launch (latch: opening) edge, after rising clock edge */
+   double dtrans;	/* Latch:  transition time of the latest data arrival */
    instptr next;
 } instance;
 
+// A verilog module.  The netlist of a module instanced by another
+// module is replaced in the parent by the module's extracted timing
+// model (see make_etm()), or by a copy of its contents if flattened.
+
+#define MOD_NEW		0	// Sub-modules not yet expanded
+#define MOD_BUSY	1	// Being expanded (for finding recursion)
+#define MOD_FLAT	2	// Sub-modules expanded
+#define MOD_ETM		3	// Timing model extracted
+
+// Number of input transition times and output loads in the tables
+// of an extracted timing model
+
+#define ETM_GRID	5
+
+typedef struct _module *moduleptr;
+
+typedef struct _module {
+   char *name;
+   netptr netlist;
+   instptr instlist;
+   connptr inputlist;
+   connptr outputlist;
+   cellptr *etm;	/* Cells of the extracted timing model */
+   int numetm;
+   int uses;		/* Number of instances in other modules */
+   char state;		/* MOD_NEW, MOD_BUSY, MOD_FLAT, or MOD_ETM */
+   moduleptr next;
+} module;
+
+// Connection flags for combinational loops
+
+#define CONN_BROKEN	0x01	// Timing arc is cut to break a loop
+#define CONN_PREFER	0x02	// Preferred arc at which to break a loop
+
+// Connection flags for clock gating checks (see assign_net_types())
+
+#define CONN_GATE_HIGH	0x04	// Gating input, held while the clock is high
+#define CONN_GATE_LOW	0x08	// Gating input, held while the clock is low
+#define CONN_GATE_ENABLE 0x10	// Any input of a clock gate other than the clock
+
+// Net and instance flags for fan-in cone extraction
+
+#define CONE_TRACED	0x01	// Net fan-in has been traced
+#define CONE_USED	0x02	// Net is connected to an instance in the cone
+#define CONE_OUTPUT	0x04	// Net is an output of the extracted netlist
+#define CONE_INST	0x01	// Instance is part of the cone
+#define CONE_LOAD	0x02	// Instance is a load on a net in the cone
+#define CONE_MEMBER	(CONE_INST | CONE_LOAD)
+
+// Net flag for the effective capacitance (see compute_ceff())
+
+#define NET_CEFF	0x08	// Net ceff[] is up to date with its pi model
+
 // Linked list of delays (backtrace to source)
 
 typedef struct _btdata *btptr;
@@ -309,9 +542,33 @@ typedef struct _delaydata {
    double delay;	/* Total delay, including setup and clock skew */
    double trans;	/* Transition time at destination, used to find setup */
    btptr backtrace;
+   groupptr  group;	/* Path group, if this is the worst path to its endpoint */
+   ddataptr  endnext;	/* Worst path to the same endpoint in another group */
    ddataptr  next;
 } delaydata;
 
+// Path groups.  Paths are grouped by the clocks that launch and
+// capture them and by the kind of start and end point, and each
+// group keeps the worst path to each of its endpoints, its worst
+// "maxpaths" paths in order, and its worst and total negative slack.
+
+#define PATH_IN_REG	0	// Module input to register
+#define PATH_REG_REG	1	// Register to register
+#define PATH_REG_OUT	2	// Register to module output
+#define PATH_IN_OUT	3	// Module input to module output
+
+typedef struct _pathgroup {
+   netptr   launch;	/* Launching clock root, or NULL for module inputs */
+   netptr   capture;	/* Capturing clock root, or NULL for module outputs */
+   short    type;	/* One of the PATH_* types */
+   int      numends;	/* Number of endpoints in the group */
+   int      numworst;	/* Number of paths in "worst" */
+   ddataptr *worst;	/* Worst paths, worst first, up to "maxpaths" */
+   double   wns;	/* Worst slack */
+   double   tns;	/* Total of the negative slacks of the endpoints */
+   groupptr next;
+} pathgroup;
+
 // Linked list of connection pointers
 // (Much like delaydata, but without all the timing information)
 
@@ -322,24 +579,364 @@ typedef struct _connlist {
    connlistptr next;
 } connlist;
 
+// Clock arrival times on a net in the clock network, relative to an
+// edge at the clock root.  Arrays are indexed by the edge direction
+// on the net (CLKEDGE(RISING) or CLKEDGE(FALLING)).  "srcdir" records
+// which edge(s) at the root produce the edge on the net.
+
+#define CLKEDGE(dir)	(((dir) == FALLING) ? 1 : 0)
+
+#define CLK_VISITING	1	// Net is on the traversal stack
+#define CLK_ORDERED	2	// Net has been added to the traversal order
+#define CLK_DONE	3	// Arrival times have been computed
+
+typedef struct _clockdata {
+   netptr root;		/* Source of the clock (input or flop output) */
+   double mindelay[2];	/* Earliest arrival (insertion delay) */
+   double maxdelay[2];	/* Latest arrival (insertion delay) */
+   double mintrans[2];	/* Transition time at earliest arrival */
+   double maxtrans[2];	/* Transition time at latest arrival */
+   short  srcdir[2];	/* Root edge(s) producing this edge, or 0 */
+   short  state;	/* Traversal state */
+   netptr parent;	/* Clock net on the latest arriving input, or NULL */
+   int    depth;	/* Number of nets between the root and this net */
+   int    tourpos;	/* First position in the clock tree tour */
+} clockdata;
+
+// Euler tour of the clock network, as a forest of trees following the
+// "parent" links of the clock nets.  The sparse table finds the net of
+// least depth between two positions of the tour, which is the common
+// point of two clock nets, in constant time (see build_clock_tree()).
+
+typedef struct _clocktree {
+   int    length;	/* Number of entries in the tour */
+   int    levels;	/* Number of levels in the sparse table */
+   netptr *tour;	/* Nets in the order visited */
+   int    **sparse;	/* Position of the least depth in tour[i .. i + 2^k - 1] */
+   int    *log2;	/* Floor of log base 2, for 1 to "length" */
+} clocktree;
+
+// Design rule violation (maximum load or transition time)
+
+#define DRC_MAXCAP	0
+#define DRC_MAXTRANS	1
+
+typedef struct _drcviol *drcptr;
+
+typedef struct _drcviol {
+   netptr net;		/* Net with the violation */
+   short  type;		/* DRC_MAXCAP or DRC_MAXTRANS */
+   double value;	/* Load (fF) or transition time (ps) on the net */
+   double limit;	/* Maximum allowed value */
+} drcviol;
+
+// Recovery and removal check at an asynchronous set or reset pin
+
+typedef struct _asyncchk *asyncptr;
+
+typedef struct _asyncchk {
+   connptr conn;	/* Set or reset pin */
+   short  edge;		/* Releasing edge (0 = rising, 1 = falling) */
+   double slack;	/* Recovery slack (ps) */
+   double minslack;	/* Removal slack (ps) */
+} asyncchk;
+
+// Setup and hold check at a clock gating input
+
+typedef struct _gatingchk *gatingptr;
+
+typedef struct _gatingchk {
+   connptr conn;	/* Gating input pin */
+   short  edge;		/* Edge with the worst setup slack */
+   short  minedge;	/* Edge with the worst hold slack */
+   double slack;	/* Setup slack (ps) */
+   double minslack;	/* Hold slack (ps) */
+} gatingchk;
+
+// Paths re-timed by path-based analysis (see report_pba())
+
+typedef struct _pbadata {
+   ddataptr *paths;	/* Paths, worst first */
+   double   *delay;	/* Path-based delay of each path */
+   char     minmax;	/* MAXIMUM_TIME or MINIMUM_TIME */
+} pbadata;
+
+/*--------------------------------------------------------------*/
+/* Parallel processing						*/
+/*--------------------------------------------------------------*/
+
+// Range of work items handled by one thread
+
+typedef struct _workrange *workptr;
+
+typedef struct _workrange {
+   int   start;		/* First work item */
+   int   end;		/* One past the last work item */
+   int   thread;	/* Index of the thread doing the work */
+   void  *data;		/* Data shared by all threads */
+   void  (*func)(void *, int, int, int);
+} workrange;
+
+// A lookup table collapsed at one load value and scaled by a derating
+// factor.  Table, load, and factor triples are unique, and the vector
+// is shared by all connections using it.
+
+typedef struct _collapse {
+   lutableptr table;
+   double     load;
+   double     scale;	/* Derating factor applied to the vector */
+   double     *vector;
+} collapse;
+
+// Hash table of unique table, load, and factor triples
+
+typedef struct _collapsetab {
+   collapse *keys;	/* Unique triples, in order of first use */
+   int      numkeys;
+   int      *hash;	/* Index into keys, or -1 if unused */
+   unsigned int mask;	/* Hash table size minus one */
+} collapsetab;
+
+// Data shared by the load computation threads
+
+typedef struct _loaddata {
+   netptr   *nets;	/* Array of all nets */
+   double   out_load;	/* Load of a module output pin */
+   double   *wlcap;	/* Wire capacitance by fanout, or NULL */
+   double   *wlres;	/* Wire resistance by fanout, or NULL */
+   collapse *keys;	/* Table, load, and factor triples to collapse */
+} loaddata;
+
+// Depth-based on-chip variation (AOCV) table (see readDerates()).
+// Derates are interpolated between depth entries, and are clipped to
+// the first and last entries outside the table.
+
+typedef struct _aocvtable {
+   int    entries;	/* Number of depth entries */
+   int    *depth;	/* Logic depth values, in ascending order */
+   double *early;	/* Early (minimum) delay derate at each depth */
+   double *late;	/* Late (maximum) delay derate at each depth */
+} aocvtable;
+
+// SPEF parasitics (see readSPEF()).  The file is read one net at a
+// time, and the RC network of each net is kept only until it has been
+// reduced to a total capacitance and an Elmore delay to each receiver.
+
+#define SPEF_NONE	0	// Header, or sections that are not read
+#define SPEF_NAMEMAP	1	// *NAME_MAP entries
+#define SPEF_CONN	2	// *CONN section of a net
+#define SPEF_CAP	3	// *CAP section of a net
+#define SPEF_RES	4	// *RES section of a net
+
+typedef struct _spefmap {
+   int      index;	/* *NAME_MAP index, or -1 if the slot is unused */
+   netptr   net;	/* Net of the mapped name, if any */
+   instptr  inst;	/* Instance of the mapped name, if any */
+} spefmap;
+
+typedef struct _spefnode {
+   int      name;	/* Offset of the node name in the name buffer */
+   connptr  conn;	/* Pin connection at the node, if any */
+   double   cap;	/* Capacitance to ground at the node (fF) */
+   double   csub;	/* Capacitance at and downstream of the node */
+   double   delay;	/* Elmore delay from the driver (ohm * fF) */
+   double   res;	/* Resistance to the parent node (ohms) */
+   int      parent;	/* Next node toward the driver, or -1 */
+   int      edges;	/* First resistor at the node, or -1 */
+   int      slot;	/* Position of the node in the hash table */
+} spefnode;
+
+typedef struct _spefres {
+   int      node[2];	/* Nodes at each end */
+   int      next[2];	/* Next resistor at each end's node, or -1 */
+   double   res;	/* Resistance (ohms) */
+} spefres;
+
+typedef struct _spefreader {
+   spefmap  *map;	/* Hash table of the *NAME_MAP */
+   unsigned int mapmask;
+   int      mapsize;
+   netptr   *nets;	/* Hash table of nets by name */
+   unsigned int netmask;
+   instptr  *insts;	/* Hash table of instances by name */
+   unsigned int instmask;
+   netptr   curnet;	/* Net of the current *D_NET, or NULL */
+   double   totcap;	/* Total capacitance of the current net */
+   int      driver;	/* Node of the current net's driver, or -1 */
+   spefnode *nodes;	/* Nodes of the current net */
+   int      numnodes;
+   int      maxnodes;
+   int      *nodehash;	/* Hash table of node indexes by name */
+   unsigned int nodemask;
+   int      *order;	/* Nodes in order of distance from the driver */
+   spefres  *res;	/* Resistors of the current net */
+   int      numres;
+   int      maxres;
+   char     *names;	/* Node names of the current net */
+   int      namelen;
+   int      maxnames;
+   double   cunit;	/* Capacitance unit in fF */
+   double   runit;	/* Resistance unit in ohms */
+   char     delim;	/* Pin delimiter */
+} spefreader;
+
+// Timing database snapshot (see save_db() and load_db()).  The file
+// is an image of the linked netlist, in which every pointer is stored
+// as an offset from the start of the file (0 for NULL).  A table of
+// records at the end gives the position, size, and kind of each object,
+// so that loading needs only to map the file and convert the offsets
+// back to pointers.
+
+#define DB_MAGIC	"VESTADB1"
+
+#define DB_RAW		0	// Strings and arrays of values (no pointers)
+#define DB_PTRS		1	// Array of pointers
+#define DB_TABLE	2
+#define DB_PIN		3
+#define DB_CELL		4
+#define DB_NET		5
+#define DB_CONN		6
+#define DB_INST		7
+
+typedef struct _dbrecord {
+   unsigned long long offset;	/* Position of the object in the file */
+   unsigned long long size;	/* Size of the object in bytes */
+   int    kind;			/* One of the DB_* kinds */
+   int    pad;
+} dbrecord;
+
+typedef struct _dbheader {
+   char   magic[8];
+   unsigned int sizes[6];	/* Sizes of the database structures */
+   unsigned long long size;	/* Size of the file */
+   unsigned long long records;	/* Offset of the record table */
+   unsigned long long numrecords;
+   unsigned long long netlist;	/* Offsets of the lists . . . */
+   unsigned long long instlist;
+   unsigned long long inputlist;
+   unsigned long long outputlist;
+   unsigned long long cells;
+   unsigned long long tables;
+   unsigned long long toporder;
+   unsigned long long topmodule;
+   int    numtoporder;
+   int    pad;
+} dbheader;
+
+// Objects being written to a snapshot, and a hash table of their
+// addresses, to find each object's record.
+
+typedef struct _dbwriter {
+   dbrecord *records;
+   void     **objects;	/* Address of each object in memory */
+   int      numrecords;
+   int      maxrecords;
+   unsigned long long size;	/* Size of the file laid out so far */
+   int      *hash;	/* Record index for each address, or -1 */
+   unsigned int mask;	/* Hash table size minus one */
+   int      errors;	/* Pointers to objects not in the snapshot */
+} dbwriter;
+
 /* Global variables */
 
 unsigned char verbose;		/* Level of debug output generated */
 unsigned char exhaustive;	/* Exhaustive search mode */
+unsigned char cppr;		/* Clock reconvergence pessimism removal */
+int numthreads;			/* Maximum number of worker threads */
+int maxpaths;			/* Number of paths reported for each path group */
+int pbapaths;			/* Paths re-timed by path-based analysis */
+
+char *default_wireload = NULL;	/* Liberty "default_wire_load" */
+char *default_wlselect = NULL;	/* Liberty "default_wire_load_selection" */
+char *topmodule = NULL;		/* Name of the verilog module read */
+lazyload *lazylib = NULL;	/* Liberty cell index, in lazy mode */
+instptr *toporder = NULL;	/* Combinational instances in topological order */
+int numtoporder = 0;
+double derate_early = 1.0;	/* Global early (minimum) delay derate */
+double derate_late = 1.0;	/* Global late (maximum) delay derate */
+aocvtable *aocv = NULL;		/* Depth-based derates, or NULL */
+char fixedtime = 0;		/* Round delays to TIME_STEP (see fixed_time()) */
+clocktree *clktree = NULL;	/* Common point lookup for clock nets */
+
+/*--------------------------------------------------------------*/
+/* Thread pool:  Run "func" on work items 0 to (count - 1),	*/
+/* splitting the items evenly among up to "numthreads" threads.	*/
+/* "func" is called with the shared data, the range of items	*/
+/* to work on, and the index of the thread doing the work.  The	*/
+/* calling thread takes the last share of the work, and the	*/
+/* routine returns when all threads have finished.		*/
+/*--------------------------------------------------------------*/
+
+void *run_worker(void *arg)
+{
+    workptr work = (workptr)arg;
+
+    (*work->func)(work->data, work->start, work->end, work->thread);
+    return NULL;
+}
+
+void run_parallel(int count, void (*func)(void *, int, int, int), void *data)
+{
+    pthread_t *threads;
+    workrange *work;
+    char *started;
+    int n, nthreads, chunk;
+
+    nthreads = (numthreads < count) ? numthreads : count;
+    if (nthreads <= 1) {
+	if (count > 0) (*func)(data, 0, count, 0);
+	return;
+    }
+
+    threads = (pthread_t *)malloc(nthreads * sizeof(pthread_t));
+    work = (workrange *)malloc(nthreads * sizeof(workrange));
+    started = (char *)calloc(nthreads, sizeof(char));
+
+    chunk = (count + nthreads - 1) / nthreads;
+    for (n = 0; n < nthreads; n++) {
+	work[n].start = n * chunk;
+	work[n].end = (n + 1) * chunk;
+	if (work[n].start > count) work[n].start = count;
+	if (work[n].end > count) work[n].end = count;
+	work[n].thread = n;
+	work[n].data = data;
+	work[n].func = func;
+    }
+
+    // If a thread cannot be created, just do its work here.
+
+    for (n = 0; n < nthreads - 1; n++) {
+	if (pthread_create(&threads[n], NULL, run_worker, &work[n]) == 0)
+	    started[n] = 1;
+	else
+	    run_worker(&work[n]);
+    }
+    run_worker(&work[nthreads - 1]);
+
+    for (n = 0; n < nthreads - 1; n++)
+	if (started[n])
+	    pthread_join(threads[n], NULL);
+
+    free(started);
+    free(work);
+    free(threads);
+}
 
 /*--------------------------------------------------------------*/
 /* Grab a token from the input					*/
 /* Return the token, or NULL if we have reached end-of-file.	*/
+/*								*/
+/* The current line and position are kept in "tokenline" and	*/
+/* "tokenpos".  Set tokenpos to NULL after moving the file	*/
+/* position with fseek(), to discard the rest of the line.	*/
 /*--------------------------------------------------------------*/
 
 char *
 advancetoken(FILE *flib, char delimiter)
 {
-    static char token[LIB_LINE_MAX];
-    static char line[LIB_LINE_MAX];
-    static char *linepos = NULL;
+    static __thread char token[LIB_LINE_MAX];
 
-    char *lineptr = linepos;
+    char *lineptr = tokenpos;
     char *lptr, *tptr;
     char *result;
     int commentblock, concat, nest;
@@ -362,12 +959,12 @@ advancetoken(FILE *flib, char delimiter)
 	}
 
 	if (lineptr == NULL || *lineptr == '\n' || *lineptr == '\0') {
-	    result = fgets(line, LIB_LINE_MAX, flib);
+	    result = fgets(tokenline, LIB_LINE_MAX, flib);
 	    fileCurrentLine++;
 	    if (result == NULL) return NULL;
 
 	    /* Keep pulling stuff in if the line ends with a continuation character */
- 	    lptr = line;
+ 	    lptr = tokenline;
 	    while (*lptr != '\n' && *lptr != '\0') {
 		if (*lptr == '\\') {
 		    // To be considered a line continuation marker, there must be
@@ -376,7 +973,7 @@ advancetoken(FILE *flib, char delimiter)
 		    char *eptr = lptr + 1;
 		    while (isspace(*eptr)) eptr++;
 		    if (*eptr == '\0') {
-		        result = fgets(lptr, LIB_LINE_MAX - (lptr - line), flib);
+		        result = fgets(lptr, LIB_LINE_MAX - (lptr - tokenline), flib);
 		        fileCurrentLine++;
 		        if (result == NULL) break;
 		    }
@@ -387,7 +984,7 @@ advancetoken(FILE *flib, char delimiter)
 		    lptr++;
 	    }	
 	    if (result == NULL) return NULL;
-	    lineptr = line;
+	    lineptr = tokenline;
 	}
 
 	if (commentblock == 1) continue;
@@ -396,7 +993,7 @@ advancetoken(FILE *flib, char delimiter)
 	if (concat == 0)
 	    tptr = token;
 
-	// Find the next token and return just the token.  Update linepos
+	// Find the next token and return just the token.  Update tokenpos
 	// to the position just beyond the token.  All delimiters like
 	// parentheses, quotes, etc., are returned as single tokens
 
@@ -454,7 +1051,7 @@ advancetoken(FILE *flib, char delimiter)
     if (delimiter != 0) lineptr++;
 
     while (isspace(*lineptr)) lineptr++;
-    linepos = lineptr;
+    tokenpos = lineptr;
 
     // Final:  Remove trailing whitespace
     tptr = token + strlen(token) - 1;
@@ -465,6 +1062,22 @@ advancetoken(FILE *flib, char delimiter)
     return token;
 }
 
+/*--------------------------------------------------------------*/
+/* Remove surrounding whitespace and quotes from a token, in	*/
+/* place, and return a pointer to the result.			*/
+/*--------------------------------------------------------------*/
+
+char *unquote(char *token)
+{
+    char *eptr;
+
+    while (isspace(*token) || (*token == '\"')) token++;
+    eptr = token + strlen(token);
+    while ((eptr > token) && (isspace(*(eptr - 1)) || (*(eptr - 1) == '\"')))
+	*(--eptr) = '\0';
+    return token;
+}
+
 /*--------------------------------------------------------------*/
 /* Parse a pin name.  Check if the cell has a pin of that name,	*/
 /* and if not, add the pin to the cell, giving it default	*/
@@ -510,6 +1123,7 @@ pinptr parse_pin(cellptr newcell, char *token, short sense_predef)
 
     newpin = (pin *)malloc(sizeof(pin));
     newpin->name = strdup(pinname);
+    newpin->alias = NULL;
     newpin->next = NULL;
 
     if (lastpin != NULL)
@@ -525,6 +1139,12 @@ pinptr parse_pin(cellptr newcell, char *token, short sense_predef)
     newpin->propdelf = NULL;
     newpin->transr = NULL;
     newpin->transf = NULL;
+    newpin->minpropdelr = NULL;
+    newpin->minpropdelf = NULL;
+    newpin->mintransr = NULL;
+    newpin->mintransf = NULL;
+    newpin->recovery = NULL;
+    newpin->removal = NULL;
     newpin->refcell = newcell;	// Create link back to cell
     return newpin;
 }
@@ -546,56 +1166,122 @@ netptr create_net(netptr *netlist) {
     newnet->receivers = NULL;
     newnet->loadr = 0.0;
     newnet->loadf = 0.0;
+    newnet->slew = 0.0;
+    newnet->wirecap = -1.0;
+    newnet->cnear = newnet->cfar = 0.0;
+    newnet->rpi = -1.0;
+    newnet->ceff[0] = newnet->ceff[1] = 0.0;
+    newnet->flags = 0;
+    newnet->clkdata = NULL;
     newnet->type = NET;
 
     return newnet;
 }
 
+/*--------------------------------------------------------------*/
+/* Create a new instance record named "name" of cell		*/
+/* "cellname", to be bound to the cell by bindCells()		*/
+/*--------------------------------------------------------------*/
+
+instptr create_instance(instptr *instlist, char *name, char *cellname) {
+
+    instptr newinst;
+
+    newinst = (instptr)malloc(sizeof(instance));
+    newinst->next = *instlist;
+    *instlist = newinst;
+    newinst->name = strdup(name);
+    newinst->refcell = NULL;
+    newinst->cellname = strdup(cellname);
+    newinst->in_connects = NULL;
+    newinst->out_connects = NULL;
+    newinst->flags = 0;
+    newinst->index = 0;
+    newinst->depth = 0;
+    newinst->borrow = 0.0;
+    newinst->opentime = 0.0;
+    newinst->dtrans = 0.0;
+
+    return newinst;
+}
+
+/*--------------------------------------------------------------*/
+/* Create a connection of pin "pinname" of instance "newinst"	*/
+/* to net "testnet".  As in verilogRead(), all connections	*/
+/* are kept in in_connects until bound by bindCells().		*/
+/*--------------------------------------------------------------*/
+
+connptr create_connect(instptr newinst, char *pinname, netptr testnet) {
+
+    connptr newconn, *connlast;
+
+    newconn = (connptr)malloc(sizeof(connect));
+    for (connlast = &newinst->in_connects; *connlast; connlast = &(*connlast)->next);
+    *connlast = newconn;
+    newconn->next = NULL;
+    newconn->refinst = newinst;
+    newconn->refpin = NULL;
+    newconn->refnet = testnet;
+    newconn->tag = NULL;
+    newconn->wiredelay = 0.0;
+    newconn->metric = -1.0;
+    newconn->prvector = NULL;
+    newconn->pfvector = NULL;
+    newconn->prminvector = NULL;
+    newconn->pfminvector = NULL;
+    newconn->trvector = NULL;
+    newconn->tfvector = NULL;
+    newconn->trminvector = NULL;
+    newconn->tfminvector = NULL;
+    newconn->pinname = strdup(pinname);
+    newconn->flags = 0;
+
+    return newconn;
+}
+
 /*----------------------------------------------------------------------*/
 /* Interpolate or extrapolate a vector from a time vs. capacitance	*/
-/* lookup table.							*/
+/* lookup table.  table_collapse_into() writes the result into		*/
+/* "vector", which must hold tableptr->size1 values;  table_collapse()	*/
+/* allocates the vector and returns it.					*/
 /*----------------------------------------------------------------------*/
 
-double *table_collapse(lutableptr tableptr, double load)
+void table_collapse_into(lutableptr tableptr, double load, double *vector)
 {
-    double *vector;
     double cfrac, vlow, vhigh;
     int i, j;
 
-    vector = (double *)malloc(tableptr->size1 * sizeof(double));
-
     // If the table is 1-dimensional, then just return a copy of the table.
     if (tableptr->size2 <= 1) {
        for (i = 0; i < tableptr->size1; i++) {
 	  *(vector + i) = *(tableptr->values + i);
        }
-       return vector;
+       return;
     }
 
     // Find cap load index entries bounding  "load", or the two nearest
     // entries, if extrapolating
 
-    if (load < tableptr->idx2.caps[0])
-	j = 1;
-    else if (load >= tableptr->idx2.caps[tableptr->size2 - 1])
-	j = tableptr->size2 - 1;
-    else {
-	for (j = 0; j < tableptr->size2; j++)
-	    if (tableptr->idx2.caps[j] > load)
-		break;
-    }
+    TABLE_SEARCH(tableptr->idx2.caps, tableptr->size2, load, j);
 
-    cfrac = (load - tableptr->idx2.caps[j - 1]) /
-			(tableptr->idx2.caps[j] - tableptr->idx2.caps[j - 1]);
+    cfrac = (load - tableptr->idx2.caps[j - 1]) * tableptr->rspan2[j];
 
     for (i = 0; i < tableptr->size1; i++) {
 
 	// Interpolate value at cap load for each transition value
 
-	vlow = *(tableptr->values + i * tableptr->size1 + (j - 1));
-	vhigh = *(tableptr->values + i * tableptr->size1 + j);
+	vlow = *(tableptr->values + i * tableptr->size2 + (j - 1));
+	vhigh = *(tableptr->values + i * tableptr->size2 + j);
 	*(vector + i) = vlow + (vhigh - vlow) * cfrac;
     }
+}
+
+double *table_collapse(lutableptr tableptr, double load)
+{
+    double *vector;
+
+    vector = (double *)malloc(tableptr->size1 * sizeof(double));
+    table_collapse_into(tableptr, load, vector);
     return vector;
 }
 
@@ -603,31 +1289,28 @@ double *table_collapse(lutableptr tableptr, double load)
 /* Interpolate/extrapolate a delay or transition value from a vector of	*/
 /* values at a known output load.  The original full 2D table contains	*/
 /* the transition time index values.					*/
+/*									*/
+/* The work is done by the kernel selected for the table's shape by	*/
+/* table_set_kernels().  This is the general kernel, for any size.	*/
 /*----------------------------------------------------------------------*/
 
-double vector_get_value(lutableptr tableptr, double *vector, double trans)
+double vector_get_value_any(lutableptr tableptr, double *vector, double trans)
 {
     int i;
     double tfrac, vlow, vhigh, value;
 
+    if (tableptr->size1 < 2)
+	return (tableptr->size1 == 1) ? vector[0] : 0.0;
+
     // Find time index entries bounding  "trans", or the two nearest
     // entries, if extrapolating
 
-    if (trans < tableptr->idx1.times[0])
-	i = 1;
-    else if (trans >= tableptr->idx1.times[tableptr->size1 - 1])
-	i = tableptr->size1 - 1;
-    else {
-	for (i = 0; i < tableptr->size1; i++)
-	    if (tableptr->idx1.times[i] > trans)
-		break;
-    }
+    TABLE_SEARCH(tableptr->idx1.times, tableptr->size1, trans, i);
 
     // Compute transition time as a fraction of the nearest table indexes
     // for transition times
 
-    tfrac = (trans - tableptr->idx1.times[i - 1]) /
-		(tableptr->idx1.times[i] - tableptr->idx1.times[i - 1]);
+    tfrac = (trans - tableptr->idx1.times[i - 1]) * tableptr->rspan1[i];
 
     // Interpolate value
     vlow = *(vector + (i - 1));
@@ -636,12 +1319,19 @@ double vector_get_value(lutableptr tableptr, double *vector, double trans)
     return value;
 }
 
+double vector_get_value(lutableptr tableptr, double *vector, double trans)
+{
+    return (*tableptr->vecfunc)(tableptr, vector, trans);
+}
+
 /*----------------------------------------------------------------------*/
 /* Interpolate or extrapolate a value from a related time vs.		*/
 /* constrained time lookup table.					*/
+/*									*/
+/* As for vector_get_value(), this is the general kernel.		*/
 /*----------------------------------------------------------------------*/
 
-double binomial_get_value(lutableptr tableptr, double rtrans, double ctrans)
+double binomial_get_value_any(lutableptr tableptr, double rtrans, double ctrans)
 {
     int i, j;
     double rfrac, cfrac, vlow, vhigh, valuel, valueh, value;
@@ -649,28 +1339,22 @@ double binomial_get_value(lutableptr tableptr, double rtrans, double ctrans)
     /* Tables have been arranged such that idx1 is related time,	*/
     /* idx2 is constrained time */
 
+    if (tableptr->size1 < 2)
+	return (tableptr->size1 == 1) ? tableptr->values[0] : 0.0;
+
     // Find time index entries bounding  "rtrans", or the two nearest
     // entries, if extrapolating
 
-    if (rtrans < tableptr->idx1.rel[0])
-	i = 1;
-    else if (rtrans >= tableptr->idx1.rel[tableptr->size1 - 1])
-	i = tableptr->size1 - 1;
-    else {
-	for (i = 0; i < tableptr->size1; i++)
-	    if (tableptr->idx1.rel[i] > rtrans)
-		break;
-    }
+    TABLE_SEARCH(tableptr->idx1.rel, tableptr->size1, rtrans, i);
 
     // Compute transition time as a fraction of the nearest table indexes
     // for transition times
 
-    rfrac = (rtrans - tableptr->idx1.rel[i - 1]) /
-		(tableptr->idx1.rel[i] - tableptr->idx1.rel[i - 1]);
+    rfrac = (rtrans - tableptr->idx1.rel[i - 1]) * tableptr->rspan1[i];
 
     // 1-dimensional computation, if this table is 1-dimensional
 
-    if (tableptr->size2 == 0) {
+    if (tableptr->size2 <= 1) {
 	vlow = *(tableptr->values + (i - 1));
 	vhigh = *(tableptr->values + i);
 	value = vlow + (vhigh - vlow) * rfrac;
@@ -680,29 +1364,20 @@ double binomial_get_value(lutableptr tableptr, double rtrans, double ctrans)
     // Find cons index entries bounding  "ctrans", or the two nearest
     // entries, if extrapolating
 
-    if (ctrans < tableptr->idx2.cons[0])
-	j = 1;
-    else if (ctrans >= tableptr->idx2.cons[tableptr->size2 - 1])
-	j = tableptr->size2 - 1;
-    else {
-	for (j = 0; j < tableptr->size2; j++)
-	    if (tableptr->idx2.cons[j] > ctrans)
-		break;
-    }
+    TABLE_SEARCH(tableptr->idx2.cons, tableptr->size2, ctrans, j);
 
     // Compute cons transition as a fraction of the nearest table indexes for cons
 
-    cfrac = (ctrans - tableptr->idx2.cons[j - 1]) /
-			(tableptr->idx2.cons[j] - tableptr->idx2.cons[j - 1]);
+    cfrac = (ctrans - tableptr->idx2.cons[j - 1]) * tableptr->rspan2[j];
 
     // Interpolate value at cons lower bound
-    vlow = *(tableptr->values + (i - 1) * tableptr->size1 + (j - 1));
-    vhigh = *(tableptr->values + i * tableptr->size1 + (j - 1));
+    vlow = *(tableptr->values + (i - 1) * tableptr->size2 + (j - 1));
+    vhigh = *(tableptr->values + i * tableptr->size2 + (j - 1));
     valuel = vlow + (vhigh - vlow) * rfrac;
 
     // Interpolate value at cons upper bound
-    vlow = *(tableptr->values + (i - 1) * tableptr->size1 + j);
-    vhigh = *(tableptr->values + i * tableptr->size1 + j);
+    vlow = *(tableptr->values + (i - 1) * tableptr->size2 + j);
+    vhigh = *(tableptr->values + i * tableptr->size2 + j);
     valueh = vlow + (vhigh - vlow) * rfrac;
 
     // Final interpolation (binomial interpolation)
@@ -710,6 +1385,191 @@ double binomial_get_value(lutableptr tableptr, double rtrans, double ctrans)
     return value;
 }
 
+double binomial_get_value(lutableptr tableptr, double rtrans, double ctrans)
+{
+    return (*tableptr->binfunc)(tableptr, rtrans, ctrans);
+}
+
+/*----------------------------------------------------------------------*/
+/* Interpolation kernels for fixed table sizes.  With the size known at	*/
+/* compile time, the index search and the table offsets unroll to	*/
+/* straight-line code.  VECTOR_KERNEL(N) defines the kernel for a	*/
+/* vector of N transition times, and BINOMIAL_KERNEL(R, C) defines the	*/
+/* kernel for a constraint table of R related times by C constrained	*/
+/* times.  Add shapes to "vector_kernels" and "binomial_kernels" to	*/
+/* make them available to table_set_kernels().				*/
+/*----------------------------------------------------------------------*/
+
+#define VECTOR_KERNEL(N) \
+double vector_get_value_##N(lutableptr tableptr, double *vector, double trans) \
+{ \
+    double *times = tableptr->idx1.times; \
+    int i; \
+ \
+    TABLE_SEARCH(times, N, trans, i); \
+    return vector[i - 1] + (vector[i] - vector[i - 1]) * \
+		(trans - times[i - 1]) * tableptr->rspan1[i]; \
+}
+
+#define BINOMIAL_KERNEL(R, C) \
+double binomial_get_value_##R##x##C(lutableptr tableptr, double rtrans, double ctrans) \
+{ \
+    double *rel = tableptr->idx1.rel; \
+    double *cons = tableptr->idx2.cons; \
+    double *lo, *hi; \
+    double rfrac, cfrac, valuel, valueh; \
+    int i, j; \
+ \
+    TABLE_SEARCH(rel, R, rtrans, i); \
+    TABLE_SEARCH(cons, C, ctrans, j); \
+    rfrac = (rtrans - rel[i - 1]) * tableptr->rspan1[i]; \
+    cfrac = (ctrans - cons[j - 1]) * tableptr->rspan2[j]; \
+ \
+    lo = tableptr->values + (i - 1) * C + (j - 1); \
+    hi = lo + C; \
+    valuel = lo[0] + (hi[0] - lo[0]) * rfrac; \
+    valueh = lo[1] + (hi[1] - lo[1]) * rfrac; \
+    return valuel + (valueh - valuel) * cfrac; \
+}
+
+VECTOR_KERNEL(2)
+VECTOR_KERNEL(3)
+VECTOR_KERNEL(4)
+VECTOR_KERNEL(5)
+VECTOR_KERNEL(6)
+VECTOR_KERNEL(7)
+VECTOR_KERNEL(8)
+
+BINOMIAL_KERNEL(3, 3)
+BINOMIAL_KERNEL(3, 5)
+BINOMIAL_KERNEL(3, 6)
+BINOMIAL_KERNEL(5, 5)
+BINOMIAL_KERNEL(6, 6)
+BINOMIAL_KERNEL(7, 7)
+
+struct {
+    int size;
+    double (*func)(lutableptr, double *, double);
+} vector_kernels[] = {
+    {2, vector_get_value_2},
+    {3, vector_get_value_3},
+    {4, vector_get_value_4},
+    {5, vector_get_value_5},
+    {6, vector_get_value_6},
+    {7, vector_get_value_7},
+    {8, vector_get_value_8},
+    {0, NULL}
+};
+
+struct {
+    int size1;
+    int size2;
+    double (*func)(lutableptr, double, double);
+} binomial_kernels[] = {
+    {3, 3, binomial_get_value_3x3},
+    {3, 5, binomial_get_value_3x5},
+    {3, 6, binomial_get_value_3x6},
+    {5, 5, binomial_get_value_5x5},
+    {6, 6, binomial_get_value_6x6},
+    {7, 7, binomial_get_value_7x7},
+    {0, 0, NULL}
+};
+
+/*----------------------------------------------------------------------*/
+/* Compute the reciprocal spans of the table indexes, so that the	*/
+/* kernels multiply instead of divide, and select the kernels for the	*/
+/* shape of the table.  Entry 0 of each span array is not used.		*/
+/*----------------------------------------------------------------------*/
+
+double *table_spans(double *index, int size)
+{
+    double *rspan;
+    int i;
+
+    if (size < 2) return NULL;
+    rspan = (double *)malloc(size * sizeof(double));
+    rspan[0] = 0.0;
+    for (i = 1; i < size; i++)
+	rspan[i] = 1.0 / (index[i] - index[i - 1]);
+    return rspan;
+}
+
+void table_set_kernels(lutableptr tableptr)
+{
+    int k;
+
+    tableptr->vecfunc = vector_get_value_any;
+    for (k = 0; vector_kernels[k].size > 0; k++)
+	if (vector_kernels[k].size == tableptr->size1) {
+	    tableptr->vecfunc = vector_kernels[k].func;
+	    break;
+	}
+
+    tableptr->binfunc = binomial_get_value_any;
+    for (k = 0; binomial_kernels[k].size1 > 0; k++)
+	if ((binomial_kernels[k].size1 == tableptr->size1) &&
+		(binomial_kernels[k].size2 == tableptr->size2)) {
+	    tableptr->binfunc = binomial_kernels[k].func;
+	    break;
+	}
+}
+
+/*----------------------------------------------------------------------*/
+/* Finish a table after reading it from the liberty file.  Templates	*/
+/* ("reftable" NULL) get their reciprocal spans.  Tables that keep	*/
+/* the index values of their template share the template's index and	*/
+/* span arrays instead of keeping copies.				*/
+/*----------------------------------------------------------------------*/
+
+void table_finish(lutableptr tableptr, lutableptr reftable)
+{
+    if ((reftable != NULL) && (reftable->size1 == tableptr->size1) &&
+		(tableptr->size1 > 0) && !memcmp(tableptr->idx1.times,
+		reftable->idx1.times, tableptr->size1 * sizeof(double))) {
+	free(tableptr->idx1.times);
+	tableptr->idx1.times = reftable->idx1.times;
+	tableptr->rspan1 = reftable->rspan1;
+    }
+    else
+	tableptr->rspan1 = table_spans(tableptr->idx1.times, tableptr->size1);
+
+    if ((reftable != NULL) && (reftable->size2 == tableptr->size2) &&
+		(tableptr->size2 > 0) && !memcmp(tableptr->idx2.caps,
+		reftable->idx2.caps, tableptr->size2 * sizeof(double))) {
+	free(tableptr->idx2.caps);
+	tableptr->idx2.caps = reftable->idx2.caps;
+	tableptr->rspan2 = reftable->rspan2;
+    }
+    else
+	tableptr->rspan2 = table_spans(tableptr->idx2.caps, tableptr->size2);
+
+    table_set_kernels(tableptr);
+}
+
+/*----------------------------------------------------------------------*/
+/* List the distinct shapes (time entries x load or constrained time	*/
+/* entries) of the table templates.  Shapes marked with "*" have no	*/
+/* specialized interpolation kernel and use the general one.		*/
+/*----------------------------------------------------------------------*/
+
+void report_table_shapes(lutableptr tablelist)
+{
+    lutableptr testtable, prevtable;
+
+    fprintf(stdout, "Table template shapes:");
+    for (testtable = tablelist; testtable; testtable = testtable->next) {
+	for (prevtable = tablelist; prevtable != testtable; prevtable = prevtable->next)
+	    if ((prevtable->size1 == testtable->size1) &&
+			(prevtable->size2 == testtable->size2))
+		break;
+	if (prevtable != testtable) continue;
+	fprintf(stdout, " %dx%d%s", testtable->size1, testtable->size2,
+		((testtable->vecfunc == vector_get_value_any) &&
+		(testtable->binfunc == binomial_get_value_any)) ? "*" : "");
+    }
+    fprintf(stdout, "\n");
+}
+
 /*----------------------------------------------------------------------*/
 /* Determine how the sense of a signal changes going from a gate's 	*/
 /* input to its output.  If the gate's input pin is positive unate	*/
@@ -751,6 +1611,24 @@ short calc_dir(pinptr testpin, short dir)
     return outdir;
 }
 
+/*--------------------------------------------------------------*/
+/* Return the delay "t" (in ps) rounded to a whole number of	*/
+/* TIME_STEP if "fixedtime" is set, or "t" unchanged if not.	*/
+/* Delays from the tables are rounded as they are read, so	*/
+/* that every arrival time is an integer count of TIME_STEP	*/
+/* held in a double.  Such sums are exact (up to 2^53 steps),	*/
+/* so they do not depend on the order in which delays are	*/
+/* added or merged, and results are the same bit for bit	*/
+/* whatever the number of threads.  Transition times and the	*/
+/* table interpolation stay in floating point.			*/
+/*--------------------------------------------------------------*/
+
+double fixed_time(double t)
+{
+    if (!fixedtime) return t;
+    return TIME_STEP * rint(t / TIME_STEP);
+}
+
 /*----------------------------------------------------------------------*/
 /* Calculate the propagation delay from "testpin" to the output		*/
 /* of the gate to which "testpin" is an input.				*/
@@ -772,6 +1650,7 @@ double calc_prop_delay(double trans, connptr testconn, short sense, char minmax)
 {
     pinptr testpin;
     double propdelayr, propdelayf;
+    double *prvector, *pfvector;
 
     propdelayr = 0.0;
     propdelayf = 0.0;
@@ -779,15 +1658,22 @@ double calc_prop_delay(double trans, connptr testconn, short sense, char minmax)
     testpin = testconn->refpin;
     if (testpin == NULL) return 0.0;
 
+    // Vectors are derated for early or late timing (see computeLoads())
+
+    prvector = (minmax == MAXIMUM_TIME) ? testconn->prvector : testconn->prminvector;
+    pfvector = (minmax == MAXIMUM_TIME) ? testconn->pfvector : testconn->pfminvector;
+
     if (sense != SENSE_NEGATIVE) {
-	if (testconn->prvector)
-	    propdelayr = vector_get_value(testpin->propdelr, testconn->prvector, trans);
+	if (prvector)
+	    propdelayr = fixed_time(vector_get_value(testpin->propdelr, prvector,
+			trans));
 	if (sense == SENSE_POSITIVE) return propdelayr;
     }
 
     if (sense != SENSE_POSITIVE) {
-	if (testconn->pfvector)
-	    propdelayf = vector_get_value(testpin->propdelf, testconn->pfvector, trans);
+	if (pfvector)
+	    propdelayf = fixed_time(vector_get_value(testpin->propdelf, pfvector,
+			trans));
 	if (sense == SENSE_NEGATIVE) return propdelayf;
     }
 
@@ -808,6 +1694,7 @@ double calc_transition(double trans, connptr testconn, short sense, char minmax)
 {
     pinptr testpin;
     double transr, transf;
+    double *trvector, *tfvector;
 
     testpin = testconn->refpin;
     if (testpin == NULL) return 0.0;
@@ -815,15 +1702,18 @@ double calc_transition(double trans, connptr testconn, short sense, char minmax)
     transr = 0.0;
     transf = 0.0;
 
+    trvector = (minmax == MAXIMUM_TIME) ? testconn->trvector : testconn->trminvector;
+    tfvector = (minmax == MAXIMUM_TIME) ? testconn->tfvector : testconn->tfminvector;
+
     if (sense != SENSE_NEGATIVE) {
-	if (testconn->trvector)
-	    transr = vector_get_value(testpin->transr, testconn->trvector, trans);
+	if (trvector)
+	    transr = vector_get_value(testpin->transr, trvector, trans);
 	if (sense == SENSE_POSITIVE) return transr;
     }
 
     if (sense != SENSE_POSITIVE) {
-	if (testconn->tfvector)
-	    transf = vector_get_value(testpin->transf, testconn->tfvector, trans);
+	if (tfvector)
+	    transf = vector_get_value(testpin->transf, tfvector, trans);
 	if (sense == SENSE_NEGATIVE) return transf;
     }
 
@@ -853,13 +1743,15 @@ double calc_hold_time(double trans, pinptr testpin, double clktrans, short sense
 
     if (sense != SENSE_NEGATIVE) {
 	if (testpin->transr)
-	    holdr = binomial_get_value(testpin->transr, trans, clktrans);
+	    holdr = fixed_time(binomial_get_value(testpin->transr, trans,
+			clktrans));
 	if (sense == SENSE_POSITIVE) return holdr;
     }
 
     if (sense != SENSE_POSITIVE) {
 	if (testpin->transf)
-	    holdf = binomial_get_value(testpin->transf, trans, clktrans);
+	    holdf = fixed_time(binomial_get_value(testpin->transf, trans,
+			clktrans));
 	if (sense == SENSE_NEGATIVE) return holdf;
     }
 
@@ -889,13 +1781,15 @@ double calc_setup_time(double trans, pinptr testpin, double clktrans, short sens
 
     if (sense != SENSE_NEGATIVE) {
 	if (testpin->propdelr)
-	    setupr = binomial_get_value(testpin->propdelr, trans, clktrans);
+	    setupr = fixed_time(binomial_get_value(testpin->propdelr, trans,
+			clktrans));
 	if (sense == SENSE_POSITIVE) return setupr;
     }
 
     if (sense != SENSE_POSITIVE) {
 	if (testpin->propdelf)
-	    setupf = binomial_get_value(testpin->propdelf, trans, clktrans);
+	    setupf = fixed_time(binomial_get_value(testpin->propdelf, trans,
+			clktrans));
 	if (sense == SENSE_NEGATIVE) return setupf;
     }
 
@@ -905,10 +1799,99 @@ double calc_setup_time(double trans, pinptr testpin, double clktrans, short sens
 	return (setupr < setupf) ? setupr : setupf;
 }
 
+/*----------------------------------------------------------------------*/
+/* Calculate the recovery time (if "minmax" is MAXIMUM_TIME) or the	*/
+/* removal time (if "minmax" is MINIMUM_TIME) for a flop set or reset	*/
+/* input "testpin" relative to the flop clock, where "trans" is the	*/
+/* transition time of the signal releasing the set or reset at		*/
+/* "testpin", and "clktrans" is the transition time of the clock	*/
+/* signal at the clock pin.						*/
+/*----------------------------------------------------------------------*/
+
+double calc_recovery_time(double trans, pinptr testpin, double clktrans, char minmax)
+{
+    lutable *table;
+
+    if (testpin == NULL) return 0.0;
+
+    table = (minmax == MAXIMUM_TIME) ? testpin->recovery : testpin->removal;
+    if (table == NULL) return 0.0;
+    return fixed_time(binomial_get_value(table, trans, clktrans));
+}
+
+/*--------------------------------------------------------------*/
+/* Return the edge (0 for rising, 1 for falling) that releases	*/
+/* the flop set or reset input "testconn":  Rising for an	*/
+/* active-low set or reset, and falling for an active-high one.	*/
+/*--------------------------------------------------------------*/
+
+int async_release_edge(connptr testconn)
+{
+    short type = testconn->refinst->refcell->type;
+
+    if (testconn->refpin->type & DFFRST)
+	return (type & RST_SENSE_MASK) ? 0 : 1;
+    else
+	return (type & SET_SENSE_MASK) ? 0 : 1;
+}
+
+/*--------------------------------------------------------------*/
+/* Given an instance record, find the pin of the instance that	*/
+/* is the clock, if the instance is a flop, or the enable, if	*/
+/* the instance is a latch.  Otherwise, return NULL.		*/
+/*--------------------------------------------------------------*/
+
+connptr find_register_clock(instptr testinst)
+{
+    connptr testconn;
+
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	if (testconn->refpin && (testconn->refpin->type & (DFFCLK | LATCHEN)))
+	    return testconn;
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the data input connection of latch "testinst", or	*/
+/* NULL if it has none.						*/
+/*--------------------------------------------------------------*/
+
+connptr find_latch_data(instptr testinst)
+{
+    connptr testconn;
+
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	if (testconn->refpin && (testconn->refpin->type & LATCHIN))
+	    return testconn;
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the active clock edge (RISING or FALLING) of flop or	*/
+/* latch "testinst".  For a latch, this is the edge that opens	*/
+/* it.								*/
+/*--------------------------------------------------------------*/
+
+short register_edge(instptr testinst)
+{
+    short type = testinst->refcell->type;
+
+    if (type & LATCH)
+	return (type & EN_SENSE_MASK) ? FALLING : RISING;
+    else
+	return (type & CLK_SENSE_MASK) ? FALLING : RISING;
+}
+
 /*--------------------------------------------------------------*/
-/* Find the path from a clock back to all inputs or flop	*/
-/* outputs.  This list will be used to find nodes that are	*/
-/* common to other clocks.					*/
+/* Find the path from a clock back to all inputs.  A clock	*/
+/* from a register output (e.g., a clock divider) is generated	*/
+/* by the register, and the path continues back through the	*/
+/* register's clock at its active edge.  The gating inputs of	*/
+/* clock gates (see find_clock_gates()) are not followed, so a	*/
+/* register driving one is not a clock source.  This list will	*/
+/* be used to find nodes that are common to other clocks.	*/
 /*--------------------------------------------------------------*/
 
 void
@@ -917,7 +1900,7 @@ find_clock_source(connptr testlink, btptr *clocklist, short dir)
     netptr clknet;
     connptr driver, iinput;
     instptr iupstream;
-    btptr newclock;
+    btptr newclock, testclock;
     short newdir;
 
     /* Add this connection record to clocklist */
@@ -937,9 +1920,24 @@ find_clock_source(connptr testlink, btptr *clocklist, short dir)
     iupstream = driver->refinst;
 
     if (iupstream == NULL) return;		/* Not supposed to happen? */
-    if (driver->refpin->type & DFFOUT) return;	/* Reached a flop output */
+
+    if ((driver->refpin->type & DFFOUT) || (iupstream->refcell->type & (DFF | LATCH))) {
+	/* Reached a register output:  Follow the generated clock	*/
+	/* back to its master, unless the register is already on	*/
+	/* the path (a register clocked by its own output, or a	*/
+	/* ring of registers).						*/
+
+	iinput = find_register_clock(iupstream);
+	if ((iinput == NULL) || (iinput->flags & CONN_BROKEN)) return;
+	for (testclock = *clocklist; testclock; testclock = testclock->next)
+	    if (testclock->receiver == iinput)
+		return;
+	find_clock_source(iinput, clocklist, register_edge(iupstream));
+	return;
+    }
 
     for (iinput = iupstream->in_connects; iinput; iinput = iinput->next) {
+	if (iinput->flags & (CONN_BROKEN | CONN_GATE_ENABLE)) continue;
 	newdir = calc_dir(iinput->refpin, dir);
 	find_clock_source(iinput, clocklist, newdir);
     }
@@ -992,6 +1990,7 @@ find_clock_delay(int dir, double delay, double trans, connptr receiver,
     int	    i;
 
     testpin = receiver->refpin;
+    if (receiver->flags & CONN_BROKEN) return;
 
     // Stop when receiver matches terminal.
 
@@ -1019,11 +2018,11 @@ find_clock_delay(int dir, double delay, double trans, connptr receiver,
 	if (loadnet != NULL) {
 	    for (i = 0; i < loadnet->fanout; i++) {
 		if (outdir & RISING)
-		    find_clock_delay(RISING, newdelayr, newtransr, loadnet->receivers[i],
-				clocklist, terminal, minmax);
+		    find_clock_delay(RISING, newdelayr + loadnet->receivers[i]->wiredelay,
+				newtransr, loadnet->receivers[i], clocklist, terminal, minmax);
 		if (outdir & FALLING)
-		    find_clock_delay(FALLING, newdelayf, newtransf, loadnet->receivers[i],
-				clocklist, terminal, minmax);
+		    find_clock_delay(FALLING, newdelayf + loadnet->receivers[i]->wiredelay,
+				newtransf, loadnet->receivers[i], clocklist, terminal, minmax);
 	    }
 	}
     }
@@ -1113,11 +2112,10 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
 	}
     }
 
-    // Check for a logic loop, and truncate the path to avoid infinite
-    // looping in the path search.
+    // Combinational loops have been cut by break_loops(), so the
+    // search cannot loop as long as it stops at broken arcs.
 
-    if (receiver->tag == (ddataptr)(-1)) return numpaths;
-    else if (receiver->tag == NULL) receiver->tag = (ddataptr)(-1);
+    if (receiver->flags & CONN_BROKEN) return numpaths;
 
     // Record this position and delay/transition information
 
@@ -1151,20 +2149,26 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
 	}
 
 	loadnet = (testinst) ? testinst->out_connects->refnet : receiver->refnet;
+
 	for (i = 0; i < loadnet->fanout; i++) {
 	    if (outdir & RISING)
-		numpaths += find_path_delay(RISING, newdelayr, newtransr,
+		numpaths += find_path_delay(RISING,
+			newdelayr + loadnet->receivers[i]->wiredelay, newtransr,
 			loadnet->receivers[i], newbtdata, delaylist, minmax);
 	    if (outdir & FALLING)
-		numpaths += find_path_delay(FALLING, newdelayf, newtransf,
+		numpaths += find_path_delay(FALLING,
+			newdelayf + loadnet->receivers[i]->wiredelay, newtransf,
 			loadnet->receivers[i], newbtdata, delaylist, minmax);
 	}
-	receiver->tag = NULL;
     }
-    else {
+    else if ((testpin == NULL) || !(testpin->type & (DFFCLK | LATCHEN))) {
+
+	// (A register clock or latch enable is not the end of a data
+	// path.  Paths into the clock network are its latency, found
+	// by compute_clock_network(), or are clock gating checks.)
 
 	/* Is receiver already in delaylist? */
-	if ((receiver->tag != (ddataptr)(-1)) && (receiver->tag != NULL)) {
+	if (receiver->tag != NULL) {
 
 	    /* Position in delaylist is recorded in tag field */
 	    testddata = receiver->tag;
@@ -1212,6 +2216,8 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
 	    newddata->delay = 0.0;
 	    newddata->trans = 0.0;
 	    newddata->backtrace = newbtdata;
+	    newddata->group = NULL;
+	    newddata->endnext = NULL;
 	    newddata->next = *delaylist;
 	    *delaylist = newddata;
 
@@ -1270,58 +2276,821 @@ btptr find_clock_transition(btptr clocklist, connptr testlink, short dir, char m
 }
 
 /*--------------------------------------------------------------*/
-/* Given an instance record, find the pin of the instance that	*/
-/* is the clock, if the instance is a flop.  If the instance is	*/
-/* not a flop, return NULL.					*/
+/* Order the clock network upstream of "clknet" so that every	*/
+/* net comes after the nets driving the gate that drives it.	*/
+/* Like find_clock_source(), the search stops at module inputs,	*/
+/* which become clock roots, continues from a register output	*/
+/* through the register's clock, and skips gating inputs.	*/
 /*--------------------------------------------------------------*/
 
-connptr find_register_clock(instptr testinst)
+void order_clock_network(netptr clknet, netptr **order, int *numnets, int *maxnets)
 {
-    connptr testconn;
+    connptr driver, iinput;
 
-    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
-	if (testconn->refpin && (testconn->refpin->type & DFFCLK))
-	    return testconn;
+    if (clknet->clkdata != NULL) return;	/* Visited, or a loop */
 
-    return NULL;
+    clknet->clkdata = (clkptr)calloc(1, sizeof(clockdata));
+    clknet->clkdata->state = CLK_VISITING;
+
+    driver = clknet->driver;
+    if ((driver != NULL) && (driver->refinst != NULL) && (driver->refpin != NULL)) {
+	if ((driver->refpin->type & DFFOUT)
+		|| (driver->refinst->refcell->type & (DFF | LATCH))) {
+	    iinput = find_register_clock(driver->refinst);
+	    if ((iinput != NULL) && (iinput->refnet != NULL))
+		order_clock_network(iinput->refnet, order, numnets, maxnets);
+	}
+	else {
+	    for (iinput = driver->refinst->in_connects; iinput; iinput = iinput->next)
+		if ((iinput->refnet != NULL) && !(iinput->flags & CONN_GATE_ENABLE))
+		    order_clock_network(iinput->refnet, order, numnets, maxnets);
+	}
+    }
+
+    if (*numnets == *maxnets) {
+	*maxnets <<= 1;
+	*order = (netptr *)realloc(*order, *maxnets * sizeof(netptr));
+    }
+    (*order)[(*numnets)++] = clknet;
+    clknet->clkdata->state = CLK_ORDERED;
 }
 
 /*--------------------------------------------------------------*/
-/* Given an edge direction (RISING or FALLING) at a source net,	*/
-/* and given a destination net, find the sense of the signal	*/
-/* when it arrives at the destination net.			*/
+/* Build the Euler tour of the clock network trees, following	*/
+/* the "parent" link of each net in "order", and the sparse	*/
+/* table over the tour used by clock_common_point().  The nets	*/
+/* of "order" have their parents ahead of them.			*/
 /*--------------------------------------------------------------*/
 
-short find_edge_dir(short dir, netptr sourcenet, netptr destnet) {
-    int i;
-    short outdir, rdir;
-    connptr testconn, nextconn;
-    instptr testinst;
-    netptr nextnet;
+void build_clock_tree(netptr *order, int numnets)
+{
+    int *child, *sibling, *cur, *stack, *level;
+    int i, k, n, v, sp, a, b;
+    clkptr clkdata;
+
+    if (clktree != NULL) {
+	for (k = 0; k < clktree->levels; k++) free(clktree->sparse[k]);
+	free(clktree->sparse);
+	free(clktree->tour);
+	free(clktree->log2);
+	free(clktree);
+	clktree = NULL;
+    }
+    if (numnets == 0) return;
 
-    for (i = 0; i < sourcenet->fanout; i++) {
-	testconn = sourcenet->receivers[i];
-	testinst = testconn->refinst;
-	if (testinst == NULL) continue;
-	if (testconn->refpin == NULL) continue;
-	if ((testconn->refpin->type & REGISTER_IN) != 0) continue;
-	nextconn = testinst->out_connects;
-	nextnet  = nextconn->refnet;
-	outdir = calc_dir(testconn->refpin, dir);
-	if (nextnet == destnet) return outdir;
+    // Make a list of children of each net, by position in "order"
 
-	rdir = find_edge_dir(outdir, nextnet, destnet);
-	if (rdir != 0) return rdir;
+    child = (int *)malloc(numnets * sizeof(int));
+    sibling = (int *)malloc(numnets * sizeof(int));
+    cur = (int *)malloc(numnets * sizeof(int));
+    stack = (int *)malloc(numnets * sizeof(int));
+    for (i = 0; i < numnets; i++) {
+	order[i]->clkdata->tourpos = i;
+	child[i] = -1;
+    }
+    for (i = numnets - 1; i >= 0; i--) {
+	clkdata = order[i]->clkdata;
+	if (clkdata->parent == NULL) continue;
+	n = clkdata->parent->clkdata->tourpos;
+	sibling[i] = child[n];
+	child[n] = i;
+    }
+
+    // Each net is entered once, and each parent is visited again
+    // after each child, so the tour of a tree of n nets has 2n - 1
+    // entries.
+
+    clktree = (clocktree *)malloc(sizeof(clocktree));
+    clktree->tour = (netptr *)malloc(2 * numnets * sizeof(netptr));
+    level = (int *)malloc(2 * numnets * sizeof(int));
+    for (i = 0; i < numnets; i++) cur[i] = child[i];
+
+    n = 0;
+    for (i = 0; i < numnets; i++) {
+	if (order[i]->clkdata->parent != NULL) continue;
+	sp = 0;
+	stack[sp++] = i;
+	level[n] = order[i]->clkdata->depth;
+	clktree->tour[n++] = order[i];
+	while (sp > 0) {
+	    v = stack[sp - 1];
+	    if (cur[v] >= 0) {
+		k = cur[v];
+		cur[v] = sibling[k];
+		stack[sp++] = k;
+		level[n] = order[k]->clkdata->depth;
+		clktree->tour[n++] = order[k];
+	    }
+	    else if (--sp > 0) {
+		v = stack[sp - 1];
+		level[n] = order[v]->clkdata->depth;
+		clktree->tour[n++] = order[v];
+	    }
+	}
+    }
+    clktree->length = n;
+
+    // Record the first position of each net in the tour
+
+    for (i = n - 1; i >= 0; i--)
+	clktree->tour[i]->clkdata->tourpos = i;
+
+    clktree->log2 = (int *)malloc((n + 1) * sizeof(int));
+    clktree->log2[0] = clktree->log2[1] = 0;
+    for (i = 2; i <= n; i++)
+	clktree->log2[i] = clktree->log2[i >> 1] + 1;
+
+    clktree->levels = clktree->log2[n] + 1;
+    clktree->sparse = (int **)malloc(clktree->levels * sizeof(int *));
+    clktree->sparse[0] = (int *)malloc(n * sizeof(int));
+    for (i = 0; i < n; i++) clktree->sparse[0][i] = i;
+    for (k = 1; k < clktree->levels; k++) {
+	clktree->sparse[k] = (int *)malloc((n - (1 << k) + 1) * sizeof(int));
+	for (i = 0; i + (1 << k) <= n; i++) {
+	    a = clktree->sparse[k - 1][i];
+	    b = clktree->sparse[k - 1][i + (1 << (k - 1))];
+	    clktree->sparse[k][i] = (level[a] <= level[b]) ? a : b;
+	}
+    }
+
+    free(level);
+    free(child);
+    free(sibling);
+    free(cur);
+    free(stack);
+}
+
+/*--------------------------------------------------------------*/
+/* Return the last net shared by the clock tree paths to nets	*/
+/* "net1" and "net2", or NULL if they do not share a root.	*/
+/* This is a lookup of the net of least depth between the two	*/
+/* nets' positions in the Euler tour, and takes constant time.	*/
+/*--------------------------------------------------------------*/
+
+netptr clock_common_point(netptr net1, netptr net2)
+{
+    int i, j, k, a, b;
+
+    if ((clktree == NULL) || (net1->clkdata == NULL) || (net2->clkdata == NULL))
+	return NULL;
+    if (net1->clkdata->root != net2->clkdata->root) return NULL;
+
+    i = net1->clkdata->tourpos;
+    j = net2->clkdata->tourpos;
+    if (i > j) {
+	k = i;
+	i = j;
+	j = k;
+    }
+    k = clktree->log2[j - i + 1];
+    a = clktree->sparse[k][i];
+    b = clktree->sparse[k][j - (1 << k) + 1];
+    if (clktree->tour[a]->clkdata->depth <= clktree->tour[b]->clkdata->depth)
+	return clktree->tour[a];
+    else
+	return clktree->tour[b];
+}
+
+/*--------------------------------------------------------------*/
+/* Return the clock reconvergence pessimism of the clock pins	*/
+/* "launch" and "capture", clocked on edges "launchdir" and	*/
+/* "capturedir":  The difference between the latest and	*/
+/* earliest clock arrival at the last net that their clock	*/
+/* paths share.  Only edges at the common point that come from	*/
+/* the same root edge as both clock edges are checked, and the	*/
+/* smaller difference is taken, so that the pessimism removed	*/
+/* is never more than is there.					*/
+/*--------------------------------------------------------------*/
+
+double clock_cppr_credit(connptr launch, short launchdir, connptr capture,
+		short capturedir)
+{
+    netptr common;
+    clkptr clkdata;
+    double credit, spread;
+    short e, rootdir;
+
+    common = clock_common_point(launch->refnet, capture->refnet);
+    if (common == NULL) return 0.0;
+
+    rootdir = launch->refnet->clkdata->srcdir[CLKEDGE(launchdir)] &
+		capture->refnet->clkdata->srcdir[CLKEDGE(capturedir)];
+
+    clkdata = common->clkdata;
+    credit = 1E50;
+    for (e = 0; e < 2; e++) {
+	if ((clkdata->srcdir[e] & rootdir) == 0) continue;
+	spread = clkdata->maxdelay[e] - clkdata->mindelay[e];
+	if (spread < credit) credit = spread;
+    }
+    return (credit < 1E50) ? credit : 0.0;
+}
+
+/*--------------------------------------------------------------*/
+/* Compute the earliest and latest clock arrival times and	*/
+/* transition times on every net of the clock network, in one	*/
+/* forward pass over the network.  At a clock gate, only the	*/
+/* clock input found by find_clock_gates() is followed, and the	*/
+/* gating inputs (CONN_GATE_ENABLE) add nothing to the latency.	*/
+/* Where the clock input can't be told apart, the output	*/
+/* follows the root of the latest arriving input, and inputs	*/
+/* from other roots are treated as gating signals.		*/
+/*								*/
+/* A register output in the clock network (e.g., a clock	*/
+/* divider) is a generated clock:  It has the root of the	*/
+/* register's clock, and both of its edges follow the active	*/
+/* clock edge by the clock-to-output delay.  Paths between the	*/
+/* master and generated clocks are then timed from the one	*/
+/* root, with the latency computed here.			*/
+/*								*/
+/* Return the number of register clock (and latch enable)	*/
+/* pins, and an array of them in "sinklist".			*/
+/*--------------------------------------------------------------*/
+
+int compute_clock_network(instptr instlist, connptr **sinklist)
+{
+    instptr testinst;
+    connptr testconn, driver, iinput, clkconn;
+    netptr  *order, testnet;
+    clkptr  outdata, indata;
+    double  latest, late, delay, trans;
+    short   outdir, dir, e, o;
+    int     i, numnets, maxnets, numsinks, maxsinks;
+
+    numnets = numsinks = 0;
+    maxnets = maxsinks = 64;
+    order = (netptr *)malloc(maxnets * sizeof(netptr));
+    *sinklist = (connptr *)malloc(maxsinks * sizeof(connptr));
+
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	if (!(testinst->refcell->type & (DFF | LATCH))) continue;
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    if ((testconn->refpin == NULL) || (testconn->refnet == NULL)) continue;
+	    if (!(testconn->refpin->type & (DFFCLK | LATCHEN))) continue;
+	    if (numsinks == maxsinks) {
+		maxsinks <<= 1;
+		*sinklist = (connptr *)realloc(*sinklist, maxsinks * sizeof(connptr));
+	    }
+	    (*sinklist)[numsinks++] = testconn;
+	    order_clock_network(testconn->refnet, &order, &numnets, &maxnets);
+	}
+    }
+
+    for (i = 0; i < numnets; i++) {
+	testnet = order[i];
+	outdata = testnet->clkdata;
+	driver = testnet->driver;
+
+	// Pick the root of the latest arriving clock input
+
+	outdata->root = NULL;
+	outdata->parent = NULL;
+	if ((driver != NULL) && (driver->refinst != NULL) && (driver->refpin != NULL)
+		&& !(driver->refpin->type & DFFOUT)
+		&& !(driver->refinst->refcell->type & (DFF | LATCH))) {
+	    latest = -1E50;
+	    for (iinput = driver->refinst->in_connects; iinput; iinput = iinput->next) {
+		if (iinput->refnet == NULL) continue;
+		if (iinput->flags & (CONN_BROKEN | CONN_GATE_ENABLE)) continue;
+		indata = iinput->refnet->clkdata;
+		if ((indata == NULL) || (indata->state != CLK_DONE)) continue;
+		for (e = 0; e < 2; e++) {
+		    if (indata->srcdir[e] == 0) continue;
+		    late = indata->maxdelay[e] + iinput->wiredelay;
+		    if (late > latest) {
+			latest = late;
+			outdata->root = indata->root;
+			outdata->parent = iinput->refnet;
+		    }
+		}
+	    }
+	}
+
+	else if ((driver != NULL) && (driver->refinst != NULL) && (driver->refpin != NULL)) {
+
+	    // Generated clock from a register whose clock is done
+
+	    clkconn = find_register_clock(driver->refinst);
+	    if ((clkconn != NULL) && (clkconn->refnet != NULL)
+			&& !(clkconn->flags & CONN_BROKEN)) {
+		indata = clkconn->refnet->clkdata;
+		dir = register_edge(driver->refinst);
+		e = CLKEDGE(dir);
+		if ((indata != NULL) && (indata->state == CLK_DONE)
+			&& (indata->srcdir[e] != 0)) {
+		    outdata->root = indata->root;
+		    outdata->parent = clkconn->refnet;
+		    outdata->depth = indata->depth + 1;
+		    for (o = 0; o < 2; o++) {
+			outdata->mindelay[o] = indata->mindelay[e] + clkconn->wiredelay +
+				calc_prop_delay(indata->mintrans[e], clkconn,
+				(o == 0) ? RISING : FALLING, MINIMUM_TIME);
+			outdata->mintrans[o] = calc_transition(indata->mintrans[e], clkconn,
+				(o == 0) ? RISING : FALLING, MINIMUM_TIME);
+			outdata->maxdelay[o] = indata->maxdelay[e] + clkconn->wiredelay +
+				calc_prop_delay(indata->maxtrans[e], clkconn,
+				(o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+			outdata->maxtrans[o] = calc_transition(indata->maxtrans[e], clkconn,
+				(o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+			outdata->srcdir[o] = indata->srcdir[e];
+		    }
+		    outdata->state = CLK_DONE;
+		    continue;
+		}
+	    }
+	}
+
+	if (outdata->root == NULL) {
+
+	    // Clock root:  module input, undriven, or a register output
+	    // not clocked from the clock network
+
+	    outdata->root = testnet;
+	    for (e = 0; e < 2; e++) {
+		outdata->mindelay[e] = outdata->maxdelay[e] = 0.0;
+		outdata->mintrans[e] = outdata->maxtrans[e] = 0.0;
+	    }
+	    outdata->srcdir[CLKEDGE(RISING)] = RISING;
+	    outdata->srcdir[CLKEDGE(FALLING)] = FALLING;
+	    outdata->depth = 0;
+	    outdata->state = CLK_DONE;
+	    continue;
+	}
+	outdata->depth = outdata->parent->clkdata->depth + 1;
+
+	for (e = 0; e < 2; e++) {
+	    outdata->mindelay[e] = 1E50;
+	    outdata->maxdelay[e] = -1E50;
+	    outdata->srcdir[e] = 0;
+	}
+
+	for (iinput = driver->refinst->in_connects; iinput; iinput = iinput->next) {
+	    if (iinput->refnet == NULL) continue;
+	    if (iinput->flags & (CONN_BROKEN | CONN_GATE_ENABLE)) continue;
+	    indata = iinput->refnet->clkdata;
+	    if ((indata == NULL) || (indata->state != CLK_DONE)) continue;
+	    if (indata->root != outdata->root) continue;
+
+	    for (e = 0; e < 2; e++) {
+		if (indata->srcdir[e] == 0) continue;
+		outdir = calc_dir(iinput->refpin, (e == 0) ? RISING : FALLING);
+		for (o = 0; o < 2; o++) {
+		    if (!(outdir & ((o == 0) ? RISING : FALLING))) continue;
+
+		    delay = indata->mindelay[e] + iinput->wiredelay +
+			calc_prop_delay(indata->mintrans[e], iinput,
+			(o == 0) ? RISING : FALLING, MINIMUM_TIME);
+		    trans = calc_transition(indata->mintrans[e], iinput,
+			(o == 0) ? RISING : FALLING, MINIMUM_TIME);
+		    if (delay < outdata->mindelay[o]) {
+			outdata->mindelay[o] = delay;
+			outdata->mintrans[o] = trans;
+		    }
+
+		    delay = indata->maxdelay[e] + iinput->wiredelay +
+			calc_prop_delay(indata->maxtrans[e], iinput,
+			(o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+		    trans = calc_transition(indata->maxtrans[e], iinput,
+			(o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+		    if (delay > outdata->maxdelay[o]) {
+			outdata->maxdelay[o] = delay;
+			outdata->maxtrans[o] = trans;
+		    }
+		    outdata->srcdir[o] |= indata->srcdir[e];
+		}
+	    }
+	}
+	outdata->state = CLK_DONE;
+    }
+
+    build_clock_tree(order, numnets);
+
+    free(order);
+    return numsinks;
+}
+
+/*--------------------------------------------------------------*/
+/* Comparison used by qsort() to sort clock pins by clock root	*/
+/* and then by instance name.					*/
+/*--------------------------------------------------------------*/
+
+int
+compclock(connptr *a, connptr *b)
+{
+    int r;
+
+    r = strcmp((*a)->refnet->clkdata->root->name, (*b)->refnet->clkdata->root->name);
+    if (r != 0) return r;
+    return strcmp((*a)->refinst->name, (*b)->refinst->name);
+}
+
+/*--------------------------------------------------------------*/
+/* Write the clock latency report to "fout":  for each register	*/
+/* clock pin, the earliest and latest insertion delay and the	*/
+/* transition times of the active clock edge, and its polarity	*/
+/* (whether the clock network inverts the root edge reaching	*/
+/* the pin);  then skew statistics for each clock root.  The	*/
+/* per-root summary is also written to stdout.			*/
+/*--------------------------------------------------------------*/
+
+void report_clocks(connptr *sinklist, int numsinks, FILE *fout)
+{
+    connptr testconn;
+    clkptr  clkdata;
+    netptr  root;
+    double  early, late, minlat, maxlat, sumlat;
+    short   dir, e, type;
+    char    *polarity;
+    int     i, first, count;
+
+    qsort(sinklist, numsinks, sizeof(connptr), (__compar_fn_t)compclock);
+
+    fprintf(fout, "# Clock pin latency (ps):  instance/pin root edge polarity"
+		" min_delay max_delay min_trans max_trans\n");
+    for (i = 0; i < numsinks; i++) {
+	testconn = sinklist[i];
+	clkdata = testconn->refnet->clkdata;
+	type = testconn->refinst->refcell->type;
+	if (type & LATCH)
+	    dir = (type & EN_SENSE_MASK) ? FALLING : RISING;
+	else
+	    dir = (type & CLK_SENSE_MASK) ? FALLING : RISING;
+	e = CLKEDGE(dir);
+
+	if (clkdata->srcdir[e] == dir) polarity = "positive";
+	else if (clkdata->srcdir[e] == EITHER) polarity = "non-unate";
+	else if (clkdata->srcdir[e] != 0) polarity = "inverted";
+	else polarity = "unreached";
+
+	fprintf(fout, "%s/%s\t%s\t%s\t%s\t%g\t%g\t%g\t%g\n",
+		testconn->refinst->name, testconn->refpin->name,
+		clkdata->root->name, (dir == RISING) ? "rise" : "fall", polarity,
+		clkdata->mindelay[e] + testconn->wiredelay,
+		clkdata->maxdelay[e] + testconn->wiredelay,
+		clkdata->mintrans[e], clkdata->maxtrans[e]);
+    }
+
+    fprintf(stdout, "\nClock network latency and skew:\n");
+    fprintf(fout, "\n# Clock root skew (ps):  root pins min_latency max_latency"
+		" mean_latency skew\n");
+    first = 0;
+    while (first < numsinks) {
+	root = sinklist[first]->refnet->clkdata->root;
+	minlat = 1E50;
+	maxlat = -1E50;
+	sumlat = 0.0;
+	count = 0;
+	for (i = first; i < numsinks; i++) {
+	    testconn = sinklist[i];
+	    clkdata = testconn->refnet->clkdata;
+	    if (clkdata->root != root) break;
+	    type = testconn->refinst->refcell->type;
+	    if (type & LATCH)
+		e = CLKEDGE((type & EN_SENSE_MASK) ? FALLING : RISING);
+	    else
+		e = CLKEDGE((type & CLK_SENSE_MASK) ? FALLING : RISING);
+	    if (clkdata->srcdir[e] == 0) continue;
+	    early = clkdata->mindelay[e] + testconn->wiredelay;
+	    late = clkdata->maxdelay[e] + testconn->wiredelay;
+	    if (early < minlat) minlat = early;
+	    if (late > maxlat) maxlat = late;
+	    sumlat += late;
+	    count++;
+	}
+	if (count > 0) {
+	    fprintf(stdout, "   Clock %s:  %d pins, latency %g to %g ps"
+			" (mean %g ps), skew %g ps\n", root->name, count,
+			minlat, maxlat, sumlat / count, maxlat - minlat);
+	    fprintf(fout, "%s\t%d\t%g\t%g\t%g\t%g\n", root->name, count,
+			minlat, maxlat, sumlat / count, maxlat - minlat);
+	}
+	first = i;
+    }
+    fprintf(stdout, "-----------------------------------------\n\n");
+    fflush(stdout);
+}
+
+/*--------------------------------------------------------------*/
+/* Set the time at which each register launches data (the	*/
+/* "opentime" of a latch is its opening edge), after the rising	*/
+/* edge of the clock root at time zero, for a clock "period"	*/
+/* with a 50% duty cycle.  The launch is half a period late if	*/
+/* the active edge at the register's clock pin comes from the	*/
+/* falling edge of the root, which is the case for negative	*/
+/* edge flops, latches open on a low enable, and registers on	*/
+/* an inverted clock.  Without a clock network, the active edge	*/
+/* of the register itself is used.				*/
+/*--------------------------------------------------------------*/
+
+void compute_launch_times(instptr instlist, double period)
+{
+    instptr testinst;
+    connptr clkconn;
+    clkptr clkdata;
+    short dir, rootdir;
+
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	testinst->opentime = 0.0;
+	if (!(testinst->refcell->type & (DFF | LATCH))) continue;
+	if (period <= 0.0) continue;
+	dir = register_edge(testinst);
+	clkconn = find_register_clock(testinst);
+	clkdata = ((clkconn != NULL) && (clkconn->refnet != NULL)) ?
+		clkconn->refnet->clkdata : NULL;
+	if ((clkdata != NULL) && (clkdata->state == CLK_DONE) &&
+			(clkdata->srcdir[CLKEDGE(dir)] != 0))
+	    rootdir = clkdata->srcdir[CLKEDGE(dir)];
+	else
+	    rootdir = dir;
+	if (rootdir == FALLING) testinst->opentime = 0.5 * period;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Return the time at which latch "testinst" closes on data	*/
+/* launched by a rising clock edge at time zero, for a clock	*/
+/* "period" with a 50% duty cycle:  A latch that opens on the	*/
+/* rising edge captures in the next period, and closes one and	*/
+/* a half periods after the launch;  a latch that opens on the	*/
+/* falling edge closes one period after the launch.  The	*/
+/* opening edge is the one set by compute_launch_times().	*/
+/*--------------------------------------------------------------*/
+
+double latch_close_time(instptr testinst, double period)
+{
+    if (testinst->opentime > 0.0)
+	return period;
+    else
+	return 1.5 * period;
+}
+
+/*--------------------------------------------------------------*/
+/* Given an edge direction (RISING or FALLING) at a source net,	*/
+/* and given a destination net, find the sense of the signal	*/
+/* when it arrives at the destination net.			*/
+/*--------------------------------------------------------------*/
+
+short find_edge_dir(short dir, netptr sourcenet, netptr destnet) {
+    int i;
+    short outdir, rdir;
+    connptr testconn, nextconn;
+    instptr testinst;
+    netptr nextnet;
+
+    for (i = 0; i < sourcenet->fanout; i++) {
+	testconn = sourcenet->receivers[i];
+	testinst = testconn->refinst;
+	if (testinst == NULL) continue;
+	if (testconn->refpin == NULL) continue;
+	if ((testconn->refpin->type & REGISTER_IN) != 0) continue;
+	if (testconn->flags & CONN_BROKEN) continue;
+	nextconn = testinst->out_connects;
+	nextnet  = nextconn->refnet;
+	outdir = calc_dir(testconn->refpin, dir);
+	if (nextnet == destnet) return outdir;
+
+	rdir = find_edge_dir(outdir, nextnet, destnet);
+	if (rdir != 0) return rdir;
+    }
+    return 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the root of the clock at connection "clkconn", given	*/
+/* the list "clocklist" of its sources made by			*/
+/* find_clock_source().  The root is a module input or the	*/
+/* register output of a generated clock.  If the clock is	*/
+/* gated, the source found first (through the first input of	*/
+/* each gate) is taken.						*/
+/*--------------------------------------------------------------*/
+
+netptr find_clock_root(btptr clocklist, connptr clkconn)
+{
+    btptr testclock;
+    connptr driver;
+    netptr root;
+
+    root = clkconn->refnet;
+    for (testclock = clocklist; testclock; testclock = testclock->next) {
+	driver = testclock->receiver->refnet->driver;
+	if ((driver == NULL) || (driver->refinst == NULL) ||
+		((driver->refpin != NULL) && (driver->refpin->type & DFFOUT)) ||
+		(driver->refinst->refcell->type & (DFF | LATCH)))
+	    root = testclock->receiver->refnet;
+    }
+    return root;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the latency of the generated clock "root", found by	*/
+/* find_clock_root(), from the root of its master clock:  The	*/
+/* latest arrival if "minmax" is MAXIMUM_TIME, or the earliest,	*/
+/* of the edge at "root" on the path in "clocklist".  This was	*/
+/* computed by compute_clock_network().  Return zero if "root"	*/
+/* is not a generated clock.					*/
+/*--------------------------------------------------------------*/
+
+double generated_clock_latency(btptr clocklist, netptr root, char minmax)
+{
+    btptr testclock;
+    clkptr clkdata;
+    double latency;
+    short dir, e;
+
+    if (root == NULL) return 0.0;
+    clkdata = root->clkdata;
+    if ((clkdata == NULL) || (clkdata->state != CLK_DONE) || (clkdata->root == root))
+	return 0.0;
+
+    dir = EITHER;
+    for (testclock = clocklist; testclock; testclock = testclock->next) {
+	if (testclock->receiver->refnet == root) {
+	    dir = testclock->dir;
+	    break;
+	}
+    }
+
+    latency = (minmax == MAXIMUM_TIME) ? -1E50 : 1E50;
+    for (e = 0; e < 2; e++) {
+	if (!(dir & ((e == 0) ? RISING : FALLING))) continue;
+	if (clkdata->srcdir[e] == 0) continue;
+	if (minmax == MAXIMUM_TIME) {
+	    if (clkdata->maxdelay[e] > latency) latency = clkdata->maxdelay[e];
+	}
+	else {
+	    if (clkdata->mindelay[e] < latency) latency = clkdata->mindelay[e];
+	}
+    }
+    return ((latency > -1E50) && (latency < 1E50)) ? latency : 0.0;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the path group of paths of type "type" launched by	*/
+/* clock root "launch" and captured by clock root "capture"	*/
+/* in "grouplist", or add a new group if there is none.  The	*/
+/* list is kept sorted by type and clock names, so that the	*/
+/* groups are reported in a fixed order.			*/
+/*--------------------------------------------------------------*/
+
+int compare_path_groups(groupptr group, netptr launch, netptr capture, short type)
+{
+    int result;
+
+    if (group->type != type) return group->type - type;
+    if (group->launch != launch) {
+	if (group->launch == NULL) return -1;
+	if (launch == NULL) return 1;
+	result = strcmp(group->launch->name, launch->name);
+	if (result != 0) return result;
+    }
+    if (group->capture != capture) {
+	if (group->capture == NULL) return -1;
+	if (capture == NULL) return 1;
+	return strcmp(group->capture->name, capture->name);
     }
     return 0;
 }
 
+groupptr find_path_group(groupptr *grouplist, netptr launch, netptr capture, short type)
+{
+    groupptr *groupptrptr, newgroup;
+    int result;
+
+    for (groupptrptr = grouplist; *groupptrptr; groupptrptr = &(*groupptrptr)->next) {
+	result = compare_path_groups(*groupptrptr, launch, capture, type);
+	if (result == 0) return *groupptrptr;
+	if (result > 0) break;
+    }
+
+    newgroup = (groupptr)malloc(sizeof(pathgroup));
+    newgroup->launch = launch;
+    newgroup->capture = capture;
+    newgroup->type = type;
+    newgroup->numends = 0;
+    newgroup->numworst = 0;
+    newgroup->worst = (ddataptr *)malloc(maxpaths * sizeof(ddataptr));
+    newgroup->wns = 1E50;
+    newgroup->tns = 0.0;
+    newgroup->next = *groupptrptr;
+    *groupptrptr = newgroup;
+    return newgroup;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the slack of path "testddata".  For maximum delay	*/
+/* paths, this is the clock period "period" less the delay (if	*/
+/* there is no period, it orders the paths but is not a slack).	*/
+/* For minimum delay (hold) paths, it is the delay itself.	*/
+/*--------------------------------------------------------------*/
+
+double path_slack(ddataptr testddata, char minmax, double period)
+{
+    connptr endconn = testddata->backtrace->receiver;
+
+    if (minmax == MAXIMUM_TIME) {
+	if (endconn->refpin && (endconn->refpin->type & LATCHIN))
+	    return latch_close_time(endconn->refinst, period) - testddata->delay;
+	return period - testddata->delay;
+    }
+    else
+	return testddata->delay;
+}
+
+/*--------------------------------------------------------------*/
+/* Add path "newddata" to path group "group" as it is found.	*/
+/* Only the worst path to each endpoint counts:  If a worse	*/
+/* path to the endpoint is already in the group, the new path	*/
+/* is ignored, and otherwise it replaces the old path in the	*/
+/* group's totals and in its list of worst paths.  The worst	*/
+/* paths to the group's endpoints are linked from the endpoint	*/
+/* connection's "worst" record.					*/
+/*--------------------------------------------------------------*/
+
+void add_group_path(groupptr group, ddataptr newddata, char minmax, double period)
+{
+    connptr endconn;
+    ddataptr olddata, *prevptr;
+    double slack, oldslack;
+    int i;
+
+    endconn = newddata->backtrace->receiver;
+    slack = path_slack(newddata, minmax, period);
+
+    for (prevptr = &endconn->worst; *prevptr; prevptr = &(*prevptr)->endnext)
+	if ((*prevptr)->group == group)
+	    break;
+    olddata = *prevptr;
+
+    if (olddata != NULL) {
+	oldslack = path_slack(olddata, minmax, period);
+	if (slack >= oldslack) return;
+
+	// Replace the old path to the endpoint
+
+	if (oldslack < 0.0) group->tns -= oldslack;
+	newddata->endnext = olddata->endnext;
+	olddata->group = NULL;
+	olddata->endnext = NULL;
+	for (i = 0; i < group->numworst; i++)
+	    if (group->worst[i] == olddata)
+		break;
+	if (i < group->numworst) {
+	    group->numworst--;
+	    for (; i < group->numworst; i++)
+		group->worst[i] = group->worst[i + 1];
+	}
+    }
+    else {
+	newddata->endnext = NULL;
+	group->numends++;
+    }
+    *prevptr = newddata;
+    newddata->group = group;
+
+    if (slack < 0.0) group->tns += slack;
+    if (slack < group->wns) group->wns = slack;
+
+    // Insert into the list of worst paths, dropping the least bad
+    // path if the list is full.
+
+    i = group->numworst;
+    if (i == maxpaths) {
+	if (slack >= path_slack(group->worst[i - 1], minmax, period)) return;
+	i--;
+    }
+    else
+	group->numworst++;
+    for (; (i > 0) && (path_slack(group->worst[i - 1], minmax, period) > slack); i--)
+	group->worst[i] = group->worst[i - 1];
+    group->worst[i] = newddata;
+}
+
+/*--------------------------------------------------------------*/
+/* Free the path groups in "grouplist".  The paths belong to	*/
+/* the list of all paths and are freed with it.			*/
+/*--------------------------------------------------------------*/
+
+void free_path_groups(groupptr grouplist)
+{
+    groupptr freegroup;
+
+    while (grouplist != NULL) {
+	freegroup = grouplist;
+	grouplist = grouplist->next;
+	free(freegroup->worst);
+	free(freegroup);
+    }
+}
+
 /*--------------------------------------------------------------*/
 /* Search all paths from the clocked data outputs of		*/
 /* "clockedlist" to either output pins or data inputs of other	*/
 /* flops.							*/
 /*								*/
 /* Return a master list of all backtraces in "masterlist".	*/
+/* Each path is also added to its path group in "grouplist" as	*/
+/* soon as its delay is known, with slack measured against	*/
+/* the clock period "period".					*/
 /*								*/
 /* Return value is the number of paths recorded in masterlist.	*/
 /*								*/
@@ -1330,10 +3099,10 @@ short find_edge_dir(short dir, netptr sourcenet, netptr destnet) {
 /*--------------------------------------------------------------*/
 
 int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netptr netlist,
-		char minmax)
+		groupptr *grouplist, double period, char minmax)
 {
-    netptr	commonclock, testnet;
-    connptr     testconn, thisconn;
+    netptr	commonclock, testnet, launch, capture;
+    connptr     testconn, thisconn, dconn;
     connlistptr testlink;
     pinptr      testpin;
     cellptr     testcell;
@@ -1342,9 +3111,10 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
     btptr	selectedsource, selecteddest;
     ddataptr    delaylist, testddata;
     ddataptr	freeddata;
+    clkptr	srcclk, destclk;
 
     short	srcdir, destdir;		// Signal direction in/out
-    double	tdriver, setupdelay, holddelay;
+    double	tdriver, tstart, setupdelay, holddelay, credit, skew, latency;
     char	clk_sense_inv, clk_invert;
     int		numpaths, n, i;
 
@@ -1353,6 +3123,13 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
     clock2list = NULL;
 
     numpaths = 0;
+
+    // Clear the worst paths to endpoints left from any earlier run
+
+    for (testnet = netlist; testnet; testnet = testnet->next)
+	for (i = 0; i < testnet->fanout; i++)
+	    testnet->receivers[i]->worst = NULL;
+
     for (testlink = clockedlist; testlink; testlink = testlink->next) {
 
 	// Remove all tags and reset delay metrics before each run
@@ -1375,10 +3152,15 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 
 	    // Sense is positive for rising edge-triggered flops, negative for
 	    // falling edge-triggered flops
-	    srcdir = (testcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
+	    srcdir = register_edge(thisconn->refinst);
+
+	    // A latch launches at its opening edge (see
+	    // compute_launch_times())
+	    tstart = (testcell->type & LATCH) ? thisconn->refinst->opentime : 0.0;
 
 	    // Find the sources of the clock at the path start
 	    find_clock_source(thisconn, &clocklist, srcdir);
+	    launch = find_clock_root(clocklist, thisconn);
 
 	    // Find the clock source with the worst-case transition time at testlink
 	    // (Note:  For maximum path delay, find minimum clock transistion, and vice versa)
@@ -1398,6 +3180,8 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 	    // Connection is an input pin;  must calculate both rising and falling edges.
 	    srcdir = EITHER;
 	    tdriver = 0.0;	// To-do: use designated input transition time
+	    tstart = 0.0;
+	    launch = NULL;
 
 	    // Report on paths and their maximum delays
 	    if (verbose > 0)
@@ -1407,8 +3191,23 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 
 	if (verbose > 0) fflush(stdout);
 
+	// A latch that borrows time (see compute_latch_timing()) also
+	// passes its data through to the output after the opening
+	// edge, as in latch_output_arrival().  Trace these paths from
+	// the data input first, so that the paths from the latch
+	// enable are kept only where they arrive later.
+
+	n = 0;
+	if (testpin && (testcell->type & LATCH) && (minmax == MAXIMUM_TIME)
+			&& (thisconn->refinst->borrow > 0.0)) {
+	    dconn = find_latch_data(thisconn->refinst);
+	    if ((dconn != NULL) && (dconn->refnet != NULL))
+		n += find_path_delay(EITHER, tstart + thisconn->refinst->borrow,
+			thisconn->refinst->dtrans, dconn, NULL, &delaylist, minmax);
+	}
+
 	// Find all paths from "thisconn" to output or a flop input, and compute delay
-	n = find_path_delay(srcdir, 0.0, tdriver, thisconn, NULL, &delaylist, minmax);
+	n += find_path_delay(srcdir, tstart, tdriver, thisconn, NULL, &delaylist, minmax);
 	numpaths += n;
 
 	if (verbose > 0) fprintf(stdout, "%d paths traced (%d total).\n\n", n, numpaths);
@@ -1419,12 +3218,18 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 	    testddata->trans = testddata->backtrace->trans;
 	    testinst = testddata->backtrace->receiver->refinst;
 
+	    // No skew or credit between independent clocks
+
+	    skew = 0.0;
+	    credit = 0.0;
+
 	    if (testinst != NULL) {
 		// Find the sources of the clock at the path end
-		destdir = (testinst->refcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
+		destdir = register_edge(testinst);
 		testconn = find_register_clock(testinst);
 		find_clock_source(testconn, &clock2list, destdir);
 		selecteddest = find_clock_transition(clock2list, testconn, destdir, ~minmax);
+		capture = find_clock_root(clock2list, testconn);
 
 		// Find the connection that is common to both clocks
 		commonclock = find_common_clock(clocklist, clock2list);
@@ -1443,8 +3248,49 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 		    // destination clocks
 
 		    if (selecteddest != NULL && selectedsource != NULL) {
-			testddata->delay += selecteddest->delay;
-			testddata->delay -= selectedsource->delay;
+			skew = selecteddest->delay - selectedsource->delay;
+			testddata->delay += skew;
+
+			// With clock reconvergence pessimism removal, use the
+			// propagated clock latencies, latest at the launch and
+			// earliest at the capture (or vice versa for hold), and
+			// take back the difference on the shared clock path.
+
+			srcclk = thisconn->refnet->clkdata;
+			destclk = testconn->refnet->clkdata;
+			if (cppr && (srcclk != NULL) && (destclk != NULL) &&
+				(srcclk->srcdir[CLKEDGE(srcdir)] != 0) &&
+				(destclk->srcdir[CLKEDGE(destdir)] != 0)) {
+			    credit = clock_cppr_credit(thisconn, srcdir, testconn, destdir);
+			    if (minmax == MAXIMUM_TIME) {
+				skew = destclk->mindelay[CLKEDGE(destdir)]
+					- srcclk->maxdelay[CLKEDGE(srcdir)];
+				testddata->delay -= skew + credit;
+			    }
+			    else {
+				skew = destclk->maxdelay[CLKEDGE(destdir)]
+					- srcclk->mindelay[CLKEDGE(srcdir)];
+				testddata->delay += credit - skew;
+			    }
+			    skew += testconn->wiredelay - thisconn->wiredelay;
+			    testddata->delay -= testconn->wiredelay - thisconn->wiredelay;
+			}
+			else {
+			    // A generated clock arrives later than its master
+			    // by the latency from compute_clock_network(),
+			    // which the propagated latencies above include.
+
+			    if (minmax == MAXIMUM_TIME)
+				latency = generated_clock_latency(clock2list, capture,
+						MINIMUM_TIME) - generated_clock_latency(
+						clocklist, launch, MAXIMUM_TIME);
+			    else
+				latency = generated_clock_latency(clock2list, capture,
+						MAXIMUM_TIME) - generated_clock_latency(
+						clocklist, launch, MINIMUM_TIME);
+			    skew += latency;
+			    testddata->delay -= latency;
+			}
 
 			/* Check if the clock signal arrives at both flops with the	*/
 			/* same edge type (both rising or both falling).		*/
@@ -1498,8 +3344,7 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 		    if (selecteddest != NULL && selectedsource != NULL) {
 			if (verbose > 0) {
 			    if (selectedsource->receiver->refnet != selecteddest->receiver->refnet) {
-				fprintf(stdout, "   %g %s to %s clock skew\n",
-					selecteddest->delay - selectedsource->delay,
+				fprintf(stdout, "   %g %s to %s clock skew\n", skew,
 					selectedsource->receiver->refnet->name,
 					selecteddest->receiver->refnet->name);
 			    }
@@ -1529,6 +3374,9 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 				fprintf(stdout, "   %g setup time at destination\n", setupdelay);
 			    else
 				fprintf(stdout, "   %g hold time at destination\n", holddelay);
+			    if (credit > 0.0)
+				fprintf(stdout, "   %g clock reconvergence pessimism removed\n",
+					credit);
 			}
 		    }
 
@@ -1563,6 +3411,13 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 			backtrace->receiver->refinst->out_connects->refpin->name);
 	    }
 
+	    if (testinst != NULL)
+		add_group_path(find_path_group(grouplist, launch, capture,
+			(launch) ? PATH_REG_REG : PATH_IN_REG), testddata, minmax, period);
+	    else
+		add_group_path(find_path_group(grouplist, launch, NULL,
+			(launch) ? PATH_REG_OUT : PATH_IN_OUT), testddata, minmax, period);
+
 	    // Clean up clock2list
 	    while (clock2list != NULL) {
 		freebt = clock2list;
@@ -1592,36 +3447,137 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 }
 
 /*--------------------------------------------------------------*/
-/* Parse a table variable type from a liberty format file	*/
+/* Write the name of instance pin "testconn" to stdout, as	*/
+/* <instance>/<pin>.  A pin of a timing model cell (see		*/
+/* etm_instance()) is written as the pin of the module that it	*/
+/* stands for, in place of the cell instance name.		*/
 /*--------------------------------------------------------------*/
 
-int get_table_type(char *token) {
-    if (!strcasecmp(token, "input_net_transition"))
-	return TRANSITION_TIME;
-    else if (!strcasecmp(token, "total_output_net_capacitance"))
-	return OUTPUT_CAP;
-    else if (!strcasecmp(token, "related_pin_transition"))
-	return RELATED_TIME;
-    else if (!strcasecmp(token, "constrained_pin_transition"))
-	return CONSTRAINED_TIME;
+void print_pin_name(connptr testconn)
+{
+    char *iname = testconn->refinst->name;
+    char *sep;
+
+    sep = strrchr(iname, '/');
+    if ((testconn->refpin->alias != NULL) && (sep != NULL))
+	fprintf(stdout, "%.*s/%s", (int)(sep - iname), iname,
+		testconn->refpin->alias);
     else
-	return UNKNOWN;
+	fprintf(stdout, "%s/%s", iname, testconn->refpin->name);
 }
 
 /*--------------------------------------------------------------*/
-/* Read a liberty format file and collect information about	*/
-/* the timing properties of each standard cell.			*/
+/* Write the start and end points of path "testddata" to	*/
+/* stdout, as "Path <start> to <end>".				*/
 /*--------------------------------------------------------------*/
 
-void
-libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
+void print_path_ends(ddataptr testddata)
 {
-    char *token;
-    char *libname = NULL;
-    int section = INIT;
+    btptr testbt;
 
-    double time_unit = 1.0;	// Time unit multiplier, to get ps
-    double cap_unit = 1.0;	// Capacitive unit multiplier, to get fF
+    for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
+
+    if (testbt->receiver->refinst != NULL) {
+	fprintf(stdout, "Path ");
+	print_pin_name(testbt->receiver);
+    }
+    else
+	fprintf(stdout, "Path input pin %s", testbt->receiver->refnet->name);
+
+    if (testddata->backtrace->receiver->refinst != NULL) {
+	fprintf(stdout, " to ");
+	print_pin_name(testddata->backtrace->receiver);
+    }
+    else
+	fprintf(stdout, " to output pin %s",
+		testddata->backtrace->receiver->refnet->name);
+}
+
+/*--------------------------------------------------------------*/
+/* Report the path groups in "grouplist", each with its number	*/
+/* of endpoints, its worst and total negative slack, and its	*/
+/* worst paths.  Slack is reported for maximum delay paths only	*/
+/* if the clock period "period" is known.			*/
+/*								*/
+/* Return 1 if any group has negative slack, and return the	*/
+/* worst delay of all groups in "worstdelay".			*/
+/*--------------------------------------------------------------*/
+
+int report_path_groups(groupptr grouplist, char minmax, double period,
+		double *worstdelay)
+{
+    groupptr testgroup;
+    ddataptr testddata;
+    char *typenames[] = {"input to register", "register to register",
+		"register to output", "input to output"};
+    char badtiming, hasslack;
+    int i;
+
+    badtiming = 0;
+    hasslack = ((minmax == MINIMUM_TIME) || (period > 0.0)) ? 1 : 0;
+    *worstdelay = (minmax == MAXIMUM_TIME) ? 0.0 : 1E50;
+
+    for (testgroup = grouplist; testgroup; testgroup = testgroup->next) {
+	fprintf(stdout, "\nPath group %s to %s (%s):  %d endpoint%s",
+		(testgroup->launch) ? testgroup->launch->name : "inputs",
+		(testgroup->capture) ? testgroup->capture->name : "outputs",
+		typenames[testgroup->type], testgroup->numends,
+		(testgroup->numends == 1) ? "" : "s");
+	if (hasslack) {
+	    fprintf(stdout, ", WNS = %g ps, TNS = %g ps",
+		(testgroup->wns < 0.0) ? testgroup->wns : 0.0, testgroup->tns);
+	    if (testgroup->wns < 0.0) badtiming = 1;
+	}
+	fprintf(stdout, "\n");
+
+	fprintf(stdout, "Top %d %s delay paths:\n", testgroup->numworst,
+		(minmax == MAXIMUM_TIME) ? "maximum" : "minimum");
+	for (i = 0; i < testgroup->numworst; i++) {
+	    testddata = testgroup->worst[i];
+	    if ((minmax == MAXIMUM_TIME) ? (testddata->delay > *worstdelay) :
+			(testddata->delay < *worstdelay))
+		*worstdelay = testddata->delay;
+	    print_path_ends(testddata);
+	    fprintf(stdout, " delay %g ps", testddata->delay);
+	    if ((minmax == MAXIMUM_TIME) && (period > 0.0))
+		fprintf(stdout, "   Slack = %g ps", path_slack(testddata, minmax, period));
+	    fprintf(stdout, "\n");
+	}
+    }
+    return badtiming;
+}
+
+/*--------------------------------------------------------------*/
+/* Parse a table variable type from a liberty format file	*/
+/*--------------------------------------------------------------*/
+
+int get_table_type(char *token) {
+    if (!strcasecmp(token, "input_net_transition"))
+	return TRANSITION_TIME;
+    else if (!strcasecmp(token, "total_output_net_capacitance"))
+	return OUTPUT_CAP;
+    else if (!strcasecmp(token, "related_pin_transition"))
+	return RELATED_TIME;
+    else if (!strcasecmp(token, "constrained_pin_transition"))
+	return CONSTRAINED_TIME;
+    else
+	return UNKNOWN;
+}
+
+/*--------------------------------------------------------------*/
+/* Read the body of a liberty "cell" group into "newcell".	*/
+/* On entry, the file position is just past the opening brace	*/
+/* of the group, and on return it is just past the closing	*/
+/* brace.  "tablelist" is the list of table templates, and	*/
+/* "time_unit" and "cap_unit" are the library unit multipliers.	*/
+/*--------------------------------------------------------------*/
+
+void
+libertyReadCell(FILE *flib, cellptr newcell, lutable *tablelist,
+		double time_unit, double cap_unit)
+{
+    char *token;
+    int section = CELLDEF;
 
     pinptr testpin;
     lutable *tableptr;
@@ -1631,11 +3587,9 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
     char *iptr;
     short timing_type, sense_type;
 
-    lutable *newtable, *reftable;
-    cell *newcell, *lastcell;
+    lutable *reftable;
     pin *newpin;
 
-    lastcell = NULL;
     timing_type = UNKNOWN;
 
     /* Read tokens off of the line */
@@ -1644,314 +3598,544 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
     while (token != NULL) {
 
 	switch (section) {
-	    case INIT:
-		if (!strcasecmp(token, "library")) {
-		    token = advancetoken(flib, 0);
-		    if (strcmp(token, "("))
-			fprintf(stderr, "Library not followed by name\n");
-		    else
-			token = advancetoken(flib, ')');
-		    fprintf(stderr, "Parsing library \"%s\"\n", token);
-		    libname = strdup(token);
-		    token = advancetoken(flib, 0);
-		    if (strcmp(token, "{")) {
-			fprintf(stderr, "Did not find opening brace "
-					"on library block\n");
-			exit(1);
+	    case CELLDEF:
+
+		if (!strcmp(token, "}")) {
+		    section = LIBBLOCK;			// End of cell def
+		}
+		else if (!strcasecmp(token, "pin")) {
+		    token = advancetoken(flib, 0);	// Open parens
+		    if (!strcmp(token, "("))
+			token = advancetoken(flib, ')');	// Close parens
+
+		    newpin = parse_pin(newcell, token, SENSE_NONE);
+
+		    token = advancetoken(flib, 0);	// Find start of block
+		    if (strcmp(token, "{"))
+			fprintf(stderr, "Error: failed to find start of block\n");
+		    section = PINDEF;
+		}		
+		else if (!strcasecmp(token, "area")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    sscanf(token, "%lg", &newcell->area);
+		}
+		else if (!strcasecmp(token, "ff")) {
+		    newcell->type |= DFF;
+		    token = advancetoken(flib, '{');
+		    section = FLOPDEF;
+		}
+		else if (!strcasecmp(token, "latch")) {
+		    newcell->type |= LATCH;
+		    token = advancetoken(flib, '{');
+		    section = LATCHDEF;
+		}
+		else {
+		    // For unhandled tokens, read in tokens.  If it is
+		    // a definition or function, read to end-of-line.  If
+		    // it is a block definition, read to end-of-block.
+		    while (1) {
+			token = advancetoken(flib, 0);
+			if (token == NULL) break;
+			if (!strcmp(token, ";")) break;
+			if (!strcmp(token, "\""))
+			    token = advancetoken(flib, '\"');
+			if (!strcmp(token, "("))
+			    token = advancetoken(flib, ')');
+			if (!strcmp(token, "{")) {
+			    token = advancetoken(flib, '}');
+			    break;
+			}
 		    }
-		    section = LIBBLOCK;
+		}
+		break;
+
+	    case FLOPDEF:
+
+		if (!strcmp(token, "}")) {
+		    section = CELLDEF;			// End of flop def
+		}
+		else if (!strcasecmp(token, "next_state")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    newpin = parse_pin(newcell, token, SENSE_NONE);
+		    newpin->type |= DFFIN;
+		}
+		else if (!strcasecmp(token, "clocked_on")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    if (strchr(token, '\'') != NULL)
+			newcell->type |= CLK_SENSE_MASK;
+		    else if (strchr(token, '!') != NULL)
+			newcell->type |= CLK_SENSE_MASK;
+		    newpin = parse_pin(newcell, token, SENSE_NONE);
+		    newpin->type |= DFFCLK;
+		}
+		else if (!strcasecmp(token, "clear")) {
+		    newcell->type |= RST_MASK;
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    if (strchr(token, '\'') != NULL)
+			newcell->type |= RST_SENSE_MASK;
+		    else if (strchr(token, '!') != NULL)
+			newcell->type |= RST_SENSE_MASK;
+		    newpin = parse_pin(newcell, token, SENSE_NONE);
+		    newpin->type |= DFFRST;
+		}
+		else if (!strcasecmp(token, "preset")) {
+		    newcell->type |= SET_MASK;
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    if (strchr(token, '\'') != NULL)
+			newcell->type |= SET_SENSE_MASK;
+		    else if (strchr(token, '!') != NULL)
+			newcell->type |= SET_SENSE_MASK;
+		    newpin = parse_pin(newcell, token, SENSE_NONE);
+		    newpin->type |= DFFSET;
 		}
 		else
-		    fprintf(stderr, "Unknown input \"%s\", looking for "
-					"\"library\"\n", token);
+		    token = advancetoken(flib, ';');	// Read to end-of-statement
+
 		break;
 
-	    case LIBBLOCK:
-		// Here we check for the main blocks, again not rigorously. . .
+	    case LATCHDEF:
 
-		if (!strcasecmp(token, "}")) {
-		    fprintf(stdout, "End of library at line %d\n", fileCurrentLine);
-		    section = INIT;			// End of library block
+		if (!strcmp(token, "}")) {
+		    section = CELLDEF;			// End of flop def
 		}
-		else if (!strcasecmp(token, "delay_model")) {
+		else if (!strcasecmp(token, "data_in")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    newpin = parse_pin(newcell, token, SENSE_NONE);
+		    newpin->type |= LATCHIN;
+		}
+		else if (!strcasecmp(token, "enable")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    if (strchr(token, '\'') != NULL)
+			newcell->type |= EN_SENSE_MASK;
+		    else if (strchr(token, '!') != NULL)
+			newcell->type |= EN_SENSE_MASK;
+		    newpin = parse_pin(newcell, token, SENSE_NONE);
+		    newpin->type |= LATCHEN;
+		}
+		else
+		    token = advancetoken(flib, ';');	// Read to end-of-statement
+
+		break;
+
+	    case PINDEF:
+
+		if (!strcmp(token, "}")) {
+		    section = CELLDEF;			// End of pin def
+		}
+		else if (!strcasecmp(token, "capacitance")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    sscanf(token, "%lg", &newpin->capr);
+		    newpin->capr *= cap_unit;
+		}
+		else if (!strcasecmp(token, "rise_capacitance")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    sscanf(token, "%lg", &newpin->capr);
+		    newpin->capr *= cap_unit;
+		}
+		else if (!strcasecmp(token, "fall_capacitance")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    sscanf(token, "%lg", &newpin->capf);
+		    newpin->capf *= cap_unit;
+		}
+		else if (!strcasecmp(token, "function")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, 0);	// Open quote
+		    if (!strcmp(token, "\""))
+			token = advancetoken(flib, '\"');	// Find function string
+		    if (newpin->type & OUTPUT) {
+			newcell->function = strdup(token);
+		    }
 		    token = advancetoken(flib, 0);
-		    if (strcmp(token, ":"))
-			fprintf(stderr, "Input missing colon\n");
+		    if (strcmp(token, ";"))
+			fprintf(stderr, "Expected end-of-statement.\n");
+		}
+		else if (!strcasecmp(token, "direction")) {
+		    token = advancetoken(flib, 0);	// Colon
 		    token = advancetoken(flib, ';');
-		    if (strcasecmp(token, "table_lookup")) {
-			fprintf(stderr, "Sorry, only know how to "
-					"handle table lookup!\n");
-			exit(1);
+		    if (!strcasecmp(token, "input")) {
+			newpin->type |= INPUT;
+		    }
+		    else if (!strcasecmp(token, "output")) {
+			newpin->type |= OUTPUT;
 		    }
 		}
-		else if (!strcasecmp(token, "lu_table_template") ||
-			 !strcasecmp(token, "power_lut_template")) {
-		    // Read in template information;
-		    newtable = (lutable *)malloc(sizeof(lutable));
-		    newtable->name = NULL;
-		    newtable->invert = 0;
-		    newtable->var1 = UNKNOWN;
-		    newtable->var2 = UNKNOWN;
-		    newtable->size1 = 0;
-		    newtable->size2 = 0;
-		    newtable->idx1.times = NULL;
-		    newtable->idx2.caps = NULL;
-		    newtable->values = NULL;
-		    newtable->next = *tablelist;
-		    *tablelist = newtable;
-
-		    token = advancetoken(flib, 0);
+		else if (!strcasecmp(token, "max_transition")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    sscanf(token, "%lg", &newcell->maxtrans);
+		    newcell->maxtrans *= time_unit;
+		}
+		else if (!strcasecmp(token, "max_capacitance")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    sscanf(token, "%lg", &newcell->maxcap);
+		    newcell->maxcap *= cap_unit;
+		}
+		else if (!strcasecmp(token, "timing")) {
+		    token = advancetoken(flib, 0);	// Arguments, if any
 		    if (strcmp(token, "("))
-			fprintf(stderr, "Input missing open parens\n");
+			fprintf(stderr, "Error: failed to find start of block\n");
 		    else
-			token = advancetoken(flib, ')');
-		    newtable->name = strdup(token);
-		    while (*token != '}') {
+		       token = advancetoken(flib, ')');	// Arguments, if any
+		    token = advancetoken(flib, 0);	// Find start of block
+		    if (strcmp(token, "{"))
+			fprintf(stderr, "Error: failed to find start of block\n");
+		    testpin = NULL;
+		    sense_type = SENSE_NONE;
+		    section = TIMING;
+		}
+		else {
+		    // For unhandled tokens, read in tokens.  If it is
+		    // a definition or function, read to end-of-line.  If
+		    // it is a block definition, read to end-of-block.
+		    while (1) {
 			token = advancetoken(flib, 0);
-			if (!strcasecmp(token, "variable_1")) {
-			    token = advancetoken(flib, 0);
-			    token = advancetoken(flib, ';');
-			    newtable->var1 = get_table_type(token);
-			    if (newtable->var1 == OUTPUT_CAP || newtable->var1 == CONSTRAINED_TIME)
-				newtable->invert = 1;
+			if (token == NULL) break;
+			if (!strcmp(token, ";")) break;
+			if (!strcmp(token, "\""))
+			    token = advancetoken(flib, '\"');
+			if (!strcmp(token, "{")) {
+			    token = advancetoken(flib, '}');
+			    break;
 			}
-			else if (!strcasecmp(token, "variable_2")) {
-			    token = advancetoken(flib, 0);
-			    token = advancetoken(flib, ';');
-			    newtable->var2 = get_table_type(token);
-			    if (newtable->var2 == TRANSITION_TIME || newtable->var2 == RELATED_TIME)
-				newtable->invert = 1;
+		    }
+		}
+		break;
+
+	    case TIMING:
+
+		if (!strcmp(token, "}")) {
+		    section = PINDEF;			// End of timing def
+		}
+		else if (!strcasecmp(token, "related_pin")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// Read to end of statement
+		    // Create the related pin if needed
+		    testpin = parse_pin(newcell, token, sense_type);
+		}
+		else if (!strcasecmp(token, "timing_sense")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// Read to end of statement
+		    if (!strcasecmp(token, "positive_unate")) {
+			if (testpin)
+			   testpin->sense = SENSE_POSITIVE;
+			else
+			   sense_type = SENSE_POSITIVE;
+		    }
+		    else if (!strcasecmp(token, "negative_unate")) {
+			if (testpin)
+			   testpin->sense = SENSE_NEGATIVE;
+			else
+			   sense_type = SENSE_NEGATIVE;
+		    }
+		    else if (!strcasecmp(token, "non_unate")) {
+			if (testpin)
+			   testpin->sense = SENSE_NONE;
+			else
+			   sense_type = SENSE_NONE;
+		    }
+		}
+		else if (!strcasecmp(token, "timing_type")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// Read to end of statement
+
+		    // Note:  Timing type is apparently redundant information;
+		    // e.g., "falling_edge" can be determined by "clocked_on : !CLK"
+		    // in the ff {} block.  How reliable is this?
+
+		    if (!strcasecmp(token, "rising_edge"))
+			timing_type = TIMING_PROP_TRANS;
+		    else if (!strcasecmp(token, "falling_edge"))
+			timing_type = TIMING_PROP_TRANS;
+		    else if (!strcasecmp(token, "hold_rising"))
+			timing_type = TIMING_HOLD;
+		    else if (!strcasecmp(token, "hold_falling"))
+			timing_type = TIMING_HOLD;
+		    else if (!strcasecmp(token, "setup_rising"))
+			timing_type = TIMING_SETUP;
+		    else if (!strcasecmp(token, "setup_falling"))
+			timing_type = TIMING_SETUP;
+		    else if (!strcasecmp(token, "clear"))
+			timing_type = TIMING_SET_RESET;
+		    else if (!strcasecmp(token, "preset"))
+			timing_type = TIMING_SET_RESET;
+		    else if (!strcasecmp(token, "recovery_rising"))
+			timing_type = TIMING_RECOVERY;
+		    else if (!strcasecmp(token, "recovery_falling"))
+			timing_type = TIMING_RECOVERY;
+		    else if (!strcasecmp(token, "removal_rising"))
+			timing_type = TIMING_REMOVAL;
+		    else if (!strcasecmp(token, "removal_falling"))
+			timing_type = TIMING_REMOVAL;
+		    else if (!strcasecmp(token, "three_state_enable"))
+			timing_type = TIMING_TRISTATE;
+		    else if (!strcasecmp(token, "three_state_disable"))
+			timing_type = TIMING_TRISTATE;
+		}
+		else if ((!strcasecmp(token, "cell_rise")) ||
+			(!strcasecmp(token, "cell_fall")) ||
+			(!strcasecmp(token, "rise_transition")) ||
+			(!strcasecmp(token, "fall_transition")) ||
+			(!strcasecmp(token, "rise_constraint")) ||
+			(!strcasecmp(token, "fall_constraint"))) {
+
+		    tableptr = (lutable *)malloc(sizeof(lutable));
+		    tableptr->name = NULL;	// Not used
+		    tableptr->invert = 0;
+		    tableptr->var1 = UNKNOWN;
+		    tableptr->var2 = UNKNOWN;
+		    tableptr->size1 = 0;
+		    tableptr->size2 = 0;
+		    tableptr->idx1.times = NULL;
+		    tableptr->idx2.caps = NULL;
+		    tableptr->values = NULL;
+		    tableptr->rspan1 = NULL;
+		    tableptr->rspan2 = NULL;
+		    tableptr->vecfunc = NULL;
+		    tableptr->binfunc = NULL;
+		    tableptr->next = NULL;	// Not used
+
+		    // Note that propagation delays (cell rise, cell fall) and
+		    // transition times (rise transition, fall transition) have
+		    // their lookup tables stored in the "related pin" pin record.
+		    // Setup and hold times (rise constraint, fall constraint)
+		    // have their lookup tables stored in the original pin record.
+		    // These should not overlap.
+
+		    // Recovery and removal times (rise or fall constraint,
+		    // whichever edge releases the set or reset) are stored
+		    // in the set or reset pin record.  Only those relative
+		    // to the clock are kept.
+
+		    if (!strcasecmp(token, "cell_rise"))
+			testpin->propdelr = tableptr;
+		    else if (!strcasecmp(token, "cell_fall"))
+			testpin->propdelf = tableptr;
+		    else if (!strcasecmp(token, "rise_transition"))
+			testpin->transr = tableptr;
+		    else if (!strcasecmp(token, "fall_transition"))
+			testpin->transf = tableptr;
+		    else if (!strcasecmp(token, "rise_constraint")) {
+			if (timing_type == TIMING_SETUP)
+			    newpin->propdelr = tableptr;
+			else if (timing_type == TIMING_HOLD)
+			    newpin->transr = tableptr;
+			else if (testpin && (testpin->type & DFFCLK)) {
+			    if (timing_type == TIMING_RECOVERY)
+				newpin->recovery = tableptr;
+			    else if (timing_type == TIMING_REMOVAL)
+				newpin->removal = tableptr;
 			}
-			else if (!strcasecmp(token, "index_1")) {
+		    }
+		    else if (!strcasecmp(token, "fall_constraint")) {
+			if (timing_type == TIMING_SETUP)
+			    newpin->propdelf = tableptr;
+			else if (timing_type == TIMING_HOLD)
+			    newpin->transf = tableptr;
+			else if (testpin && (testpin->type & DFFCLK)) {
+			    if (timing_type == TIMING_RECOVERY)
+				newpin->recovery = tableptr;
+			    else if (timing_type == TIMING_REMOVAL)
+				newpin->removal = tableptr;
+			}
+		    }
+
+		    token = advancetoken(flib, 0);	// Open parens
+		    if (!strcmp(token, "("))
+			token = advancetoken(flib, ')');
+		    if (strcmp(token, "scalar")) {
+			
+		        for (reftable = tablelist; reftable; reftable = reftable->next)
+			    if (!strcmp(reftable->name, token))
+			        break;
+		        if (reftable == NULL)
+			    fprintf(stderr, "Failed to find a valid table \"%s\"\n",
+				    token);
+		        else {
+			    // Fill in default values from template reftable
+			    tableptr->invert = reftable->invert;
+			    if (reftable->size1 > 0) {
+				tableptr->var1 = reftable->var1;
+				tableptr->size1 = reftable->size1;
+				tableptr->idx1.times = (double *)malloc(tableptr->size1 * sizeof(double));
+				memcpy(tableptr->idx1.times, reftable->idx1.times,
+						tableptr->size1 * sizeof(double));
+			    }
+			    if (reftable->size2 > 0) {
+				tableptr->var2 = reftable->var2;
+				tableptr->size2 = reftable->size2;
+				tableptr->idx2.caps = (double *)malloc(tableptr->size2 * sizeof(double));
+				memcpy(tableptr->idx2.caps, reftable->idx2.caps,
+						tableptr->size2 * sizeof(double));
+			    }
+			}
+		    }
+
+		    token = advancetoken(flib, 0);
+		    if (strcmp(token, "{"))
+			fprintf(stderr, "Failed to find start of timing block\n");
+
+		    while (*token != '}') {
+		        token = advancetoken(flib, 0);
+		        if (!strcasecmp(token, "index_1")) {
+
+			    // Local index values override those in the template
+
 			    token = advancetoken(flib, 0);	// Open parens
 			    token = advancetoken(flib, 0);	// Quote
 			    if (!strcmp(token, "\""))
 				token = advancetoken(flib, '\"');
 
-			    if (newtable->invert == 1) {
-				// Count entries
-				iptr = token;
-				newtable->size2 = 1;
-				while ((iptr = strchr(iptr, ',')) != NULL) {
-				    iptr++;
-				    newtable->size2++;
-				}
-				newtable->idx2.caps = (double *)malloc(newtable->size2 *
-					sizeof(double));
-				newtable->size2 = 0;
+			    //-------------------------
+
+			    if (reftable && (reftable->invert == 1)) {
+				// Entries had better match the ref table
 				iptr = token;
-				sscanf(iptr, "%lg", &newtable->idx2.caps[0]);
-				if (newtable->var2 == OUTPUT_CAP)
-				    newtable->idx2.caps[0] *= cap_unit;
+				i = 0;
+				sscanf(iptr, "%lg", &tableptr->idx2.caps[0]);
+				if (tableptr->var2 == OUTPUT_CAP)
+				    tableptr->idx2.caps[0] *= cap_unit;
 				else
-				    newtable->idx2.caps[0] *= time_unit;
-
+				    tableptr->idx2.cons[0] *= time_unit;
 				while ((iptr = strchr(iptr, ',')) != NULL) {
 				    iptr++;
-				    newtable->size2++;
-				    sscanf(iptr, "%lg",
-						&newtable->idx2.caps[newtable->size2]);
-				    if (newtable->var2 == OUTPUT_CAP)
-					newtable->idx2.caps[newtable->size2] *= cap_unit;
+				    i++;
+				    sscanf(iptr, "%lg", &tableptr->idx2.caps[i]);
+				    if (tableptr->var2 == OUTPUT_CAP)
+					tableptr->idx2.caps[i] *= cap_unit;
 				    else
-					newtable->idx2.cons[newtable->size2] *= time_unit;
+					tableptr->idx2.cons[i] *= time_unit;
 				}
-				newtable->size2++;
 			    }
-			    else {	// newtable->invert = 0
-				// Count entries
-				iptr = token;
-				newtable->size1 = 1;
-				while ((iptr = strchr(iptr, ',')) != NULL) {
-				    iptr++;
-				    newtable->size1++;
-				}
-				newtable->idx1.times = (double *)malloc(newtable->size1 *
-					sizeof(double));
-				newtable->size1 = 0;
+			    else if (reftable && (reftable->invert == 0)) {
 				iptr = token;
-				sscanf(iptr, "%lg", &newtable->idx1.times[0]);
-				newtable->idx1.times[0] *= time_unit; 
+				i = 0;
+				sscanf(iptr, "%lg", &tableptr->idx1.times[0]);
+				tableptr->idx1.times[0] *= time_unit;
 				while ((iptr = strchr(iptr, ',')) != NULL) {
 				    iptr++;
-				    newtable->size1++;
-				    sscanf(iptr, "%lg",
-						&newtable->idx1.times[newtable->size1]);
-				    newtable->idx1.times[newtable->size1] *= time_unit;
+				    i++;
+				    sscanf(iptr, "%lg", &tableptr->idx1.times[i]);
+				    tableptr->idx1.times[i] *= time_unit;
 				}
-				newtable->size1++;
 			    }
 
-			    token = advancetoken(flib, ';'); // EOL semicolon
+			    token = advancetoken(flib, ')'); 	// Close paren
+			    token = advancetoken(flib, ';');	// EOL semicolon
 			}
-			else if (!strcasecmp(token, "index_2")) {
+		        else if (!strcasecmp(token, "index_2")) {
+
+			    // Local index values override those in the template
+
 			    token = advancetoken(flib, 0);	// Open parens
 			    token = advancetoken(flib, 0);	// Quote
 			    if (!strcmp(token, "\""))
 				token = advancetoken(flib, '\"');
 
-			    if (newtable->invert == 0) {
-				// Count entries
+			    //-------------------------
+
+			    if (reftable && (reftable->invert == 1)) {
+				// Entries had better match the ref table
 				iptr = token;
-				newtable->size2 = 1;
+				i = 0;
+				sscanf(iptr, "%lg", &tableptr->idx1.times[0]);
+				tableptr->idx1.times[0] *= time_unit;
 				while ((iptr = strchr(iptr, ',')) != NULL) {
 				    iptr++;
-				    newtable->size2++;
+				    i++;
+				    sscanf(iptr, "%lg", &tableptr->idx1.times[i]);
+				    tableptr->idx1.times[i] *= time_unit;
 				}
-				newtable->idx2.caps = (double *)malloc(newtable->size2 *
-					sizeof(double));
-				newtable->size2 = 0;
+			    }
+			    else if (reftable && (reftable->invert == 0)) {
 				iptr = token;
-				sscanf(iptr, "%lg", &newtable->idx2.caps[0]);
-				if (newtable->var2 == OUTPUT_CAP)
-				    newtable->idx2.caps[0] *= cap_unit;
-				else
-				    newtable->idx2.cons[0] *= time_unit;
+				i = 0;
+				sscanf(iptr, "%lg", &tableptr->idx2.caps[0]);
+				tableptr->idx2.caps[0] *= cap_unit;
 				while ((iptr = strchr(iptr, ',')) != NULL) {
 				    iptr++;
-				    newtable->size2++;
-				    sscanf(iptr, "%lg",
-						&newtable->idx2.caps[newtable->size2]);
-				    if (newtable->var2 == OUTPUT_CAP)
-					newtable->idx2.caps[newtable->size2] *= cap_unit;
-				    else
-					newtable->idx2.cons[newtable->size2] *= time_unit;
+				    i++;
+				    sscanf(iptr, "%lg", &tableptr->idx2.caps[i]);
+				    tableptr->idx2.caps[i] *= cap_unit;
 				}
-				newtable->size2++;
 			    }
-			    else { 	// newtable->invert == 1
-				// Count entries
-				iptr = token;
-				newtable->size1 = 1;
-				while ((iptr = strchr(iptr, ',')) != NULL) {
-				    iptr++;
-				    newtable->size1++;
+
+			    token = advancetoken(flib, ')'); 	// Close paren
+			    token = advancetoken(flib, ';');	// EOL semicolon
+			}
+			else if (!strcasecmp(token, "values")) {
+			    token = advancetoken(flib, 0);	
+			    if (strcmp(token, "("))
+				fprintf(stderr, "Failed to find start of"
+						" value table\n");
+			    token = advancetoken(flib, ')');
+
+			    // Parse the string of values and enter it into the
+			    // table "values", which is size1 rows of size2 (time
+			    // by load or constrained time), however the liberty
+			    // table is arranged
+
+			    if (reftable && reftable->size1 > 0) {
+				int locsize2;
+			        locsize2 = (reftable->size2 > 0) ? reftable->size2 : 1;
+				if (reftable->invert) {
+				    tableptr->values = (double *)malloc(locsize2 *
+						reftable->size1 * sizeof(double));
+				    iptr = token;
+				    for (j = 0; j < locsize2; j++) {
+					for (i = 0; i < reftable->size1; i++) {
+					    while (*iptr == ' ' || *iptr == '\"' ||
+							*iptr == ',')
+						iptr++;
+					    sscanf(iptr, "%lg", &gval);
+					    *(tableptr->values + i * locsize2
+							+ j) = gval * time_unit;
+					    while (*iptr != ' ' && *iptr != '\"' &&
+							*iptr != ',')
+						iptr++;
+					}
+				    }
 				}
-				newtable->idx1.times = (double *)malloc(newtable->size1 *
-					sizeof(double));
-				newtable->size1 = 0;
-				iptr = token;
-				sscanf(iptr, "%lg", &newtable->idx1.times[0]);
-				newtable->idx1.times[0] *= time_unit;
-				while ((iptr = strchr(iptr, ',')) != NULL) {
-				    iptr++;
-				    newtable->size1++;
-				    sscanf(iptr, "%lg",
-						&newtable->idx1.times[newtable->size1]);
-				    newtable->idx1.times[newtable->size1] *= time_unit;
+				else {
+				    tableptr->values = (double *)malloc(locsize2 *
+						reftable->size1 * sizeof(double));
+				    iptr = token;
+				    for (j = 0; j < locsize2; j++) {
+					for (i = 0; i < reftable->size1; i++) {
+					    while (*iptr == ' ' || *iptr == '\"' ||
+							*iptr == ',')
+						iptr++;
+					    sscanf(iptr, "%lg", &gval);
+					    *(tableptr->values + j * reftable->size1
+							+ i) = gval * time_unit;
+					    while (*iptr != ' ' && *iptr != '\"' &&
+							*iptr != ',')
+						iptr++;
+					}
+				    }
 				}
-				newtable->size1++;
 			    }
 
-			    token = advancetoken(flib, ';'); // EOL semicolon
+			    token = advancetoken(flib, 0);
+			    if (strcmp(token, ";"))
+				fprintf(stderr, "Failed to find end of value table\n");
+			    token = advancetoken(flib, 0);
+
 			}
+			else if (strcmp(token, "{"))
+			    fprintf(stderr, "Failed to find end of timing block\n");
 		    }
-		}
-		else if (!strcasecmp(token, "cell")) {
-		    newcell = (cell *)malloc(sizeof(cell));
-		    newcell->next = NULL;
-		    if (lastcell != NULL)
-			lastcell->next = newcell;
-		    else
-			*celllist = newcell;
-		    lastcell = newcell;
-		    token = advancetoken(flib, 0);	// Open parens
-		    if (!strcmp(token, "("))
-			token = advancetoken(flib, ')');	// Cellname
-		    newcell->name = strdup(token);
-		    token = advancetoken(flib, 0);	// Find start of block
-		    if (strcmp(token, "{"))
-			fprintf(stderr, "Error: failed to find start of block\n");
-		    newcell->type = GATE;		// Default type
-		    newcell->function = NULL;
-		    newcell->pins = NULL;
-		    newcell->area = 1.0;
-		    newcell->maxtrans = 0.0;
-		    newcell->maxcap = 0.0;
-		    section = CELLDEF;
-		}
-		else if (!strcasecmp(token, "time_unit")) {
-		   char *metric;
-
-		   token = advancetoken(flib, 0);
-		   if (token == NULL) break;
-		   if (!strcmp(token, ":")) {
-		      token = advancetoken(flib, 0);
-		      if (token == NULL) break;
-		   }
-		   if (!strcmp(token, "\"")) {
-		      token = advancetoken(flib, '\"');
-		      if (token == NULL) break;
-		   }
-		   time_unit = strtod(token, &metric);
-		   if (*metric != '\0') {
-		      if (!strcmp(metric, "ns"))
-			 time_unit *= 1E3;
-		      else if (!strcmp(metric, "us"))
-			 time_unit *= 1E6;
-		      else if (!strcmp(metric, "fs"))
-			 time_unit *= 1E-3;
-		      else if (strcmp(metric, "ps"))
-			 fprintf(stderr, "Don't understand time units \"%s\"\n",
-				token);
-		   }
-		   else {
-		      token = advancetoken(flib, 0);
-		      if (token == NULL) break;
-		      if (!strcmp(token, "ns"))
-			 time_unit *= 1E3;
-		      else if (!strcmp(token, "us"))
-			 time_unit *= 1E6;
-		      else if (!strcmp(token, "fs"))
-			 time_unit *= 1E-3;
-		      else if (strcmp(token, "ps"))
-			 fprintf(stderr, "Don't understand time units \"%s\"\n",
-				token);
-		   }
-		   token = advancetoken(flib, ';');
-		}
-		else if (!strcasecmp(token, "capacitive_load_unit")) {
-		   char *metric;
-
-		   token = advancetoken(flib, 0);
-		   if (token == NULL) break;
-		   if (!strcmp(token, "(")) {
-		      token = advancetoken(flib, ')');
-		      if (token == NULL) break;
-		   }
-		   cap_unit = strtod(token, &metric);
-		   if (*metric != '\0') {
-		      while (isspace(*metric)) metric++;
-		      if (*metric == ',') metric++;
-		      while ((*metric != '\0') && isspace(*metric)) metric++;
-		      if (!strcasecmp(metric, "af"))
-			 cap_unit *= 1E-3;
-		      else if (!strcasecmp(metric, "pf"))
-			 cap_unit *= 1000;
-		      else if (!strcasecmp(metric, "nf"))
-			 cap_unit *= 1E6;
-		      else if (!strcasecmp(metric, "uf"))
-			 cap_unit *= 1E9;
-		      else if (strcasecmp(metric, "ff"))
-			 fprintf(stderr, "Don't understand capacitive units \"%s\"\n",
-				token);
-		   }
-		   else {
-		      token = advancetoken(flib, 0);
-		      if (token == NULL) break;
-		      if (!strcasecmp(token, "af"))
-			 cap_unit *= 1E-3;
-		      else if (!strcasecmp(token, "pf"))
-			 cap_unit *= 1000;
-		      else if (!strcasecmp(token, "nf"))
-			 cap_unit *= 1E6;
-		      else if (!strcasecmp(token, "uf"))
-			 cap_unit *= 1E9;
-		      else if (strcasecmp(token, "ff"))
-			 fprintf(stderr, "Don't understand capacitive units \"%s\"\n",
-				token);
-		   }
-		   token = advancetoken(flib, ';');
+		    table_finish(tableptr, reftable);
 		}
 		else {
 		    // For unhandled tokens, read in tokens.  If it is
@@ -1970,989 +4154,6681 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
 		    }
 		}
 		break;
+	}
+	if (section == LIBBLOCK) break;		// End of cell def
+	token = advancetoken(flib, 0);
+    }
+}
 
-	    case CELLDEF:
+/*--------------------------------------------------------------*/
+/* Index the cell groups of a liberty file for lazy loading.	*/
+/* This is a raw scan of the file that only tracks comments,	*/
+/* quotes, and brace nesting, and records the byte offsets of	*/
+/* each "cell (name) { ... }" group at the top level of the	*/
+/* library.  The file is rewound afterwards.			*/
+/*--------------------------------------------------------------*/
 
-		if (!strcmp(token, "}")) {
-		    section = LIBBLOCK;			// End of cell def
+void libertyIndex(FILE *flib)
+{
+    char buffer[65536];
+    char header[256], name[256];
+    size_t n, k;
+    long offset, hstart;
+    int lines, hline, depth, hlen, current, maxcells;
+    char c, prev, incomment, inquote;
+    libindex *cellidx;
+
+    lazylib = (lazyload *)calloc(1, sizeof(lazyload));
+    lazylib->file = flib;
+    maxcells = 256;
+    lazylib->cells = (libindex *)malloc(maxcells * sizeof(libindex));
+
+    offset = hstart = 0;
+    lines = hline = depth = hlen = 0;
+    current = -1;
+    prev = incomment = inquote = 0;
+
+    while ((n = fread(buffer, 1, sizeof(buffer), flib)) > 0) {
+	for (k = 0; k < n; k++, offset++) {
+	    c = buffer[k];
+	    if (c == '\n') lines++;
+
+	    if (incomment) {
+		if ((prev == '*') && (c == '/')) {
+		    incomment = 0;
+		    c = 0;
 		}
-		else if (!strcasecmp(token, "pin")) {
-		    token = advancetoken(flib, 0);	// Open parens
-		    if (!strcmp(token, "("))
-			token = advancetoken(flib, ')');	// Close parens
+		prev = c;
+		continue;
+	    }
+	    if ((prev == '/') && (c == '*')) {
+		incomment = 1;
+		prev = 0;
+		if ((depth == 1) && (hlen > 0)) hlen--;	// Remove the '/'
+		continue;
+	    }
+	    prev = c;
 
-		    newpin = parse_pin(newcell, token, SENSE_NONE);
+	    if (inquote) {
+		if (c == '\"') inquote = 0;
+		else if ((depth == 1) && (hlen < 255)) header[hlen++] = c;
+		continue;
+	    }
+	    if (c == '\"') {
+		inquote = 1;
+		continue;
+	    }
 
-		    token = advancetoken(flib, 0);	// Find start of block
-		    if (strcmp(token, "{"))
-			fprintf(stderr, "Error: failed to find start of block\n");
-		    section = PINDEF;
-		}		
-		else if (!strcasecmp(token, "area")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    sscanf(token, "%lg", &newcell->area);
-		}
-		else if (!strcasecmp(token, "ff")) {
-		    newcell->type |= DFF;
-		    token = advancetoken(flib, '{');
-		    section = FLOPDEF;
-		}
-		else if (!strcasecmp(token, "latch")) {
-		    newcell->type |= LATCH;
-		    token = advancetoken(flib, '{');
-		    section = LATCHDEF;
-		}
-		else {
-		    // For unhandled tokens, read in tokens.  If it is
-		    // a definition or function, read to end-of-line.  If
-		    // it is a block definition, read to end-of-block.
-		    while (1) {
-			token = advancetoken(flib, 0);
-			if (token == NULL) break;
-			if (!strcmp(token, ";")) break;
-			if (!strcmp(token, "\""))
-			    token = advancetoken(flib, '\"');
-			if (!strcmp(token, "("))
-			    token = advancetoken(flib, ')');
-			if (!strcmp(token, "{")) {
-			    token = advancetoken(flib, '}');
-			    break;
+	    if (c == '{') {
+		depth++;
+		if ((depth == 2) && (hlen > 0)) {
+		    header[hlen] = '\0';
+		    if (sscanf(header, " cell ( %255[^) \t\n]", name) == 1) {
+			if (lazylib->numcells == maxcells) {
+			    maxcells <<= 1;
+			    lazylib->cells = (libindex *)realloc(lazylib->cells,
+					maxcells * sizeof(libindex));
 			}
+			current = lazylib->numcells++;
+			cellidx = lazylib->cells + current;
+			cellidx->name = strdup(name);
+			cellidx->start = hstart;
+			cellidx->startline = hline;
 		    }
 		}
-		break;
-
-	    case FLOPDEF:
-
-		if (!strcmp(token, "}")) {
-		    section = CELLDEF;			// End of flop def
-		}
-		else if (!strcasecmp(token, "next_state")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    newpin = parse_pin(newcell, token, SENSE_NONE);
-		    newpin->type |= DFFIN;
-		}
-		else if (!strcasecmp(token, "clocked_on")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    if (strchr(token, '\'') != NULL)
-			newcell->type |= CLK_SENSE_MASK;
-		    else if (strchr(token, '!') != NULL)
-			newcell->type |= CLK_SENSE_MASK;
-		    newpin = parse_pin(newcell, token, SENSE_NONE);
-		    newpin->type |= DFFCLK;
-		}
-		else if (!strcasecmp(token, "clear")) {
-		    newcell->type |= RST_MASK;
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    if (strchr(token, '\'') != NULL)
-			newcell->type |= RST_SENSE_MASK;
-		    else if (strchr(token, '!') != NULL)
-			newcell->type |= RST_SENSE_MASK;
-		    newpin = parse_pin(newcell, token, SENSE_NONE);
-		    newpin->type |= DFFRST;
+		hlen = 0;
+	    }
+	    else if (c == '}') {
+		if ((depth == 2) && (current >= 0)) {
+		    lazylib->cells[current].end = offset + 1;
+		    lazylib->cells[current].endline = lines;
+		    current = -1;
 		}
-		else if (!strcasecmp(token, "preset")) {
-		    newcell->type |= SET_MASK;
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    if (strchr(token, '\'') != NULL)
-			newcell->type |= SET_SENSE_MASK;
-		    else if (strchr(token, '!') != NULL)
-			newcell->type |= SET_SENSE_MASK;
-		    newpin = parse_pin(newcell, token, SENSE_NONE);
-		    newpin->type |= DFFSET;
+		depth--;
+		hlen = 0;
+	    }
+	    else if (c == ';')
+		hlen = 0;
+	    else if (depth == 1) {
+		if ((hlen == 0) && isspace(c)) continue;
+		if (hlen == 0) {
+		    hstart = offset;
+		    hline = lines;
 		}
-		else
-		    token = advancetoken(flib, ';');	// Read to end-of-statement
+		if (hlen < 255) header[hlen++] = c;
+	    }
+	}
+    }
+    rewind(flib);
 
-		break;
+    if (verbose > 0)
+	fprintf(stdout, "Indexed %d cells in liberty file.\n", lazylib->numcells);
+}
 
-	    case LATCHDEF:
+/*--------------------------------------------------------------*/
+/* Parse the liberty cell group of a cell that was skipped in	*/
+/* lazy mode.  This may be called while reading the verilog	*/
+/* netlist, so the tokenizer state is saved and restored.	*/
+/*--------------------------------------------------------------*/
 
-		if (!strcmp(token, "}")) {
-		    section = CELLDEF;			// End of flop def
-		}
-		else if (!strcasecmp(token, "data_in")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    newpin = parse_pin(newcell, token, SENSE_NONE);
-		    newpin->type |= LATCHIN;
-		}
-		else if (!strcasecmp(token, "enable")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    if (strchr(token, '\'') != NULL)
-			newcell->type |= EN_SENSE_MASK;
-		    else if (strchr(token, '!') != NULL)
-			newcell->type |= EN_SENSE_MASK;
-		    newpin = parse_pin(newcell, token, SENSE_NONE);
-		    newpin->type |= LATCHEN;
-		}
-		else
-		    token = advancetoken(flib, ';');	// Read to end-of-statement
+void liberty_load_cell(cellptr testcell)
+{
+    char *savedline, *token;
+    long savedpos;
+    int savedlinenum;
+    libindex *cellidx;
+
+    if ((lazylib == NULL) || (testcell->libindex < 0)) return;
+    cellidx = lazylib->cells + testcell->libindex;
+
+    savedline = (char *)malloc(LIB_LINE_MAX);
+    memcpy(savedline, tokenline, LIB_LINE_MAX);
+    savedpos = (tokenpos == NULL) ? -1 : (long)(tokenpos - tokenline);
+    savedlinenum = fileCurrentLine;
+
+    fseek(lazylib->file, cellidx->start, SEEK_SET);
+    tokenpos = NULL;
+    fileCurrentLine = cellidx->startline;
+
+    token = advancetoken(lazylib->file, 0);	// "cell"
+    token = advancetoken(lazylib->file, 0);	// Open parens
+    if (!strcmp(token, "("))
+	token = advancetoken(lazylib->file, ')');	// Cellname
+    token = advancetoken(lazylib->file, 0);	// Find start of block
+    if (strcmp(token, "{"))
+	fprintf(stderr, "Error: failed to find start of block\n");
+    else
+	libertyReadCell(lazylib->file, testcell, lazylib->tables,
+		lazylib->time_unit, lazylib->cap_unit);
 
-		break;
+    testcell->libindex = -1;
+    lazylib->numparsed++;
 
-	    case PINDEF:
+    memcpy(tokenline, savedline, LIB_LINE_MAX);
+    tokenpos = (savedpos < 0) ? NULL : tokenline + savedpos;
+    fileCurrentLine = savedlinenum;
+    free(savedline);
+}
 
-		if (!strcmp(token, "}")) {
-		    section = CELLDEF;			// End of pin def
-		}
-		else if (!strcasecmp(token, "capacitance")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    sscanf(token, "%lg", &newpin->capr);
-		    newpin->capr *= cap_unit;
-		}
-		else if (!strcasecmp(token, "rise_capacitance")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    sscanf(token, "%lg", &newpin->capr);
-		    newpin->capr *= cap_unit;
-		}
-		else if (!strcasecmp(token, "fall_capacitance")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    sscanf(token, "%lg", &newpin->capf);
-		    newpin->capf *= cap_unit;
-		}
-		else if (!strcasecmp(token, "function")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, 0);	// Open quote
-		    if (!strcmp(token, "\""))
-			token = advancetoken(flib, '\"');	// Find function string
-		    if (newpin->type & OUTPUT) {
-			newcell->function = strdup(token);
-		    }
+/*--------------------------------------------------------------*/
+/* Read a liberty format file and collect information about	*/
+/* the timing properties of each standard cell.			*/
+/*--------------------------------------------------------------*/
+
+void
+libertyRead(FILE *flib, lutable **tablelist, cell **celllist,
+		wireload **wirelist, wlselect **sellist)
+{
+    char *token;
+    char *libname = NULL;
+    int section = INIT;
+
+    double time_unit = 1.0;	// Time unit multiplier, to get ps
+    double cap_unit = 1.0;	// Capacitive unit multiplier, to get fF
+    double res_unit = 1.0;	// Resistive unit multiplier, to get kOhm
+    double defmaxtrans = 0.0;	// Default maximum transition time
+    double defmaxcap = 0.0;	// Default maximum load
+
+    int i;
+    char *iptr;
+
+    lutable *newtable;
+    cell *newcell, *lastcell;
+    libindex *cellidx;
+
+    lastcell = NULL;
+
+    /* Read tokens off of the line */
+    token = advancetoken(flib, 0);
+
+    while (token != NULL) {
+
+	switch (section) {
+	    case INIT:
+		if (!strcasecmp(token, "library")) {
 		    token = advancetoken(flib, 0);
-		    if (strcmp(token, ";"))
-			fprintf(stderr, "Expected end-of-statement.\n");
-		}
-		else if (!strcasecmp(token, "direction")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');
-		    if (!strcasecmp(token, "input")) {
-			newpin->type |= INPUT;
-		    }
-		    else if (!strcasecmp(token, "output")) {
-			newpin->type |= OUTPUT;
-		    }
-		}
-		else if (!strcasecmp(token, "max_transition")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    sscanf(token, "%lg", &newcell->maxtrans);
-		    newcell->maxtrans *= time_unit;
-		}
-		else if (!strcasecmp(token, "max_capacitance")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// To end-of-statement
-		    sscanf(token, "%lg", &newcell->maxcap);
-		    newcell->maxcap *= cap_unit;
-		}
-		else if (!strcasecmp(token, "timing")) {
-		    token = advancetoken(flib, 0);	// Arguments, if any
 		    if (strcmp(token, "("))
-			fprintf(stderr, "Error: failed to find start of block\n");
+			fprintf(stderr, "Library not followed by name\n");
 		    else
-		       token = advancetoken(flib, ')');	// Arguments, if any
-		    token = advancetoken(flib, 0);	// Find start of block
-		    if (strcmp(token, "{"))
-			fprintf(stderr, "Error: failed to find start of block\n");
-		    testpin = NULL;
-		    sense_type = SENSE_NONE;
-		    section = TIMING;
-		}
-		else {
-		    // For unhandled tokens, read in tokens.  If it is
-		    // a definition or function, read to end-of-line.  If
-		    // it is a block definition, read to end-of-block.
-		    while (1) {
-			token = advancetoken(flib, 0);
-			if (token == NULL) break;
-			if (!strcmp(token, ";")) break;
-			if (!strcmp(token, "\""))
-			    token = advancetoken(flib, '\"');
-			if (!strcmp(token, "{")) {
-			    token = advancetoken(flib, '}');
-			    break;
-			}
+			token = advancetoken(flib, ')');
+		    fprintf(stderr, "Parsing library \"%s\"\n", token);
+		    libname = strdup(token);
+		    token = advancetoken(flib, 0);
+		    if (strcmp(token, "{")) {
+			fprintf(stderr, "Did not find opening brace "
+					"on library block\n");
+			exit(1);
 		    }
+		    section = LIBBLOCK;
 		}
+		else
+		    fprintf(stderr, "Unknown input \"%s\", looking for "
+					"\"library\"\n", token);
 		break;
 
-	    case TIMING:
+	    case LIBBLOCK:
+		// Here we check for the main blocks, again not rigorously. . .
 
-		if (!strcmp(token, "}")) {
-		    section = PINDEF;			// End of timing def
+		if (!strcasecmp(token, "}")) {
+		    fprintf(stdout, "End of library at line %d\n", fileCurrentLine);
+		    if (verbose > 0) report_table_shapes(*tablelist);
+		    section = INIT;			// End of library block
 		}
-		else if (!strcasecmp(token, "related_pin")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// Read to end of statement
-		    // Create the related pin if needed
-		    testpin = parse_pin(newcell, token, sense_type);
+		else if (!strcasecmp(token, "delay_model")) {
+		    token = advancetoken(flib, 0);
+		    if (strcmp(token, ":"))
+			fprintf(stderr, "Input missing colon\n");
+		    token = advancetoken(flib, ';');
+		    if (strcasecmp(token, "table_lookup")) {
+			fprintf(stderr, "Sorry, only know how to "
+					"handle table lookup!\n");
+			exit(1);
+		    }
 		}
-		else if (!strcasecmp(token, "timing_sense")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// Read to end of statement
-		    if (!strcasecmp(token, "positive_unate")) {
-			if (testpin)
-			   testpin->sense = SENSE_POSITIVE;
+		else if (!strcasecmp(token, "lu_table_template") ||
+			 !strcasecmp(token, "power_lut_template")) {
+		    // Read in template information;
+		    newtable = (lutable *)malloc(sizeof(lutable));
+		    newtable->name = NULL;
+		    newtable->invert = 0;
+		    newtable->var1 = UNKNOWN;
+		    newtable->var2 = UNKNOWN;
+		    newtable->size1 = 0;
+		    newtable->size2 = 0;
+		    newtable->idx1.times = NULL;
+		    newtable->idx2.caps = NULL;
+		    newtable->values = NULL;
+		    newtable->rspan1 = NULL;
+		    newtable->rspan2 = NULL;
+		    newtable->vecfunc = NULL;
+		    newtable->binfunc = NULL;
+		    newtable->next = *tablelist;
+		    *tablelist = newtable;
+
+		    token = advancetoken(flib, 0);
+		    if (strcmp(token, "("))
+			fprintf(stderr, "Input missing open parens\n");
+		    else
+			token = advancetoken(flib, ')');
+		    newtable->name = strdup(token);
+		    while (*token != '}') {
+			token = advancetoken(flib, 0);
+			if (!strcasecmp(token, "variable_1")) {
+			    token = advancetoken(flib, 0);
+			    token = advancetoken(flib, ';');
+			    newtable->var1 = get_table_type(token);
+			    if (newtable->var1 == OUTPUT_CAP || newtable->var1 == CONSTRAINED_TIME)
+				newtable->invert = 1;
+			}
+			else if (!strcasecmp(token, "variable_2")) {
+			    token = advancetoken(flib, 0);
+			    token = advancetoken(flib, ';');
+			    newtable->var2 = get_table_type(token);
+			    if (newtable->var2 == TRANSITION_TIME || newtable->var2 == RELATED_TIME)
+				newtable->invert = 1;
+			}
+			else if (!strcasecmp(token, "index_1")) {
+			    token = advancetoken(flib, 0);	// Open parens
+			    token = advancetoken(flib, 0);	// Quote
+			    if (!strcmp(token, "\""))
+				token = advancetoken(flib, '\"');
+
+			    if (newtable->invert == 1) {
+				// Count entries
+				iptr = token;
+				newtable->size2 = 1;
+				while ((iptr = strchr(iptr, ',')) != NULL) {
+				    iptr++;
+				    newtable->size2++;
+				}
+				newtable->idx2.caps = (double *)malloc(newtable->size2 *
+					sizeof(double));
+				newtable->size2 = 0;
+				iptr = token;
+				sscanf(iptr, "%lg", &newtable->idx2.caps[0]);
+				if (newtable->var2 == OUTPUT_CAP)
+				    newtable->idx2.caps[0] *= cap_unit;
+				else
+				    newtable->idx2.caps[0] *= time_unit;
+
+				while ((iptr = strchr(iptr, ',')) != NULL) {
+				    iptr++;
+				    newtable->size2++;
+				    sscanf(iptr, "%lg",
+						&newtable->idx2.caps[newtable->size2]);
+				    if (newtable->var2 == OUTPUT_CAP)
+					newtable->idx2.caps[newtable->size2] *= cap_unit;
+				    else
+					newtable->idx2.cons[newtable->size2] *= time_unit;
+				}
+				newtable->size2++;
+			    }
+			    else {	// newtable->invert = 0
+				// Count entries
+				iptr = token;
+				newtable->size1 = 1;
+				while ((iptr = strchr(iptr, ',')) != NULL) {
+				    iptr++;
+				    newtable->size1++;
+				}
+				newtable->idx1.times = (double *)malloc(newtable->size1 *
+					sizeof(double));
+				newtable->size1 = 0;
+				iptr = token;
+				sscanf(iptr, "%lg", &newtable->idx1.times[0]);
+				newtable->idx1.times[0] *= time_unit; 
+				while ((iptr = strchr(iptr, ',')) != NULL) {
+				    iptr++;
+				    newtable->size1++;
+				    sscanf(iptr, "%lg",
+						&newtable->idx1.times[newtable->size1]);
+				    newtable->idx1.times[newtable->size1] *= time_unit;
+				}
+				newtable->size1++;
+			    }
+
+			    token = advancetoken(flib, ';'); // EOL semicolon
+			}
+			else if (!strcasecmp(token, "index_2")) {
+			    token = advancetoken(flib, 0);	// Open parens
+			    token = advancetoken(flib, 0);	// Quote
+			    if (!strcmp(token, "\""))
+				token = advancetoken(flib, '\"');
+
+			    if (newtable->invert == 0) {
+				// Count entries
+				iptr = token;
+				newtable->size2 = 1;
+				while ((iptr = strchr(iptr, ',')) != NULL) {
+				    iptr++;
+				    newtable->size2++;
+				}
+				newtable->idx2.caps = (double *)malloc(newtable->size2 *
+					sizeof(double));
+				newtable->size2 = 0;
+				iptr = token;
+				sscanf(iptr, "%lg", &newtable->idx2.caps[0]);
+				if (newtable->var2 == OUTPUT_CAP)
+				    newtable->idx2.caps[0] *= cap_unit;
+				else
+				    newtable->idx2.cons[0] *= time_unit;
+				while ((iptr = strchr(iptr, ',')) != NULL) {
+				    iptr++;
+				    newtable->size2++;
+				    sscanf(iptr, "%lg",
+						&newtable->idx2.caps[newtable->size2]);
+				    if (newtable->var2 == OUTPUT_CAP)
+					newtable->idx2.caps[newtable->size2] *= cap_unit;
+				    else
+					newtable->idx2.cons[newtable->size2] *= time_unit;
+				}
+				newtable->size2++;
+			    }
+			    else { 	// newtable->invert == 1
+				// Count entries
+				iptr = token;
+				newtable->size1 = 1;
+				while ((iptr = strchr(iptr, ',')) != NULL) {
+				    iptr++;
+				    newtable->size1++;
+				}
+				newtable->idx1.times = (double *)malloc(newtable->size1 *
+					sizeof(double));
+				newtable->size1 = 0;
+				iptr = token;
+				sscanf(iptr, "%lg", &newtable->idx1.times[0]);
+				newtable->idx1.times[0] *= time_unit;
+				while ((iptr = strchr(iptr, ',')) != NULL) {
+				    iptr++;
+				    newtable->size1++;
+				    sscanf(iptr, "%lg",
+						&newtable->idx1.times[newtable->size1]);
+				    newtable->idx1.times[newtable->size1] *= time_unit;
+				}
+				newtable->size1++;
+			    }
+
+			    token = advancetoken(flib, ';'); // EOL semicolon
+			}
+		    }
+		    table_finish(newtable, NULL);
+		}
+		else if (!strcasecmp(token, "cell")) {
+		    newcell = (cell *)malloc(sizeof(cell));
+		    newcell->next = NULL;
+		    if (lastcell != NULL)
+			lastcell->next = newcell;
+		    else
+			*celllist = newcell;
+		    lastcell = newcell;
+		    token = advancetoken(flib, 0);	// Open parens
+		    if (!strcmp(token, "("))
+			token = advancetoken(flib, ')');	// Cellname
+		    newcell->name = strdup(token);
+		    token = advancetoken(flib, 0);	// Find start of block
+		    if (strcmp(token, "{"))
+			fprintf(stderr, "Error: failed to find start of block\n");
+		    newcell->type = GATE;		// Default type
+		    newcell->function = NULL;
+		    newcell->pins = NULL;
+		    newcell->area = 1.0;
+		    newcell->maxtrans = defmaxtrans;
+		    newcell->maxcap = defmaxcap;
+		    newcell->libindex = -1;
+		    newcell->early = 0.0;
+		    newcell->late = 0.0;
+
+		    // In lazy mode, skip over the cell group and parse it
+		    // when the cell is first used.
+
+		    cellidx = NULL;
+		    if (lazylib != NULL) {
+			if ((lazylib->next < lazylib->numcells) &&
+				!strcmp(lazylib->cells[lazylib->next].name, newcell->name))
+			    newcell->libindex = lazylib->next++;
+			else {
+			    for (i = 0; i < lazylib->numcells; i++)
+				if (!strcmp(lazylib->cells[i].name, newcell->name))
+				    break;
+			    if (i < lazylib->numcells) {
+				newcell->libindex = i;
+				lazylib->next = i + 1;
+			    }
+			}
+			if (newcell->libindex >= 0)
+			    cellidx = lazylib->cells + newcell->libindex;
 			else
-			   sense_type = SENSE_POSITIVE;
+			    fprintf(stderr, "Cell \"%s\" not found in liberty index\n",
+					newcell->name);
 		    }
-		    else if (!strcasecmp(token, "negative_unate")) {
-			if (testpin)
-			   testpin->sense = SENSE_NEGATIVE;
+		    if (cellidx != NULL) {
+			fseek(flib, cellidx->end, SEEK_SET);
+			tokenpos = NULL;
+			fileCurrentLine = cellidx->endline;
+		    }
+		    else
+			libertyReadCell(flib, newcell, *tablelist, time_unit, cap_unit);
+		}
+		else if (!strcasecmp(token, "wire_load")) {
+		    wireload *newwl;
+		    int n, fval;
+		    double lval;
+
+		    newwl = (wireload *)malloc(sizeof(wireload));
+		    newwl->capacitance = 0.0;
+		    newwl->resistance = 0.0;
+		    newwl->slope = 0.0;
+		    newwl->entries = 0;
+		    newwl->fanout = NULL;
+		    newwl->length = NULL;
+		    newwl->next = *wirelist;
+		    *wirelist = newwl;
+
+		    token = advancetoken(flib, 0);
+		    if (strcmp(token, "("))
+			fprintf(stderr, "Input missing open parens\n");
+		    else
+			token = advancetoken(flib, ')');
+		    newwl->name = strdup(unquote(token));
+		    token = advancetoken(flib, 0);
+		    if (strcmp(token, "{"))
+			fprintf(stderr, "Did not find opening brace on wire_load block\n");
+
+		    while (1) {
+			token = advancetoken(flib, 0);
+			if ((token == NULL) || !strcmp(token, "}")) break;
+			if (!strcasecmp(token, "capacitance")) {
+			    token = advancetoken(flib, 0);	// Colon
+			    token = advancetoken(flib, ';');	// To end-of-statement
+			    sscanf(token, "%lg", &newwl->capacitance);
+			    newwl->capacitance *= cap_unit;
+			}
+			else if (!strcasecmp(token, "resistance")) {
+			    token = advancetoken(flib, 0);	// Colon
+			    token = advancetoken(flib, ';');	// To end-of-statement
+			    sscanf(token, "%lg", &newwl->resistance);
+			    newwl->resistance *= res_unit;
+			}
+			else if (!strcasecmp(token, "slope")) {
+			    token = advancetoken(flib, 0);	// Colon
+			    token = advancetoken(flib, ';');	// To end-of-statement
+			    sscanf(token, "%lg", &newwl->slope);
+			}
+			else if (!strcasecmp(token, "fanout_length")) {
+			    token = advancetoken(flib, 0);	// Open parens
+			    token = advancetoken(flib, ')');	// Fanout, length
+			    if (sscanf(token, "%d , %lg", &fval, &lval) == 2) {
+				// Keep entries sorted by fanout
+				n = newwl->entries++;
+				newwl->fanout = (int *)realloc(newwl->fanout,
+					newwl->entries * sizeof(int));
+				newwl->length = (double *)realloc(newwl->length,
+					newwl->entries * sizeof(double));
+				while ((n > 0) && (newwl->fanout[n - 1] > fval)) {
+				    newwl->fanout[n] = newwl->fanout[n - 1];
+				    newwl->length[n] = newwl->length[n - 1];
+				    n--;
+				}
+				newwl->fanout[n] = fval;
+				newwl->length[n] = lval;
+			    }
+			    else
+				fprintf(stderr, "Bad fanout_length entry \"%s\"\n", token);
+			    token = advancetoken(flib, ';');	// To end-of-statement
+			}
 			else
-			   sense_type = SENSE_NEGATIVE;
+			    token = advancetoken(flib, ';');	// Read to end-of-statement
 		    }
-		    else if (!strcasecmp(token, "non_unate")) {
-			if (testpin)
-			   testpin->sense = SENSE_NONE;
+		}
+		else if (!strcasecmp(token, "wire_load_selection")) {
+		    wlselect *newsel;
+		    char *selname, *nptr;
+
+		    token = advancetoken(flib, 0);
+		    if (strcmp(token, "("))
+			fprintf(stderr, "Input missing open parens\n");
+		    else
+			token = advancetoken(flib, ')');
+		    selname = strdup(unquote(token));
+		    token = advancetoken(flib, 0);
+		    if (strcmp(token, "{"))
+			fprintf(stderr, "Did not find opening brace on "
+				"wire_load_selection block\n");
+
+		    while (1) {
+			token = advancetoken(flib, 0);
+			if ((token == NULL) || !strcmp(token, "}")) break;
+			if (!strcasecmp(token, "wire_load_from_area")) {
+			    token = advancetoken(flib, 0);	// Open parens
+			    token = advancetoken(flib, ')');	// min, max, name
+			    nptr = strrchr(token, ',');
+			    newsel = (wlselect *)malloc(sizeof(wlselect));
+			    newsel->name = selname;
+			    newsel->minarea = 0.0;
+			    newsel->maxarea = 0.0;
+			    sscanf(token, "%lg , %lg", &newsel->minarea, &newsel->maxarea);
+			    newsel->wlname = strdup(unquote((nptr) ? nptr + 1 : token));
+			    newsel->next = *sellist;
+			    *sellist = newsel;
+			    token = advancetoken(flib, ';');	// To end-of-statement
+			}
 			else
-			   sense_type = SENSE_NONE;
+			    token = advancetoken(flib, ';');	// Read to end-of-statement
 		    }
 		}
-		else if (!strcasecmp(token, "timing_type")) {
-		    token = advancetoken(flib, 0);	// Colon
-		    token = advancetoken(flib, ';');	// Read to end of statement
+		else if (!strcasecmp(token, "default_max_transition")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    sscanf(token, "%lg", &defmaxtrans);
+		    defmaxtrans *= time_unit;
+		}
+		else if (!strcasecmp(token, "default_max_capacitance")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    sscanf(token, "%lg", &defmaxcap);
+		    defmaxcap *= cap_unit;
+		}
+		else if (!strcasecmp(token, "default_wire_load")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    default_wireload = strdup(unquote(token));
+		}
+		else if (!strcasecmp(token, "default_wire_load_selection")) {
+		    token = advancetoken(flib, 0);	// Colon
+		    token = advancetoken(flib, ';');	// To end-of-statement
+		    default_wlselect = strdup(unquote(token));
+		}
+		else if (!strcasecmp(token, "pulling_resistance_unit")) {
+		   char *metric;
+
+		   token = advancetoken(flib, 0);	// Colon
+		   token = advancetoken(flib, ';');	// To end-of-statement
+		   token = unquote(token);
+		   res_unit = strtod(token, &metric);
+		   if (!strcmp(metric, "ohm"))
+		      res_unit *= 1E-3;
+		   else if (!strcmp(metric, "Mohm"))
+		      res_unit *= 1E3;
+		   else if (strcmp(metric, "kohm"))
+		      fprintf(stderr, "Don't understand resistance units \"%s\"\n",
+				token);
+		}
+		else if (!strcasecmp(token, "time_unit")) {
+		   char *metric;
+
+		   token = advancetoken(flib, 0);
+		   if (token == NULL) break;
+		   if (!strcmp(token, ":")) {
+		      token = advancetoken(flib, 0);
+		      if (token == NULL) break;
+		   }
+		   if (!strcmp(token, "\"")) {
+		      token = advancetoken(flib, '\"');
+		      if (token == NULL) break;
+		   }
+		   time_unit = strtod(token, &metric);
+		   if (*metric != '\0') {
+		      if (!strcmp(metric, "ns"))
+			 time_unit *= 1E3;
+		      else if (!strcmp(metric, "us"))
+			 time_unit *= 1E6;
+		      else if (!strcmp(metric, "fs"))
+			 time_unit *= 1E-3;
+		      else if (strcmp(metric, "ps"))
+			 fprintf(stderr, "Don't understand time units \"%s\"\n",
+				token);
+		   }
+		   else {
+		      token = advancetoken(flib, 0);
+		      if (token == NULL) break;
+		      if (!strcmp(token, "ns"))
+			 time_unit *= 1E3;
+		      else if (!strcmp(token, "us"))
+			 time_unit *= 1E6;
+		      else if (!strcmp(token, "fs"))
+			 time_unit *= 1E-3;
+		      else if (strcmp(token, "ps"))
+			 fprintf(stderr, "Don't understand time units \"%s\"\n",
+				token);
+		   }
+		   token = advancetoken(flib, ';');
+		}
+		else if (!strcasecmp(token, "capacitive_load_unit")) {
+		   char *metric;
+
+		   token = advancetoken(flib, 0);
+		   if (token == NULL) break;
+		   if (!strcmp(token, "(")) {
+		      token = advancetoken(flib, ')');
+		      if (token == NULL) break;
+		   }
+		   cap_unit = strtod(token, &metric);
+		   if (*metric != '\0') {
+		      while (isspace(*metric)) metric++;
+		      if (*metric == ',') metric++;
+		      while ((*metric != '\0') && isspace(*metric)) metric++;
+		      if (!strcasecmp(metric, "af"))
+			 cap_unit *= 1E-3;
+		      else if (!strcasecmp(metric, "pf"))
+			 cap_unit *= 1000;
+		      else if (!strcasecmp(metric, "nf"))
+			 cap_unit *= 1E6;
+		      else if (!strcasecmp(metric, "uf"))
+			 cap_unit *= 1E9;
+		      else if (strcasecmp(metric, "ff"))
+			 fprintf(stderr, "Don't understand capacitive units \"%s\"\n",
+				token);
+		   }
+		   else {
+		      token = advancetoken(flib, 0);
+		      if (token == NULL) break;
+		      if (!strcasecmp(token, "af"))
+			 cap_unit *= 1E-3;
+		      else if (!strcasecmp(token, "pf"))
+			 cap_unit *= 1000;
+		      else if (!strcasecmp(token, "nf"))
+			 cap_unit *= 1E6;
+		      else if (!strcasecmp(token, "uf"))
+			 cap_unit *= 1E9;
+		      else if (strcasecmp(token, "ff"))
+			 fprintf(stderr, "Don't understand capacitive units \"%s\"\n",
+				token);
+		   }
+		   token = advancetoken(flib, ';');
+		}
+		else {
+		    // For unhandled tokens, read in tokens.  If it is
+		    // a definition or function, read to end-of-line.  If
+		    // it is a block definition, read to end-of-block.
+		    while (1) {
+			token = advancetoken(flib, 0);
+			if (token == NULL) break;
+			if (!strcmp(token, ";")) break;
+			if (!strcmp(token, "\""))
+			    token = advancetoken(flib, '\"');
+			if (!strcmp(token, "{")) {
+			    token = advancetoken(flib, '}');
+			    break;
+			}
+		    }
+		}
+		break;
+
+	}
+	token = advancetoken(flib, 0);
+    }
+
+    if (lazylib != NULL) {
+	lazylib->tables = *tablelist;
+	lazylib->time_unit = time_unit;
+	lazylib->cap_unit = cap_unit;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Read the liberty file (see libertyRead()), as the body of a	*/
+/* thread, so that it can be read while the verilog netlist is	*/
+/* being read.							*/
+/*--------------------------------------------------------------*/
+
+void *libertyReadThread(void *arg)
+{
+    libreadargs *args = (libreadargs *)arg;
+
+    fileCurrentLine = 0;
+    tokenpos = NULL;
+    if (args->lazy) libertyIndex(args->flib);
+    libertyRead(args->flib, &args->tables, &args->cells, &args->wireloads,
+		&args->wlselections);
+    args->lines = fileCurrentLine;
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Read a verilog netlist and collect information about the	*/
+/* cells instantiated and the network structure.  Each module	*/
+/* in the file is added to "modlist", in file order.		*/
+/*								*/
+/* Instances are recognized syntactically, and cell and pin	*/
+/* names are recorded but not resolved, so that the netlist	*/
+/* can be read without the liberty data (see bindCells()).	*/
+/* Until then, all pin connections are kept in in_connects.	*/
+/* Instances of other modules are resolved by			*/
+/* expand_hierarchy().						*/
+/*--------------------------------------------------------------*/
+
+void
+verilogRead(FILE *fsrc, module **modlist)
+{
+    char *token;
+    int section = MODULE;
+
+    moduleptr newmod, *modlast;
+    net **netlist;
+    instance **instlist;
+    connect **inputlist, **outputlist;
+
+    instptr newinst;
+    netptr newnet, testnet;
+    connptr newconn, testconn;
+
+    int vstart, vend, vtarget, isinput;
+
+    /* Read tokens off of the line */
+    token = advancetoken(fsrc, 0);
+
+    while (token != NULL) {
+
+	switch (section) {
+	    case MODULE:
+		if (!strcasecmp(token, "module")) {
+		    token = advancetoken(fsrc, 0);
+		    fprintf(stderr, "Parsing module \"%s\"\n", token);
+
+		    newmod = (moduleptr)calloc(1, sizeof(module));
+		    newmod->name = strdup(token);
+		    newmod->state = MOD_NEW;
+		    for (modlast = modlist; *modlast; modlast = &(*modlast)->next);
+		    *modlast = newmod;
+		    netlist = &newmod->netlist;
+		    instlist = &newmod->instlist;
+		    inputlist = &newmod->inputlist;
+		    outputlist = &newmod->outputlist;
+
+		    token = advancetoken(fsrc, 0);
+		    if (strcmp(token, "("))
+			fprintf(stderr, "Module not followed by pin list\n");
+		    else
+			token = advancetoken(fsrc, ')');
+		    token = advancetoken(fsrc, ';');	// Get end-of-line
+
+		    // Ignore the pin list, go straight to the input/output declarations
+		    section = IOLIST;
+		}
+		break;
+
+	    case IOLIST:
+		if (!strcasecmp(token, "input") || !strcasecmp(token, "output")) {
+
+		    testconn = NULL;
+		    vstart = vend = 0;
+
+		    if (!strcasecmp(token, "input")) {
+			isinput = 1;
+		    }
+		    else { 	// output
+			isinput = 0;
+		    }
+
+		    token = advancetoken(fsrc, 0);
+		    if (*token == '[') {
+			sscanf(token + 1, "%d", &vstart);
+			token = advancetoken(fsrc, ':');
+			token = advancetoken(fsrc, ']');	// Read to end of vector
+			sscanf(token, "%d", &vend);
+			token = advancetoken(fsrc, 0);		// Read signal name
+		    }
+
+		    // Create a net entry for the input or output, add to the list of nets
+
+		    if (vstart == 0 && vend == 0) {
+			newnet = create_net(netlist);
+			newnet->name = strdup(token);
+
+			testconn = (connptr)malloc(sizeof(connect));
+			testconn->refnet = newnet;
+			testconn->refpin = NULL;	// No associated pin
+			testconn->refinst = NULL;	// No associated instance
+			testconn->tag = NULL;
+			testconn->wiredelay = 0.0;
+			testconn->metric = -1.0;
+			testconn->prvector = NULL;
+			testconn->pfvector = NULL;
+			testconn->prminvector = NULL;
+			testconn->pfminvector = NULL;
+			testconn->trvector = NULL;
+			testconn->tfvector = NULL;
+			testconn->trminvector = NULL;
+			testconn->tfminvector = NULL;
+			testconn->pinname = NULL;
+			testconn->flags = 0;
+
+			if (isinput) {			// driver (input)
+			    testconn->next = *inputlist;
+			    *inputlist = testconn;
+			}
+			else {				// receiver (output)
+			    testconn->next = *outputlist;
+			    *outputlist = testconn;
+			}
+		    }
+		    else {
+			vtarget = vend + (vstart < vend) ? 1 : -1;
+			while (vstart != vtarget) {
+			    newnet = create_net(netlist);
+			    newnet->name = (char *)malloc(strlen(token) + 6);
+			    sprintf(newnet->name, "%s[%d]", token, vstart);
+
+			    vstart += (vtarget > vend) ? 1 : -1;
+
+			    testconn = (connptr)malloc(sizeof(connect));
+			    testconn->refnet = newnet;
+			    testconn->refpin = NULL;	// No associated pin
+			    testconn->refinst = NULL;	// No associated instance
+			    testconn->tag = NULL;
+			    testconn->wiredelay = 0.0;
+			    testconn->metric = -1.0;
+			    testconn->prvector = NULL;
+			    testconn->pfvector = NULL;
+			    testconn->prminvector = NULL;
+			    testconn->pfminvector = NULL;
+			    testconn->trvector = NULL;
+			    testconn->tfvector = NULL;
+			    testconn->trminvector = NULL;
+			    testconn->tfminvector = NULL;
+			    testconn->pinname = NULL;
+			    testconn->flags = 0;
+
+			    if (isinput) {		// driver (input)
+				testconn->next = *inputlist;
+				*inputlist = testconn;
+			    }
+			    else {			// receiver (output)
+				testconn->next = *outputlist;
+				*outputlist = testconn;
+			    }
+			}
+		    }
+		    token = advancetoken(fsrc, ';');	// Get rest of input/output entry
+		    break;
+		}
+
+		/* Drop through on anything that isn't an input, output, or blank line */
+
+	    case GATELIST:
+
+		if (!strcasecmp(token, "endmodule")) {
+		    section = MODULE;
+		    break;    
+		}
+
+		/* Ignore all wire and assign statements	*/
+		/* Qflow does not generate these, but other	*/
+		/* synthesis tools may.				*/
+
+		if (!strcasecmp(token, "assign")) {
+		    if (verbose > 0)
+			fprintf(stdout, "Wire assignments are not handled!\n");
+		    token = advancetoken(fsrc, ';');	// Get rest of entry, and ignore
+		}
+		else if (!strcasecmp(token, "wire") || !strcasecmp(token, "reg") ||
+			!strcasecmp(token, "tri") || !strcasecmp(token, "inout") ||
+			!strcasecmp(token, "supply0") || !strcasecmp(token, "supply1") ||
+			!strcasecmp(token, "parameter") || !strcasecmp(token, "defparam") ||
+			!strcasecmp(token, "localparam") || (*token == '`')) {
+		    token = advancetoken(fsrc, ';');	// Get rest of entry, and ignore
+		}
+		else {
+		    /* Anything else is taken to be a cell instance.	*/
+		    /* The cell is looked up later by bindCells().	*/
+
+		    section = INSTANCE;
+		    newinst = (instptr)malloc(sizeof(instance));
+		    newinst->next = *instlist;
+		    *instlist = newinst;
+		    newinst->refcell = NULL;
+		    newinst->cellname = strdup(token);
+		    newinst->in_connects = NULL;
+		    newinst->out_connects = NULL;
+		    newinst->flags = 0;
+		    newinst->index = 0;
+		    newinst->depth = 0;
+		    newinst->borrow = 0.0;
+		    newinst->opentime = 0.0;
+		    newinst->dtrans = 0.0;
+		}
+		break;
+
+	    case INSTANCE:
+		newinst->name = strdup(token);
+		token = advancetoken(fsrc, '(');	// Find beginning of pin list
+		section = INSTPIN;
+		break;
+
+	    case INSTPIN:
+		if (*token == '.') {
+		    newconn = (connptr)malloc(sizeof(connect));
+		    // Pin name is in (token + 1)
+		    newconn->next = newinst->in_connects;
+		    newinst->in_connects = newconn;
+		    newconn->refinst = newinst;
+		    newconn->refpin = NULL;
+		    newconn->refnet = NULL;
+		    newconn->tag = NULL;
+		    newconn->wiredelay = 0.0;
+		    newconn->metric = -1.0;
+		    newconn->prvector = NULL;
+		    newconn->pfvector = NULL;
+		    newconn->prminvector = NULL;
+		    newconn->pfminvector = NULL;
+		    newconn->trvector = NULL;
+		    newconn->tfvector = NULL;
+		    newconn->trminvector = NULL;
+		    newconn->tfminvector = NULL;
+		    newconn->pinname = strdup(token + 1);
+		    newconn->flags = 0;
+		    token = advancetoken(fsrc, '(');	// Read to beginning of pin name
+		    section = PINCONN;
+		}
+		else if (*token == ';') {
+		    // End of instance record
+		    section = GATELIST;
+		}
+		else if (*token != ',' && *token != ')') {
+		    fprintf(stderr, "Unexpected entry in instance pin connection list!\n");
+		    token = advancetoken(fsrc, ';');	// Read to end-of-line
+		    section = GATELIST;
+		}
+		break;
+
+	    case PINCONN:
+		// Token is net name
+		for (testnet = *netlist; testnet; testnet = testnet->next) {
+		    if (!strcmp(testnet->name, token))
+			break;
+		}
+		if (testnet == NULL) {
+		    // This is a new net, and we need to record it
+		    newnet = create_net(netlist);
+		    newnet->name = strdup(token);
+		    newconn->refnet = newnet;
+		}
+		else
+		    newconn->refnet = testnet;
+		section = INSTPIN;
+		break;
+	}
+	if (section == PINCONN)
+	    token = advancetoken(fsrc, ')');	// Name token parsing
+	else
+	    token = advancetoken(fsrc, 0);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Hash a name, ignoring case (cell names are matched without	*/
+/* regard to case).						*/
+/*--------------------------------------------------------------*/
+
+unsigned int hash_name(char *name)
+{
+    unsigned int h = 2166136261u;
+
+    while (*name != '\0') {
+	h ^= (unsigned char)tolower(*name++);
+	h *= 16777619u;
+    }
+    return h;
+}
+
+/*--------------------------------------------------------------*/
+/* Bind the cell and pin names recorded by verilogRead() to the	*/
+/* liberty data, in one pass over the instances using a hash	*/
+/* table of cells.  Cells skipped in lazy mode are parsed on	*/
+/* first use.  Output pin connections are moved from		*/
+/* in_connects to out_connects.  Instances of unknown cells	*/
+/* are removed, as are connections to unknown pins.		*/
+/*								*/
+/* Return the number of instances bound.			*/
+/*--------------------------------------------------------------*/
+
+int bindCells(cellptr cells, instptr *instlist)
+{
+    cellptr *table, testcell;
+    instptr testinst, *instptrptr;
+    connptr testconn, nextconn, *inlast, *outlast;
+    pinptr  testpin;
+    unsigned int mask, h;
+    int numcells, numbound;
+
+    numcells = 0;
+    for (testcell = cells; testcell; testcell = testcell->next) numcells++;
+    for (mask = 1; mask < (unsigned int)(2 * numcells); mask <<= 1);
+    table = (cellptr *)calloc(mask, sizeof(cellptr));
+    mask--;
+
+    // Build:  The first cell of a given name is used, as when
+    // searching the cell list.
+
+    for (testcell = cells; testcell; testcell = testcell->next) {
+	for (h = hash_name(testcell->name) & mask; table[h]; h = (h + 1) & mask)
+	    if (!strcasecmp(table[h]->name, testcell->name))
+		break;
+	if (table[h] == NULL) table[h] = testcell;
+    }
+
+    // Probe
+
+    numbound = 0;
+    instptrptr = instlist;
+    while ((testinst = *instptrptr) != NULL) {
+	for (h = hash_name(testinst->cellname) & mask; table[h]; h = (h + 1) & mask)
+	    if (!strcasecmp(table[h]->name, testinst->cellname))
+		break;
+	testcell = table[h];
+
+	if (testcell == NULL) {
+	    if (verbose > 0)
+		fprintf(stdout, "Unknown cell \"%s\" instanced.\n",
+			testinst->cellname);
+	    *instptrptr = testinst->next;
+	    for (testconn = testinst->in_connects; testconn; testconn = nextconn) {
+		nextconn = testconn->next;
+		free(testconn->pinname);
+		free(testconn);
+	    }
+	    free(testinst->cellname);
+	    free(testinst->name);
+	    free(testinst);
+	    continue;
+	}
+	if (testcell->libindex >= 0) liberty_load_cell(testcell);
+	testinst->refcell = testcell;
+	free(testinst->cellname);
+	testinst->cellname = NULL;
+
+	// Resolve pins, keeping the order of connections in each list
+
+	testconn = testinst->in_connects;
+	testinst->in_connects = NULL;
+	testinst->out_connects = NULL;
+	inlast = &testinst->in_connects;
+	outlast = &testinst->out_connects;
+	for (; testconn; testconn = nextconn) {
+	    nextconn = testconn->next;
+	    testconn->next = NULL;
+	    for (testpin = testcell->pins; testpin; testpin = testpin->next)
+		if (!strcmp(testpin->name, testconn->pinname))
+		    break;
+
+	    // Sanity check
+	    if (testpin == NULL) {
+		fprintf(stderr, "No such pin \"%s\" in cell \"%s\"!\n",
+			testconn->pinname, testcell->name);
+		free(testconn->pinname);
+		free(testconn);
+		continue;
+	    }
+	    free(testconn->pinname);
+	    testconn->pinname = NULL;
+	    testconn->refpin = testpin;
+	    if (testpin->type & OUTPUT) {
+		*outlast = testconn;
+		outlast = &testconn->next;
+	    }
+	    else {
+		*inlast = testconn;
+		inlast = &testconn->next;
+	    }
+	}
+	numbound++;
+	instptrptr = &testinst->next;
+    }
+    free(table);
+    return numbound;
+}
+
+/*--------------------------------------------------------------*/
+/* Make an open-addressing hash table of the nets of "netlist"	*/
+/* by name, for the parasitics readers.  The table size minus	*/
+/* one is returned in "maskp".					*/
+/*--------------------------------------------------------------*/
+
+netptr *hash_nets(netptr netlist, unsigned int *maskp)
+{
+    netptr testnet, *nets;
+    unsigned int mask, h;
+    int numnets;
+
+    numnets = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) numnets++;
+    for (mask = 1; mask < (unsigned int)(2 * numnets); mask <<= 1);
+    nets = (netptr *)calloc(mask, sizeof(netptr));
+    mask--;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (testnet->name == NULL) continue;
+	for (h = hash_name(testnet->name) & mask; nets[h]; h = (h + 1) & mask);
+	nets[h] = testnet;
+    }
+    *maskp = mask;
+    return nets;
+}
+
+/*--------------------------------------------------------------*/
+/* Find net "name" in the table made by hash_nets(), or return	*/
+/* NULL.							*/
+/*--------------------------------------------------------------*/
+
+netptr find_hashed_net(netptr *nets, unsigned int mask, char *name)
+{
+    unsigned int h;
+
+    for (h = hash_name(name) & mask; nets[h]; h = (h + 1) & mask)
+	if (!strcmp(nets[h]->name, name))
+	    return nets[h];
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Remove the backslashes that escape characters in a SPEF	*/
+/* name, in place.						*/
+/*--------------------------------------------------------------*/
+
+void spef_unescape(char *name)
+{
+    char *sptr, *dptr;
+
+    for (sptr = dptr = name; *sptr != '\0'; sptr++) {
+	if ((*sptr == '\\') && (*(sptr + 1) != '\0')) sptr++;
+	*dptr++ = *sptr;
+    }
+    *dptr = '\0';
+}
+
+/*--------------------------------------------------------------*/
+/* Return the slot of *NAME_MAP index "index" in the name map	*/
+/* of reader "sr", or the empty slot where it would go.		*/
+/*--------------------------------------------------------------*/
+
+unsigned int spef_map_slot(spefreader *sr, int index)
+{
+    unsigned int h;
+
+    for (h = ((unsigned int)index * 2654435761u) & sr->mapmask;
+		(sr->map[h].index >= 0) && (sr->map[h].index != index);
+		h = (h + 1) & sr->mapmask);
+    return h;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the net and the instance named "name" in the design.	*/
+/* A name "*<n>" is an index into the *NAME_MAP.  Either	*/
+/* result may be NULL.  "name" is unescaped in place.		*/
+/*--------------------------------------------------------------*/
+
+void spef_lookup(spefreader *sr, char *name, netptr *netp, instptr *instp)
+{
+    unsigned int h;
+
+    *netp = NULL;
+    *instp = NULL;
+
+    if ((*name == '*') && isdigit(*(name + 1))) {
+	h = spef_map_slot(sr, atoi(name + 1));
+	if (sr->map[h].index >= 0) {
+	    *netp = sr->map[h].net;
+	    *instp = sr->map[h].inst;
+	}
+	return;
+    }
+
+    spef_unescape(name);
+    *netp = find_hashed_net(sr->nets, sr->netmask, name);
+    h = hash_name(name);
+    for (h &= sr->instmask; sr->insts[h]; h = (h + 1) & sr->instmask)
+	if (!strcmp(sr->insts[h]->name, name)) {
+	    *instp = sr->insts[h];
+	    break;
+	}
+}
+
+/*--------------------------------------------------------------*/
+/* Add *NAME_MAP entry "index" for "name".  Only names of nets	*/
+/* and instances in the design are kept, and they are kept as	*/
+/* pointers, not strings.					*/
+/*--------------------------------------------------------------*/
+
+void spef_map_add(spefreader *sr, int index, char *name)
+{
+    spefmap *oldmap;
+    netptr testnet;
+    instptr testinst;
+    unsigned int h, oldmask;
+
+    spef_lookup(sr, name, &testnet, &testinst);
+    if ((testnet == NULL) && (testinst == NULL)) return;
+
+    // Keep the table no more than half full
+
+    if (2 * (sr->mapsize + 1) > sr->mapmask) {
+	oldmap = sr->map;
+	oldmask = sr->mapmask;
+	sr->mapmask = 2 * (oldmask + 1) - 1;
+	sr->map = (spefmap *)malloc((sr->mapmask + 1) * sizeof(spefmap));
+	for (h = 0; h <= sr->mapmask; h++) sr->map[h].index = -1;
+	for (h = 0; h <= oldmask; h++)
+	    if (oldmap[h].index >= 0)
+		sr->map[spef_map_slot(sr, oldmap[h].index)] = oldmap[h];
+	free(oldmap);
+    }
+
+    h = spef_map_slot(sr, index);
+    if (sr->map[h].index < 0) sr->mapsize++;
+    sr->map[h].index = index;
+    sr->map[h].net = testnet;
+    sr->map[h].inst = testinst;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the node named "name" of the current net, adding it	*/
+/* if it is new.						*/
+/*--------------------------------------------------------------*/
+
+int spef_node(spefreader *sr, char *name)
+{
+    spefnode *node;
+    unsigned int h;
+    int n, len;
+
+    for (h = hash_name(name) & sr->nodemask; sr->nodehash[h] >= 0;
+		h = (h + 1) & sr->nodemask)
+	if (!strcmp(sr->names + sr->nodes[sr->nodehash[h]].name, name))
+	    return sr->nodehash[h];
+
+    if (sr->numnodes == sr->maxnodes) {
+	sr->maxnodes <<= 1;
+	sr->nodes = (spefnode *)realloc(sr->nodes, sr->maxnodes * sizeof(spefnode));
+	sr->order = (int *)realloc(sr->order, sr->maxnodes * sizeof(int));
+    }
+    len = strlen(name) + 1;
+    while (sr->namelen + len > sr->maxnames) {
+	sr->maxnames <<= 1;
+	sr->names = (char *)realloc(sr->names, sr->maxnames);
+    }
+
+    n = sr->numnodes++;
+    node = sr->nodes + n;
+    node->name = sr->namelen;
+    strcpy(sr->names + sr->namelen, name);
+    sr->namelen += len;
+    node->conn = NULL;
+    node->cap = 0.0;
+    node->res = 0.0;
+    node->parent = -1;
+    node->edges = -1;
+    node->slot = h;
+    sr->nodehash[h] = n;
+
+    // Keep the table no more than half full
+
+    if (2 * sr->numnodes > sr->nodemask) {
+	free(sr->nodehash);
+	sr->nodemask = 2 * (sr->nodemask + 1) - 1;
+	sr->nodehash = (int *)malloc((sr->nodemask + 1) * sizeof(int));
+	for (h = 0; h <= sr->nodemask; h++) sr->nodehash[h] = -1;
+	for (n = 0; n < sr->numnodes; n++) {
+	    node = sr->nodes + n;
+	    for (h = hash_name(sr->names + node->name) & sr->nodemask;
+			sr->nodehash[h] >= 0; h = (h + 1) & sr->nodemask);
+	    node->slot = h;
+	    sr->nodehash[h] = n;
+	}
+	n = sr->numnodes - 1;
+    }
+    return n;
+}
+
+/*--------------------------------------------------------------*/
+/* Add a resistor of "value" ohms between nodes "n1" and "n2"	*/
+/* of the current net.						*/
+/*--------------------------------------------------------------*/
+
+void spef_add_res(spefreader *sr, int n1, int n2, double value)
+{
+    spefres *res;
+
+    if (sr->numres == sr->maxres) {
+	sr->maxres <<= 1;
+	sr->res = (spefres *)realloc(sr->res, sr->maxres * sizeof(spefres));
+    }
+    res = sr->res + sr->numres;
+    res->node[0] = n1;
+    res->node[1] = n2;
+    res->res = value;
+    res->next[0] = sr->nodes[n1].edges;
+    sr->nodes[n1].edges = sr->numres;
+    res->next[1] = sr->nodes[n2].edges;
+    sr->nodes[n2].edges = sr->numres;
+    sr->numres++;
+}
+
+/*--------------------------------------------------------------*/
+/* Record the *CONN entry "name" of the current net.  "isport"	*/
+/* is set for a *P (port) entry, and "dir" is the direction	*/
+/* letter (I, O, or B).  An entry that drives the net becomes	*/
+/* the driver node;  a receiver is attached to its node so that	*/
+/* its wire delay can be set when the net is reduced.		*/
+/*--------------------------------------------------------------*/
+
+void spef_conn(spefreader *sr, char *name, char dir, int isport)
+{
+    netptr testnet;
+    instptr testinst;
+    connptr testconn;
+    char *pinname;
+    int n, i;
+
+    n = spef_node(sr, name);
+    testconn = NULL;
+
+    if (isport) {
+	// An input port drives the net;  an output port is a
+	// receiver with no pin.
+	if (dir == 'I') {
+	    sr->driver = n;
+	    return;
+	}
+	for (i = 0; i < sr->curnet->fanout; i++)
+	    if (sr->curnet->receivers[i]->refpin == NULL) {
+		testconn = sr->curnet->receivers[i];
+		break;
+	    }
+    }
+    else {
+	if (dir == 'O') {
+	    sr->driver = n;
+	    return;
+	}
+	pinname = strrchr(name, sr->delim);
+	if (pinname == NULL) return;
+	*pinname++ = '\0';
+	spef_lookup(sr, name, &testnet, &testinst);
+	if (testinst == NULL) return;
+	spef_unescape(pinname);
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	    if (!strcmp(testconn->refpin->name, pinname))
+		break;
+	if ((testconn != NULL) && (testconn->refnet != sr->curnet))
+	    testconn = NULL;
+    }
+    if (testconn != NULL) sr->nodes[n].conn = testconn;
+}
+
+/*--------------------------------------------------------------*/
+/* Start reading *D_NET "name" with total capacitance "totcap"	*/
+/* (in file units).  The previous net's nodes are removed from	*/
+/* the node table one by one, so the cost of each net is in	*/
+/* proportion to its own size.					*/
+/*--------------------------------------------------------------*/
+
+void spef_begin_net(spefreader *sr, char *name, double totcap)
+{
+    instptr testinst;
+    int n;
+
+    for (n = 0; n < sr->numnodes; n++)
+	sr->nodehash[sr->nodes[n].slot] = -1;
+    sr->numnodes = 0;
+    sr->numres = 0;
+    sr->namelen = 0;
+    sr->driver = -1;
+    sr->totcap = totcap * sr->cunit;
+    spef_lookup(sr, name, &sr->curnet, &testinst);
+}
+
+/*--------------------------------------------------------------*/
+/* Reduce the RC network of the current net:  Set the net's	*/
+/* wire capacitance, and the Elmore delay from the driver to	*/
+/* each receiver.  A network that is not a tree is reduced	*/
+/* over the spanning tree found by a breadth-first search from	*/
+/* the driver.  Return the number of receivers annotated.	*/
+/*--------------------------------------------------------------*/
+
+int spef_reduce_net(spefreader *sr, double out_load)
+{
+    spefnode *node, *other;
+    spefres *res;
+    pinptr testpin;
+    double wirecap;
+    int i, e, n, m, head, tail, count;
+
+    wirecap = 0.0;
+    for (n = 0; n < sr->numnodes; n++)
+	wirecap += sr->nodes[n].cap;
+    sr->curnet->wirecap = (sr->totcap > 0.0) ? sr->totcap : wirecap;
+
+    if (sr->driver < 0) return 0;
+
+    // Add the receiver pin loads to the network
+
+    for (n = 0; n < sr->numnodes; n++) {
+	node = sr->nodes + n;
+	node->delay = -1.0;
+	if (node->conn == NULL) continue;
+	testpin = node->conn->refpin;
+	if (testpin == NULL)
+	    node->cap += out_load;
+	else
+	    node->cap += (testpin->capr > testpin->capf) ? testpin->capr : testpin->capf;
+    }
+
+    // Breadth-first search from the driver.  "delay" is negative
+    // until the node is reached.
+
+    sr->order[0] = sr->driver;
+    sr->nodes[sr->driver].delay = 0.0;
+    head = 0;
+    tail = 1;
+    while (head < tail) {
+	n = sr->order[head++];
+	for (e = sr->nodes[n].edges; e >= 0; e = res->next[i]) {
+	    res = sr->res + e;
+	    i = (res->node[0] == n) ? 0 : 1;
+	    m = res->node[1 - i];
+	    other = sr->nodes + m;
+	    if (other->delay >= 0.0) continue;
+	    other->delay = 0.0;
+	    other->parent = n;
+	    other->res = res->res * sr->runit;
+	    sr->order[tail++] = m;
+	}
+    }
+
+    // Capacitance downstream of each node, from the leaves up
+
+    for (i = 0; i < tail; i++) {
+	node = sr->nodes + sr->order[i];
+	node->csub = node->cap;
+    }
+    for (i = tail - 1; i > 0; i--) {
+	node = sr->nodes + sr->order[i];
+	sr->nodes[node->parent].csub += node->csub;
+    }
+
+    // Elmore delay, from the driver down.  Ohms times fF is
+    // 1E-3 ps.
+
+    count = 0;
+    for (i = 1; i < tail; i++) {
+	node = sr->nodes + sr->order[i];
+	node->delay = sr->nodes[node->parent].delay + node->res * node->csub;
+	if (node->conn != NULL) {
+	    node->conn->wiredelay = node->delay * 1E-3;
+	    count++;
+	}
+    }
+    return count;
+}
+
+/*--------------------------------------------------------------*/
+/* Read the SPEF parasitics file "fname", and annotate each net	*/
+/* that has a *D_NET with its wire capacitance and the Elmore	*/
+/* delay to each receiver.  These replace the wire load model	*/
+/* estimate for the net in computeLoads().  Must be called	*/
+/* after bindCells() and before computeLoads().			*/
+/*								*/
+/* The file is read as a stream:  Only the *NAME_MAP entries	*/
+/* that name nets or instances of the design are kept, and	*/
+/* each net's RC network is kept only until its *END.  Coupling	*/
+/* capacitors are counted as capacitance to ground, and *R_NET	*/
+/* (reduced) nets are skipped.					*/
+/*								*/
+/* Return the number of errors found.				*/
+/*--------------------------------------------------------------*/
+
+int readSPEF(char *fname, netptr netlist, instptr instlist, double out_load)
+{
+    FILE *fspef;
+    spefreader sr;
+    instptr testinst;
+    char line[LIB_LINE_MAX], *token, *ptr, *t1, *t2, *t3;
+    double mult;
+    unsigned int h;
+    int n, section, numnets, numrcvrs, unknown;
+
+    fspef = fopen(fname, "r");
+    if (fspef == NULL) {
+	fprintf(stderr, "Cannot open %s for reading\n", fname);
+	return 1;
+    }
+
+    // Hash tables of the design's nets and instances by name
+
+    sr.nets = hash_nets(netlist, &sr.netmask);
+
+    numnets = 0;
+    for (testinst = instlist; testinst; testinst = testinst->next) numnets++;
+    for (sr.instmask = 1; sr.instmask < (unsigned int)(2 * numnets); sr.instmask <<= 1);
+    sr.insts = (instptr *)calloc(sr.instmask, sizeof(instptr));
+    sr.instmask--;
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	if (testinst->name == NULL) continue;
+	for (h = hash_name(testinst->name) & sr.instmask; sr.insts[h];
+		h = (h + 1) & sr.instmask);
+	sr.insts[h] = testinst;
+    }
+
+    sr.mapmask = 255;
+    sr.mapsize = 0;
+    sr.map = (spefmap *)malloc((sr.mapmask + 1) * sizeof(spefmap));
+    for (h = 0; h <= sr.mapmask; h++) sr.map[h].index = -1;
+
+    sr.maxnodes = sr.maxres = 64;
+    sr.maxnames = 1024;
+    sr.nodes = (spefnode *)malloc(sr.maxnodes * sizeof(spefnode));
+    sr.order = (int *)malloc(sr.maxnodes * sizeof(int));
+    sr.res = (spefres *)malloc(sr.maxres * sizeof(spefres));
+    sr.names = (char *)malloc(sr.maxnames);
+    sr.nodemask = 255;
+    sr.nodehash = (int *)malloc((sr.nodemask + 1) * sizeof(int));
+    for (h = 0; h <= sr.nodemask; h++) sr.nodehash[h] = -1;
+    sr.numnodes = sr.numres = sr.namelen = 0;
+    sr.curnet = NULL;
+    sr.driver = -1;
+    sr.totcap = 0.0;
+    sr.cunit = 1000.0;		// SPEF default units are pF and ohms
+    sr.runit = 1.0;
+    sr.delim = ':';
+
+    section = SPEF_NONE;
+    numnets = numrcvrs = unknown = 0;
+
+    while (fgets(line, LIB_LINE_MAX, fspef) != NULL) {
+	if ((ptr = strstr(line, "//")) != NULL) *ptr = '\0';
+	token = strtok(line, " \t\r\n");
+	if (token == NULL) continue;
+
+	if ((*token == '*') && !isdigit(*(token + 1))) {
+	    if (!strcmp(token, "*NAME_MAP"))
+		section = SPEF_NAMEMAP;
+	    else if (!strcmp(token, "*C_UNIT") || !strcmp(token, "*R_UNIT")) {
+		t1 = strtok(NULL, " \t\r\n");
+		t2 = strtok(NULL, " \t\r\n");
+		if ((t1 == NULL) || (t2 == NULL)) continue;
+		mult = strtod(t1, NULL);
+		if (!strcasecmp(t2, "PF") || !strcasecmp(t2, "KOHM"))
+		    mult *= 1000.0;
+		else if (!strcasecmp(t2, "NF") || !strcasecmp(t2, "MOHM"))
+		    mult *= 1E6;
+		else if (!strcasecmp(t2, "UF"))
+		    mult *= 1E9;
+		if (*(token + 1) == 'C')
+		    sr.cunit = mult;
+		else
+		    sr.runit = mult;
+	    }
+	    else if (!strcmp(token, "*DELIMITER")) {
+		t1 = strtok(NULL, " \t\r\n");
+		if (t1 != NULL) sr.delim = *t1;
+	    }
+	    else if (!strcmp(token, "*D_NET")) {
+		t1 = strtok(NULL, " \t\r\n");
+		t2 = strtok(NULL, " \t\r\n");
+		if (t1 == NULL) continue;
+		spef_begin_net(&sr, t1, (t2) ? strtod(t2, NULL) : 0.0);
+		if (sr.curnet == NULL) unknown++;
+		section = SPEF_NONE;
+	    }
+	    else if (!strcmp(token, "*CONN"))
+		section = SPEF_CONN;
+	    else if (!strcmp(token, "*CAP"))
+		section = SPEF_CAP;
+	    else if (!strcmp(token, "*RES"))
+		section = SPEF_RES;
+	    else if (!strcmp(token, "*END")) {
+		if (sr.curnet != NULL) {
+		    numrcvrs += spef_reduce_net(&sr, out_load);
+		    numnets++;
+		}
+		sr.curnet = NULL;
+		section = SPEF_NONE;
+	    }
+	    else if ((section == SPEF_CONN) && (!strcmp(token, "*P") ||
+			!strcmp(token, "*I"))) {
+		t1 = strtok(NULL, " \t\r\n");
+		t2 = strtok(NULL, " \t\r\n");
+		if ((sr.curnet != NULL) && (t1 != NULL) && (t2 != NULL))
+		    spef_conn(&sr, t1, toupper(*t2), (*(token + 1) == 'P'));
+	    }
+	    else {
+		// Any other keyword ends the section.  Nets that are
+		// not *D_NET (e.g., *R_NET) are not read.
+		if (!strncmp(token, "*R_", 3) || !strncmp(token, "*D_", 3))
+		    sr.curnet = NULL;
+		section = SPEF_NONE;
+	    }
+	    continue;
+	}
+
+	switch (section) {
+	    case SPEF_NAMEMAP:
+		t1 = strtok(NULL, " \t\r\n");
+		if ((*token == '*') && (t1 != NULL))
+		    spef_map_add(&sr, atoi(token + 1), t1);
+		break;
+
+	    case SPEF_CAP:
+		// "<id> <node> <cap>" or coupling "<id> <node> <node> <cap>"
+		if (sr.curnet == NULL) break;
+		t1 = strtok(NULL, " \t\r\n");
+		t2 = strtok(NULL, " \t\r\n");
+		t3 = strtok(NULL, " \t\r\n");
+		if ((t1 == NULL) || (t2 == NULL)) break;
+		n = spef_node(&sr, t1);
+		sr.nodes[n].cap += sr.cunit * strtod((t3) ? t3 : t2, NULL);
+		break;
+
+	    case SPEF_RES:
+		if (sr.curnet == NULL) break;
+		t1 = strtok(NULL, " \t\r\n");
+		t2 = strtok(NULL, " \t\r\n");
+		t3 = strtok(NULL, " \t\r\n");
+		if ((t1 == NULL) || (t2 == NULL) || (t3 == NULL)) break;
+		spef_add_res(&sr, spef_node(&sr, t1), spef_node(&sr, t2),
+			strtod(t3, NULL));
+		break;
+	}
+    }
+    fclose(fspef);
+
+    fprintf(stdout, "SPEF:  %d net%s and %d receiver%s annotated", numnets,
+		(numnets == 1) ? "" : "s", numrcvrs, (numrcvrs == 1) ? "" : "s");
+    if (unknown > 0)
+	fprintf(stdout, ", %d unknown net%s skipped", unknown,
+		(unknown == 1) ? "" : "s");
+    fprintf(stdout, ".\n");
+
+    free(sr.nets);
+    free(sr.insts);
+    free(sr.map);
+    free(sr.nodes);
+    free(sr.order);
+    free(sr.res);
+    free(sr.names);
+    free(sr.nodehash);
+    return 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Read the pi model file "fname".  Each line gives the reduced	*/
+/* wire parasitics of one net, and "#" begins a comment:	*/
+/*								*/
+/*	<net> <c_near> <r> <c_far>				*/
+/*								*/
+/* with capacitances in fF and resistance in ohms.  The pi	*/
+/* model is the wire only;  receiver pins are taken to be at	*/
+/* the far end.  A net whose model changes has its effective	*/
+/* capacitance marked for recalculation by compute_ceff().	*/
+/*								*/
+/* Return the number of errors found.				*/
+/*--------------------------------------------------------------*/
+
+int readPiModels(char *fname, netptr netlist)
+{
+    FILE *fpi;
+    char line[LIB_LINE_MAX], *token, *ptr;
+    netptr testnet, *nets;
+    double value[3];
+    unsigned int mask;
+    int i, numnets, linenum, errors;
+
+    fpi = fopen(fname, "r");
+    if (fpi == NULL) {
+	fprintf(stderr, "Cannot open %s for reading\n", fname);
+	return 1;
+    }
+
+    nets = hash_nets(netlist, &mask);
+
+    errors = numnets = linenum = 0;
+    while (fgets(line, LIB_LINE_MAX, fpi) != NULL) {
+	linenum++;
+	if ((ptr = strchr(line, '#')) != NULL) *ptr = '\0';
+	token = strtok(line, " \t\r\n");
+	if (token == NULL) continue;
+
+	testnet = find_hashed_net(nets, mask, token);
+	if (testnet == NULL) {
+	    fprintf(stderr, "%s line %d:  Unknown net \"%s\".\n", fname,
+			linenum, token);
+	    errors++;
+	    continue;
+	}
+	for (i = 0; i < 3; i++) {
+	    ptr = strtok(NULL, " \t\r\n");
+	    if (ptr == NULL) break;
+	    value[i] = strtod(ptr, NULL);
+	    if (value[i] < 0.0) break;
+	}
+	if (i < 3) {
+	    fprintf(stderr, "%s line %d:  Bad pi model for net \"%s\".\n",
+			fname, linenum, token);
+	    errors++;
+	    continue;
+	}
+	if ((testnet->cnear != value[0]) || (testnet->rpi != value[1]) ||
+			(testnet->cfar != value[2]))
+	    testnet->flags &= ~NET_CEFF;
+	testnet->cnear = value[0];
+	testnet->rpi = value[1];
+	testnet->cfar = value[2];
+	numnets++;
+    }
+    fclose(fpi);
+    free(nets);
+
+    fprintf(stdout, "Pi models:  %d net%s.\n", numnets, (numnets == 1) ? "" : "s");
+    return errors;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the receiver of net "testnet" named "term" in a wiring	*/
+/* delay file:  "<instance>/<pin>" for a gate input, or the	*/
+/* pin name, optionally as "PIN/<name>", for a module output.	*/
+/*--------------------------------------------------------------*/
+
+connptr find_receiver(netptr testnet, char *term)
+{
+    connptr testconn;
+    char *pinname;
+    int i, len;
+
+    pinname = strrchr(term, '/');
+    len = (pinname == NULL) ? 0 : pinname - term;
+    for (i = 0; i < testnet->fanout; i++) {
+	testconn = testnet->receivers[i];
+	if (testconn->refpin == NULL) {
+	    if ((pinname == NULL) || !strncmp(term, "PIN/", 4))
+		return testconn;
+	}
+	else if ((pinname != NULL) && (testconn->refinst != NULL) &&
+		!strncmp(testconn->refinst->name, term, len) &&
+		(testconn->refinst->name[len] == '\0') &&
+		!strcmp(testconn->refpin->name, pinname + 1))
+	    return testconn;
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Read the wiring delay file "fname" (see the format at the	*/
+/* top of this file), and annotate each net listed with its	*/
+/* wire capacitance and each receiver with its wire delay.	*/
+/* These replace the wire load model estimate for the net in	*/
+/* computeLoads().  A net with no capacitance given is taken	*/
+/* to have none beyond its pins.  Nets may be separated by	*/
+/* blank lines.							*/
+/*								*/
+/* Return the number of errors found.				*/
+/*--------------------------------------------------------------*/
+
+int readDelays(char *fname, netptr netlist)
+{
+    FILE *fdelay;
+    char line[LIB_LINE_MAX], *token, *ptr;
+    netptr testnet, *nets;
+    connptr testconn;
+    unsigned int mask;
+    int linenum, errors, numnets, state;
+
+    fdelay = fopen(fname, "r");
+    if (fdelay == NULL) {
+	fprintf(stderr, "Cannot open %s for reading\n", fname);
+	return 1;
+    }
+    nets = hash_nets(netlist, &mask);
+
+    // "state" is 0 when expecting a net name, 1 when expecting the
+    // driver, and 2 when reading receivers.
+
+    testnet = NULL;
+    errors = numnets = linenum = state = 0;
+    while (fgets(line, LIB_LINE_MAX, fdelay) != NULL) {
+	linenum++;
+	token = strtok(line, " \t\r\n");
+	if (token == NULL) {
+	    state = 0;
+	    continue;
+	}
+	ptr = strtok(NULL, " \t\r\n");
+
+	if ((state == 0) || ((state == 2) && (ptr == NULL))) {
+	    testnet = find_hashed_net(nets, mask, token);
+	    if (testnet == NULL) {
+		fprintf(stderr, "%s line %d:  Unknown net \"%s\".\n", fname,
+			linenum, token);
+		errors++;
+	    }
+	    else
+		numnets++;
+	    state = 1;
+	}
+	else if (state == 1) {
+	    if (testnet != NULL)
+		testnet->wirecap = (ptr != NULL) ? strtod(ptr, NULL) : 0.0;
+	    state = 2;
+	}
+	else if (testnet != NULL) {
+	    testconn = find_receiver(testnet, token);
+	    if (testconn == NULL) {
+		fprintf(stderr, "%s line %d:  \"%s\" is not a receiver of net "
+			"\"%s\".\n", fname, linenum, token, testnet->name);
+		errors++;
+	    }
+	    else
+		testconn->wiredelay = strtod(ptr, NULL);
+	}
+    }
+    fclose(fdelay);
+    free(nets);
+
+    fprintf(stdout, "Wire delays:  %d net%s.\n", numnets, (numnets == 1) ? "" : "s");
+    return errors;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the estimated length of a wire with the given fanout	*/
+/* according to wire load model "wlmodel".  Fanouts between	*/
+/* table entries are interpolated, and fanouts beyond the end	*/
+/* of the table are extrapolated using the model's slope.	*/
+/*--------------------------------------------------------------*/
+
+double wireload_length(wireloadptr wlmodel, int fanout)
+{
+    int j, last;
+    double ffrac;
+
+    if (fanout <= 0) return 0.0;
+    if (wlmodel->entries == 0) return wlmodel->slope * fanout;
+
+    last = wlmodel->entries - 1;
+    if (fanout >= wlmodel->fanout[last])
+	return wlmodel->length[last] + wlmodel->slope *
+			(double)(fanout - wlmodel->fanout[last]);
+
+    for (j = 0; j < last; j++)
+	if (wlmodel->fanout[j] >= fanout)
+	    break;
+
+    if (wlmodel->fanout[j] == fanout)
+	return wlmodel->length[j];
+    else if (j == 0)
+	return wlmodel->length[0] * (double)fanout / (double)wlmodel->fanout[0];
+
+    ffrac = (double)(fanout - wlmodel->fanout[j - 1]) /
+		(double)(wlmodel->fanout[j] - wlmodel->fanout[j - 1]);
+    return wlmodel->length[j - 1] + (wlmodel->length[j] - wlmodel->length[j - 1])
+		* ffrac;
+}
+
+/*--------------------------------------------------------------*/
+/* Choose the wire load model to use for the design.  If	*/
+/* "wlname" is given (from the command line), use that model.	*/
+/* Otherwise, use the liberty default wire load selection	*/
+/* based on total cell area, or failing that, the default wire	*/
+/* load.  Return NULL if no wire load model applies.		*/
+/*--------------------------------------------------------------*/
+
+wireloadptr select_wireload(wireloadptr wirelist, wlselptr sellist, char *wlname,
+		instptr instlist)
+{
+    wireloadptr wlmodel;
+    wlselptr testsel;
+    instptr testinst;
+    double area;
+
+    if (wlname == NULL) {
+	if (default_wlselect != NULL) {
+	    area = 0.0;
+	    for (testinst = instlist; testinst; testinst = testinst->next)
+		area += testinst->refcell->area;
+
+	    for (testsel = sellist; testsel; testsel = testsel->next) {
+		if (strcmp(testsel->name, default_wlselect)) continue;
+		if ((area >= testsel->minarea) && (area < testsel->maxarea)) {
+		    wlname = testsel->wlname;
+		    break;
+		}
+	    }
+	}
+	if (wlname == NULL) wlname = default_wireload;
+	if (wlname == NULL) return NULL;
+    }
+    else if (!strcasecmp(wlname, "none"))
+	return NULL;
+
+    for (wlmodel = wirelist; wlmodel; wlmodel = wlmodel->next)
+	if (!strcmp(wlmodel->name, wlname))
+	    break;
+
+    if (wlmodel == NULL)
+	fprintf(stderr, "No wire load model \"%s\" in liberty file.\n", wlname);
+    return wlmodel;
+}
+
+/*--------------------------------------------------------------*/
+/* Read the on-chip variation derating file "fname".  Each line	*/
+/* has one entry, and "#" begins a comment:			*/
+/*								*/
+/*	early <factor>		Global early (minimum) derate	*/
+/*	late <factor>		Global late (maximum) derate	*/
+/*	cell <name> [early <factor>] [late <factor>]		*/
+/*				Derates for one cell, replacing	*/
+/*				the global derates		*/
+/*	aocv depth <d1> <d2> ...  Logic depths, ascending	*/
+/*	aocv early <f1> <f2> ...  Early derate at each depth	*/
+/*	aocv late <f1> <f2> ...	  Late derate at each depth	*/
+/*								*/
+/* AOCV derates multiply the global or cell derates.  A missing	*/
+/* "aocv early" or "aocv late" row is taken as all 1.		*/
+/*								*/
+/* Return the number of errors found.				*/
+/*--------------------------------------------------------------*/
+
+int readDerates(char *fname, cellptr cells)
+{
+    FILE *fderate;
+    char line[LIB_LINE_MAX], *token, *ptr;
+    cellptr testcell;
+    double *values, *rows[3];
+    int i, r, numvals, linenum, errors, numcells;
+    int entries[3];
+
+    fderate = fopen(fname, "r");
+    if (fderate == NULL) {
+	fprintf(stderr, "Cannot open %s for reading\n", fname);
+	return 1;
+    }
+
+    // AOCV rows, in order "depth", "early", "late"
+
+    for (r = 0; r < 3; r++) {
+	rows[r] = NULL;
+	entries[r] = 0;
+    }
+    errors = numcells = linenum = 0;
+
+    while (fgets(line, LIB_LINE_MAX, fderate) != NULL) {
+	linenum++;
+	if ((ptr = strchr(line, '#')) != NULL) *ptr = '\0';
+	token = strtok(line, " \t\r\n");
+	if (token == NULL) continue;
+
+	if (!strcasecmp(token, "early") || !strcasecmp(token, "late")) {
+	    ptr = strtok(NULL, " \t\r\n");
+	    if ((ptr == NULL) || (strtod(ptr, NULL) <= 0.0)) {
+		fprintf(stderr, "%s line %d:  Bad derate value.\n", fname, linenum);
+		errors++;
+	    }
+	    else if (!strcasecmp(token, "early"))
+		derate_early = strtod(ptr, NULL);
+	    else
+		derate_late = strtod(ptr, NULL);
+	}
+	else if (!strcasecmp(token, "cell")) {
+	    ptr = strtok(NULL, " \t\r\n");
+	    testcell = NULL;
+	    if (ptr != NULL)
+		for (testcell = cells; testcell; testcell = testcell->next)
+		    if (!strcmp(testcell->name, ptr))
+			break;
+	    if (testcell == NULL) {
+		fprintf(stderr, "%s line %d:  Unknown cell \"%s\".\n", fname,
+			linenum, (ptr) ? ptr : "");
+		errors++;
+		continue;
+	    }
+	    numcells++;
+	    while ((token = strtok(NULL, " \t\r\n")) != NULL) {
+		ptr = strtok(NULL, " \t\r\n");
+		if ((ptr == NULL) || (strtod(ptr, NULL) <= 0.0)) {
+		    fprintf(stderr, "%s line %d:  Bad derate value.\n", fname, linenum);
+		    errors++;
+		    break;
+		}
+		if (!strcasecmp(token, "early"))
+		    testcell->early = strtod(ptr, NULL);
+		else if (!strcasecmp(token, "late"))
+		    testcell->late = strtod(ptr, NULL);
+		else {
+		    fprintf(stderr, "%s line %d:  Unknown keyword \"%s\".\n", fname,
+				linenum, token);
+		    errors++;
+		    break;
+		}
+	    }
+	}
+	else if (!strcasecmp(token, "aocv")) {
+	    token = strtok(NULL, " \t\r\n");
+	    if (token == NULL)
+		r = -1;
+	    else if (!strcasecmp(token, "depth"))
+		r = 0;
+	    else if (!strcasecmp(token, "early"))
+		r = 1;
+	    else if (!strcasecmp(token, "late"))
+		r = 2;
+	    else
+		r = -1;
+	    if (r < 0) {
+		fprintf(stderr, "%s line %d:  Unknown AOCV row \"%s\".\n", fname,
+			linenum, (token) ? token : "");
+		errors++;
+		continue;
+	    }
+	    numvals = 0;
+	    values = NULL;
+	    while ((ptr = strtok(NULL, " \t\r\n")) != NULL) {
+		values = (double *)realloc(values, (numvals + 1) * sizeof(double));
+		values[numvals++] = strtod(ptr, NULL);
+	    }
+	    if (rows[r] != NULL) free(rows[r]);
+	    rows[r] = values;
+	    entries[r] = numvals;
+	}
+	else {
+	    fprintf(stderr, "%s line %d:  Unknown keyword \"%s\".\n", fname,
+			linenum, token);
+	    errors++;
+	}
+    }
+    fclose(fderate);
+
+    // Check and build the AOCV table
+
+    if ((rows[0] != NULL) || (rows[1] != NULL) || (rows[2] != NULL)) {
+	r = 1;
+	if ((entries[0] == 0) || ((rows[1] == NULL) && (rows[2] == NULL)))
+	    r = 0;
+	if ((rows[1] != NULL) && (entries[1] != entries[0])) r = 0;
+	if ((rows[2] != NULL) && (entries[2] != entries[0])) r = 0;
+	for (i = 1; i < entries[0]; i++)
+	    if ((int)rows[0][i] <= (int)rows[0][i - 1])
+		r = 0;
+
+	if (r == 0) {
+	    fprintf(stderr, "%s:  AOCV table needs ascending depths and an equal "
+			"number of derates.\n", fname);
+	    errors++;
+	    for (r = 0; r < 3; r++)
+		if (rows[r] != NULL) free(rows[r]);
+	}
+	else {
+	    aocv = (aocvtable *)malloc(sizeof(aocvtable));
+	    aocv->entries = entries[0];
+	    aocv->depth = (int *)malloc(entries[0] * sizeof(int));
+	    for (i = 0; i < entries[0]; i++)
+		aocv->depth[i] = (int)rows[0][i];
+	    free(rows[0]);
+	    for (r = 1; r < 3; r++) {
+		if (rows[r] == NULL) {
+		    rows[r] = (double *)malloc(entries[0] * sizeof(double));
+		    for (i = 0; i < entries[0]; i++) rows[r][i] = 1.0;
+		}
+	    }
+	    aocv->early = rows[1];
+	    aocv->late = rows[2];
+	}
+    }
+
+    fprintf(stdout, "Derates:  early %g, late %g, %d cell%s", derate_early,
+		derate_late, numcells, (numcells == 1) ? "" : "s");
+    if (aocv != NULL)
+	fprintf(stdout, ", AOCV table of %d depth%s", aocv->entries,
+		(aocv->entries == 1) ? "" : "s");
+    fprintf(stdout, ".\n");
+
+    return errors;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the derate for logic depth "depth" from the AOCV	*/
+/* table row "factors", interpolating between depth entries.	*/
+/*--------------------------------------------------------------*/
+
+double aocv_derate(double *factors, int depth)
+{
+    double frac;
+    int i;
+
+    if (depth <= aocv->depth[0]) return factors[0];
+    for (i = 1; i < aocv->entries; i++)
+	if (depth < aocv->depth[i])
+	    break;
+    if (i == aocv->entries) return factors[i - 1];
+
+    frac = (double)(depth - aocv->depth[i - 1]) /
+		(double)(aocv->depth[i] - aocv->depth[i - 1]);
+    return factors[i - 1] + frac * (factors[i] - factors[i - 1]);
+}
+
+/*--------------------------------------------------------------*/
+/* Return the number of gates on the shortest path from the	*/
+/* outputs of "testinst" to a path end (output or register	*/
+/* input), not counting "testinst" itself.  "bwd" holds the	*/
+/* same count plus one for each gate later in "toporder".	*/
+/*--------------------------------------------------------------*/
+
+int depth_to_end(instptr testinst, int *bwd)
+{
+    connptr testconn, outconn;
+    netptr loadnet;
+    int i, d;
+
+    d = -1;
+    for (outconn = testinst->out_connects; outconn; outconn = outconn->next) {
+	loadnet = outconn->refnet;
+	if (loadnet == NULL) continue;
+	for (i = 0; i < loadnet->fanout; i++) {
+	    testconn = loadnet->receivers[i];
+	    if ((testconn->refinst == NULL) || (testconn->refinst->index < 0) ||
+			(testconn->flags & CONN_BROKEN))
+		return 0;
+	    if ((d < 0) || (bwd[testconn->refinst->index] < d))
+		d = bwd[testconn->refinst->index];
+	}
+    }
+    return (d < 0) ? 0 : d;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the logic depth of each instance for AOCV derating.	*/
+/* This is the number of gates on the shortest path through	*/
+/* the instance from a path start (input or register output)	*/
+/* to a path end (output or register input).  The gates are in	*/
+/* topological order after break_loops(), so one forward pass	*/
+/* finds the depth from the start and one backward pass finds	*/
+/* the depth to the end.  A register counts as the first gate	*/
+/* of the paths from its outputs.				*/
+/*--------------------------------------------------------------*/
+
+void compute_logic_depth(instptr instlist)
+{
+    instptr testinst, drvinst;
+    connptr testconn;
+    int *fwd, *bwd;
+    int n, d;
+
+    fwd = (int *)malloc((numtoporder + 1) * sizeof(int));
+    bwd = (int *)malloc((numtoporder + 1) * sizeof(int));
+
+    for (n = 0; n < numtoporder; n++) {
+	d = -1;
+	for (testconn = toporder[n]->in_connects; testconn; testconn = testconn->next) {
+	    if (testconn->flags & CONN_BROKEN) continue;
+	    drvinst = NULL;
+	    if ((testconn->refnet != NULL) && (testconn->refnet->driver != NULL))
+		drvinst = testconn->refnet->driver->refinst;
+	    if ((drvinst == NULL) || (drvinst->index < 0))
+		d = 0;				// Path start
+	    else if ((d < 0) || (fwd[drvinst->index] < d))
+		d = fwd[drvinst->index];
+	}
+	fwd[n] = (d < 0) ? 1 : d + 1;
+    }
+
+    for (n = numtoporder - 1; n >= 0; n--) {
+	d = depth_to_end(toporder[n], bwd);
+	bwd[n] = d + 1;
+	toporder[n]->depth = fwd[n] + d;
+    }
+
+    for (testinst = instlist; testinst; testinst = testinst->next)
+	if (testinst->index < 0)
+	    testinst->depth = depth_to_end(testinst, bwd) + 1;
+
+    free(fwd);
+    free(bwd);
+}
+
+/*--------------------------------------------------------------*/
+/* Find the table, load, and derating factor triple in the hash	*/
+/* table "ctab", and add it if it is not there.  Return the	*/
+/* index of the triple.						*/
+/*--------------------------------------------------------------*/
+
+int collapse_lookup(collapsetab *ctab, lutableptr table, double load, double scale)
+{
+    unsigned long long hval, sval;
+    unsigned int h;
+    collapse *key;
+    int idx;
+
+    memcpy(&hval, &load, sizeof(double));
+    memcpy(&sval, &scale, sizeof(double));
+    hval ^= (unsigned long long)(size_t)table * 0x9E3779B97F4A7C15ULL;
+    hval ^= (sval << 17) | (sval >> 47);
+    hval ^= hval >> 31;
+    hval *= 0xBF58476D1CE4E5B9ULL;
+    hval ^= hval >> 29;
+
+    for (h = (unsigned int)hval & ctab->mask; ; h = (h + 1) & ctab->mask) {
+	idx = ctab->hash[h];
+	if (idx < 0) break;
+	key = ctab->keys + idx;
+	if ((key->table == table) && (key->load == load) && (key->scale == scale))
+	    return idx;
+    }
+
+    idx = ctab->numkeys++;
+    ctab->hash[h] = idx;
+    key = ctab->keys + idx;
+    key->table = table;
+    key->load = load;
+    key->scale = scale;
+    key->vector = NULL;
+    return idx;
+}
+
+/*--------------------------------------------------------------*/
+/* Thread worker for computeLoads():  Sum up the loads on nets	*/
+/* "start" to "end" - 1.					*/
+/*--------------------------------------------------------------*/
+
+void net_load_worker(void *data, int start, int end, int thread)
+{
+    loaddata *ld = (loaddata *)data;
+    netptr testnet;
+    connptr testconn;
+    pinptr testpin;
+    double wiredelay;
+    int n, i;
+
+    for (n = start; n < end; n++) {
+	testnet = ld->nets[n];
+	for (i = 0; i < testnet->fanout; i++) {
+	    testconn = testnet->receivers[i];
+	    testpin = testconn->refpin;
+	    if (testpin == NULL) {
+		testnet->loadr += ld->out_load;
+		testnet->loadf += ld->out_load;
+	    }
+	    else {
+		testnet->loadr += testpin->capr;
+		testnet->loadf += testpin->capf;
+	    }
+	}
+
+	// Parasitics from readSPEF() replace the wire load estimate
+
+	if (testnet->wirecap >= 0.0) {
+	    testnet->loadr += testnet->wirecap;
+	    testnet->loadf += testnet->wirecap;
+	}
+	else if (testnet->rpi >= 0.0) {
+	    wiredelay = testnet->rpi * (testnet->cfar + ((testnet->loadr >
+			testnet->loadf) ? testnet->loadr : testnet->loadf)) * 1E-3;
+	    for (i = 0; i < testnet->fanout; i++)
+		testnet->receivers[i]->wiredelay = wiredelay;
+	    testnet->loadr += testnet->cnear + testnet->cfar;
+	    testnet->loadf += testnet->cnear + testnet->cfar;
+	}
+	else if ((ld->wlcap != NULL) && (testnet->fanout > 0)) {
+	    wiredelay = ld->wlres[testnet->fanout] * (0.5 * ld->wlcap[testnet->fanout]
+			+ testnet->loadr);
+	    for (i = 0; i < testnet->fanout; i++)
+		testnet->receivers[i]->wiredelay = wiredelay;
+	    testnet->loadr += ld->wlcap[testnet->fanout];
+	    testnet->loadf += ld->wlcap[testnet->fanout];
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Return the effective capacitance of net "testnet" on edge	*/
+/* "e" for a driver with transition time table "table" and	*/
+/* input transition time "slew" (see compute_ceff()).		*/
+/*--------------------------------------------------------------*/
+
+double effective_cap(netptr testnet, short e, lutableptr table, double slew)
+{
+    double load, c1, c2, tau, ceff, nceff, trans;
+    int iter;
+
+    load = (e == 0) ? testnet->loadr : testnet->loadf;
+
+    // Receiver pins, and any wire capacitance that the pi model
+    // does not account for, go on the far side.
+
+    c1 = testnet->cnear;
+    c2 = load - c1;
+    if (c2 <= 0.0) return load;
+
+    tau = testnet->rpi * c2 * 1E-3;	// ohms * fF = 1E-3 ps
+    if (tau <= 0.0) return load;
+
+    ceff = load;
+    for (iter = 0; iter < 10; iter++) {
+	trans = binomial_get_value(table, slew, ceff);
+	if (trans <= 0.0) break;
+	nceff = c1 + c2 * (1.0 - (tau / trans) * (1.0 - exp(-trans / tau)));
+	if (fabs(nceff - ceff) < 1E-3 * ceff) {
+	    ceff = nceff;
+	    break;
+	}
+	ceff = nceff;
+    }
+    return ceff;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the effective capacitance seen by the driver of net	*/
+/* "testnet" on edge "e" (0 rising, 1 falling), from the net's	*/
+/* pi model.  The driver output is taken as a ramp of the	*/
+/* transition time T found from the driver's table at load	*/
+/* Ceff.  Through the resistance R, the far capacitance C2	*/
+/* charges with time constant tau = R * C2, and			*/
+/*								*/
+/*   Ceff = C1 + C2 * (1 - (tau / T) * (1 - exp(-T / tau)))	*/
+/*								*/
+/* so that Ceff = C1 + C2 when the wire is fast, and Ceff falls	*/
+/* toward C1 as the wire gets slow.  Iterate from the total	*/
+/* load until Ceff settles, which takes a few passes.  The	*/
+/* driver's input transition is not known yet, so the table is	*/
+/* read at the middle of its transition range.  Of the arcs of	*/
+/* the driver, the one with the slowest output is used.		*/
+/*--------------------------------------------------------------*/
+
+double compute_ceff(netptr testnet, short e)
+{
+    connptr testconn;
+    lutableptr table, ttable;
+    double load, trans, tmax, slew;
+
+    load = (e == 0) ? testnet->loadr : testnet->loadf;
+    if ((testnet->driver == NULL) || (testnet->driver->refinst == NULL))
+	return load;
+
+    table = NULL;
+    tmax = 0.0;
+    for (testconn = testnet->driver->refinst->in_connects; testconn;
+		testconn = testconn->next) {
+	ttable = (e == 0) ? testconn->refpin->transr : testconn->refpin->transf;
+	if ((ttable == NULL) || (ttable->size1 < 1)) continue;
+	slew = ttable->idx1.times[ttable->size1 >> 1];
+	trans = binomial_get_value(ttable, slew, load);
+	if ((table == NULL) || (trans > tmax)) {
+	    table = ttable;
+	    tmax = trans;
+	}
+    }
+    if (table == NULL) return load;
+    slew = table->idx1.times[table->size1 >> 1];
+
+    return effective_cap(testnet, e, table, slew);
+}
+
+/*--------------------------------------------------------------*/
+/* Thread worker for computeLoads():  Find the effective	*/
+/* capacitance of nets "start" to "end" - 1 that have a pi	*/
+/* model.  A net keeps its result until its pi model changes.	*/
+/*--------------------------------------------------------------*/
+
+void ceff_worker(void *data, int start, int end, int thread)
+{
+    loaddata *ld = (loaddata *)data;
+    netptr testnet;
+    int n;
+
+    for (n = start; n < end; n++) {
+	testnet = ld->nets[n];
+	if ((testnet->rpi < 0.0) || (testnet->flags & NET_CEFF)) continue;
+	testnet->ceff[0] = compute_ceff(testnet, 0);
+	testnet->ceff[1] = compute_ceff(testnet, 1);
+	testnet->flags |= NET_CEFF;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Thread worker for computeLoads():  Collapse table, load,	*/
+/* and factor triples "start" to "end" - 1.  Each thread	*/
+/* allocates a single output buffer for all of the vectors that	*/
+/* it generates.						*/
+/*--------------------------------------------------------------*/
+
+void collapse_worker(void *data, int start, int end, int thread)
+{
+    loaddata *ld = (loaddata *)data;
+    collapse *key;
+    double *buffer;
+    int n, i, size;
+
+    size = 0;
+    for (n = start; n < end; n++)
+	size += ld->keys[n].table->size1;
+    if (size == 0) return;
+
+    buffer = (double *)malloc(size * sizeof(double));
+    for (n = start; n < end; n++) {
+	key = ld->keys + n;
+	key->vector = buffer;
+	table_collapse_into(key->table, key->load, buffer);
+	if (key->scale != 1.0)
+	    for (i = 0; i < key->table->size1; i++)
+		buffer[i] *= key->scale;
+	buffer += key->table->size1;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* For each net, go through the list of receivers and add the	*/
+/* contributions of each to the total load.  This is either	*/
+/* the input pin capacitance, if the receiver is a pin, or the	*/
+/* designated output load (given on the command line), if the	*/
+/* receiver is an output pin.					*/
+/*								*/
+/* If a wire load model "wlmodel" is given, then add the wire	*/
+/* capacitance estimated from the net fanout to the load, and	*/
+/* set the wire delay to each receiver from the estimated wire	*/
+/* resistance (lumped pi model:  R * (C_wire / 2 + C_pins)).	*/
+/* Nets annotated by readSPEF() or readPiModels() use their	*/
+/* parasitics instead.						*/
+/*								*/
+/* The tables of the driver of a net with a pi model are	*/
+/* collapsed at the effective capacitance from compute_ceff()	*/
+/* in place of the total load.					*/
+/*								*/
+/* Propagation delay vectors are scaled by the on-chip		*/
+/* variation derates of the instance, once for late (maximum)	*/
+/* and once for early (minimum) timing.				*/
+/*								*/
+/* Both the load sums and the table collapse are split among	*/
+/* worker threads.						*/
+/*--------------------------------------------------------------*/
+
+void
+computeLoads(netptr netlist, instptr instlist, double out_load, wireloadptr wlmodel)
+{
+    instptr testinst;
+    cellptr testcell;
+    pinptr testpin;
+    netptr testnet, loadnet;
+    connptr testconn;
+    loaddata ld;
+    collapsetab ctab;
+    double ***reqfield;
+    double early, late, loadr, loadf;
+    int *reqkey;
+    int i, numnets, numreqs, maxfanout;
+
+    // Precompute wire capacitance and resistance for each fanout
+    // value into a dense array, so that each net needs only a lookup.
+
+    numnets = 0;
+    maxfanout = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	numnets++;
+	if (testnet->fanout > maxfanout)
+	    maxfanout = testnet->fanout;
+    }
+
+    ld.out_load = out_load;
+    ld.wlcap = ld.wlres = NULL;
+    if (wlmodel != NULL) {
+	ld.wlcap = (double *)malloc((maxfanout + 1) * sizeof(double));
+	ld.wlres = (double *)malloc((maxfanout + 1) * sizeof(double));
+	for (i = 0; i <= maxfanout; i++) {
+	    ld.wlcap[i] = wireload_length(wlmodel, i);
+	    ld.wlres[i] = ld.wlcap[i] * wlmodel->resistance;
+	    ld.wlcap[i] *= wlmodel->capacitance;
+	}
+    }
+
+    ld.nets = (netptr *)malloc(numnets * sizeof(netptr));
+    i = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next)
+	ld.nets[i++] = testnet;
+
+    run_parallel(numnets, net_load_worker, (void *)&ld);
+    run_parallel(numnets, ceff_worker, (void *)&ld);
+
+    free(ld.nets);
+    if (wlmodel != NULL) {
+	free(ld.wlcap);
+	free(ld.wlres);
+    }
+
+    // For each instance input pin, collapse the pin's lookup table
+    // to a vector by interpolating/extrapolating the table at the
+    // calculated output load.  Save this vector in the connection
+    // record for the pin.  Identical table and load pairs (e.g., the
+    // same pin of the same cell driving the same load) are collapsed
+    // only once, and the vector is shared.  If the early and late
+    // derates are the same, then so are the early and late vectors
+    // (unless a timing model has separate early tables).
+
+    if (aocv != NULL) compute_logic_depth(instlist);
+
+    numreqs = 0;
+    for (testinst = instlist; testinst; testinst = testinst->next)
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	    numreqs += 8;
+
+    reqfield = (double ***)malloc(numreqs * sizeof(double **));
+    reqkey = (int *)malloc(numreqs * sizeof(int));
+
+    ctab.keys = (collapse *)malloc(numreqs * sizeof(collapse));
+    ctab.numkeys = 0;
+    for (ctab.mask = 1; ctab.mask < 2 * numreqs; ctab.mask <<= 1);
+    ctab.hash = (int *)malloc(ctab.mask * sizeof(int));
+    for (i = 0; i < ctab.mask; i++) ctab.hash[i] = -1;
+    ctab.mask--;
+
+    numreqs = 0;
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	loadnet = testinst->out_connects->refnet;
+	if (loadnet->rpi >= 0.0) {
+	    loadr = loadnet->ceff[0];
+	    loadf = loadnet->ceff[1];
+	}
+	else {
+	    loadr = loadnet->loadr;
+	    loadf = loadnet->loadf;
+	}
+	testcell = testinst->refcell;
+	early = (testcell->early > 0.0) ? testcell->early : derate_early;
+	late = (testcell->late > 0.0) ? testcell->late : derate_late;
+	if (aocv != NULL) {
+	    early *= aocv_derate(aocv->early, testinst->depth);
+	    late *= aocv_derate(aocv->late, testinst->depth);
+	}
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    testpin = testconn->refpin;
+
+	    // Timing models may have separate early tables
+
+	    if (testpin->propdelr) {
+		reqfield[numreqs] = &testconn->prvector;
+		reqkey[numreqs++] = collapse_lookup(&ctab, testpin->propdelr,
+			loadr, late);
+		reqfield[numreqs] = &testconn->prminvector;
+		reqkey[numreqs++] = collapse_lookup(&ctab, (testpin->minpropdelr) ?
+			testpin->minpropdelr : testpin->propdelr, loadr, early);
+	    }
+	    if (testpin->propdelf) {
+		reqfield[numreqs] = &testconn->pfvector;
+		reqkey[numreqs++] = collapse_lookup(&ctab, testpin->propdelf,
+			loadf, late);
+		reqfield[numreqs] = &testconn->pfminvector;
+		reqkey[numreqs++] = collapse_lookup(&ctab, (testpin->minpropdelf) ?
+			testpin->minpropdelf : testpin->propdelf, loadf, early);
+	    }
+	    if (testpin->transr) {
+		reqfield[numreqs] = &testconn->trvector;
+		reqkey[numreqs++] = collapse_lookup(&ctab, testpin->transr,
+			loadr, 1.0);
+		reqfield[numreqs] = &testconn->trminvector;
+		reqkey[numreqs++] = collapse_lookup(&ctab, (testpin->mintransr) ?
+			testpin->mintransr : testpin->transr, loadr, 1.0);
+	    }
+	    if (testpin->transf) {
+		reqfield[numreqs] = &testconn->tfvector;
+		reqkey[numreqs++] = collapse_lookup(&ctab, testpin->transf,
+			loadf, 1.0);
+		reqfield[numreqs] = &testconn->tfminvector;
+		reqkey[numreqs++] = collapse_lookup(&ctab, (testpin->mintransf) ?
+			testpin->mintransf : testpin->transf, loadf, 1.0);
+	    }
+	}
+    }
+
+    ld.keys = ctab.keys;
+    run_parallel(ctab.numkeys, collapse_worker, (void *)&ld);
+
+    for (i = 0; i < numreqs; i++)
+	*(reqfield[i]) = ctab.keys[reqkey[i]].vector;
+
+    if (verbose > 1)
+	fprintf(stdout, "Collapsed %d unique tables for %d pin arcs.\n",
+		ctab.numkeys, numreqs);
+
+    free(ctab.hash);
+    free(ctab.keys);
+    free(reqkey);
+    free(reqfield);
+}
+
+/*--------------------------------------------------------------*/
+/* Evaluate the liberty function string at "*sptr" (e.g.,	*/
+/* "(!((A B)+C))") for the input values in the bits of		*/
+/* "values", where bit N is the value of the pin of the Nth	*/
+/* connection in "inputs".  "level" is the operator precedence	*/
+/* being parsed:  0 for OR ("+" or "|"), 1 for XOR ("^"), 2 for	*/
+/* AND ("*", "&", or a space), and 3 for a single term.  The	*/
+/* pointer is left after the parsed expression.  Unknown names	*/
+/* evaluate to 0.						*/
+/*--------------------------------------------------------------*/
+
+int eval_function(char **sptr, connptr inputs, int values, int level)
+{
+    connptr testconn;
+    char *s, *e, c;
+    int result, operand, i, n;
+
+    s = *sptr;
+    if (level < 3) {
+	result = eval_function(&s, inputs, values, level + 1);
+	while (1) {
+	    while ((*s == ' ') || (*s == '\t')) s++;
+	    c = *s;
+	    if ((level == 0) && ((c == '+') || (c == '|')))
+		s++;
+	    else if ((level == 1) && (c == '^'))
+		s++;
+	    else if ((level == 2) && ((c == '*') || (c == '&')))
+		s++;
+	    else if ((level == 2) && (isalnum(c) || (c == '_') || (c == '(') || (c == '!')))
+		;	/* AND by juxtaposition */
+	    else
+		break;
+	    operand = eval_function(&s, inputs, values, level + 1);
+	    if (level == 0)
+		result |= operand;
+	    else if (level == 1)
+		result ^= operand;
+	    else
+		result &= operand;
+	}
+    }
+    else {
+	while ((*s == ' ') || (*s == '\t')) s++;
+	if (*s == '!') {
+	    s++;
+	    result = !eval_function(&s, inputs, values, 3);
+	}
+	else if (*s == '(') {
+	    s++;
+	    result = eval_function(&s, inputs, values, 0);
+	    while ((*s == ' ') || (*s == '\t')) s++;
+	    if (*s == ')') s++;
+	}
+	else {
+	    for (e = s; isalnum(*e) || (*e == '_') || (*e == '[') || (*e == ']'); e++);
+	    n = e - s;
+	    result = 0;
+	    if ((n == 1) && (*s == '1'))
+		result = 1;
+	    else if (n > 0) {
+		for (testconn = inputs, i = 0; testconn; testconn = testconn->next, i++) {
+		    if ((testconn->refpin != NULL) &&
+				(strlen(testconn->refpin->name) == n) &&
+				!strncmp(testconn->refpin->name, s, n)) {
+			result = (values >> i) & 1;
+			break;
+		    }
+		}
+	    }
+	    s = e;
+	}
+	while (*s == '\'') {
+	    s++;
+	    result = !result;
+	}
+    }
+    *sptr = s;
+    return result;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the kind of clock gating check at input "gateconn" of	*/
+/* the gate whose clock input is "clkconn", from the function	*/
+/* of the gate:  CONN_GATE_HIGH if the gating input controls	*/
+/* the output only while the clock is high (an AND or NAND	*/
+/* gate), so it must not change then;  CONN_GATE_LOW if only	*/
+/* while the clock is low (an OR or NOR gate);  or 0 if the	*/
+/* gate has no function or is not a gate of either kind (e.g.,	*/
+/* an XOR or a mux).						*/
+/*--------------------------------------------------------------*/
+
+short clock_gating_style(instptr testinst, connptr clkconn, connptr gateconn)
+{
+    connptr testconn;
+    char *fptr;
+    int ci, gi, i, n, c, v, f0, f1;
+    int depends[2];
+
+    if (testinst->refcell->function == NULL) return 0;
+
+    ci = gi = -1;
+    for (testconn = testinst->in_connects, n = 0; testconn; testconn = testconn->next, n++) {
+	if (testconn == clkconn) ci = n;
+	if (testconn == gateconn) gi = n;
+    }
+    if ((ci < 0) || (gi < 0) || (n > 16)) return 0;
+
+    depends[0] = depends[1] = 0;
+    for (i = 0; i < (1 << n); i++) {
+	if (i & ((1 << ci) | (1 << gi))) continue;
+	for (c = 0; c < 2; c++) {
+	    v = i | (c << ci);
+	    fptr = testinst->refcell->function;
+	    f0 = eval_function(&fptr, testinst->in_connects, v, 0);
+	    fptr = testinst->refcell->function;
+	    f1 = eval_function(&fptr, testinst->in_connects, v | (1 << gi), 0);
+	    if (f0 != f1) depends[c] = 1;
+	}
+    }
+    if (depends[1] && !depends[0]) return CONN_GATE_HIGH;
+    if (depends[0] && !depends[1]) return CONN_GATE_LOW;
+    return 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the net that drives "testnet" through a chain of	*/
+/* buffers and inverters (gates with one input), if any.	*/
+/*--------------------------------------------------------------*/
+
+netptr clock_origin(netptr testnet)
+{
+    connptr driver, testconn, single;
+    int n;
+
+    while (((driver = testnet->driver) != NULL) && (driver->refinst != NULL) &&
+		!(driver->refinst->refcell->type & (DFF | LATCH))) {
+	single = NULL;
+	n = 0;
+	for (testconn = driver->refinst->in_connects; testconn; testconn = testconn->next) {
+	    if ((testconn->flags & CONN_BROKEN) || (testconn->refnet == NULL)) continue;
+	    single = testconn;
+	    n++;
+	}
+	if (n != 1) break;
+	testnet = single->refnet;
+    }
+    return testnet;
+}
+
+/*--------------------------------------------------------------*/
+/* Trace the clock network back from "clknet", marking each	*/
+/* net upstream as a CLOCK net, and find the clock gates on it.	*/
+/* At a gate with more than one input, the clock is the input	*/
+/* reached through buffers and inverters from a module input	*/
+/* (or, if there are several, from a net already known to be a	*/
+/* clock).  The other inputs are gating inputs, flagged		*/
+/* CONN_GATE_ENABLE and with the kind of check made (see	*/
+/* clock_gating_style()), and only the clock is traced		*/
+/* further.  If the clock can't be told apart, all inputs are	*/
+/* traced, as in find_clock_source().				*/
+/*--------------------------------------------------------------*/
+
+void find_clock_gates(netptr clknet)
+{
+    connptr driver, testconn, clkconn, knownconn;
+    instptr testinst;
+    netptr origin;
+    int numin, numclk, numknown;
+
+    driver = clknet->driver;
+    if ((driver == NULL) || (driver->refinst == NULL)) return;
+    testinst = driver->refinst;
+    if (testinst->refcell->type & (DFF | LATCH)) return;
+
+    numin = numclk = numknown = 0;
+    clkconn = knownconn = NULL;
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	if ((testconn->flags & CONN_BROKEN) || (testconn->refnet == NULL)) continue;
+	numin++;
+	origin = clock_origin(testconn->refnet);
+	if (origin->type & (CLOCK | ENABLE)) {
+	    numknown++;
+	    knownconn = testconn;
+	}
+	if ((origin->driver == NULL) || (origin->driver->refinst == NULL) ||
+			(origin->type & (CLOCK | ENABLE))) {
+	    numclk++;
+	    clkconn = testconn;
+	}
+    }
+    if (numclk != 1) clkconn = (numknown == 1) ? knownconn : NULL;
+
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	if ((testconn->flags & CONN_BROKEN) || (testconn->refnet == NULL)) continue;
+	if ((numin > 1) && (clkconn != NULL) && (testconn != clkconn)) {
+	    testconn->flags |= CONN_GATE_ENABLE;
+	    testconn->flags |= clock_gating_style(testinst, clkconn, testconn);
+	    if (testconn->flags & (CONN_GATE_HIGH | CONN_GATE_LOW))
+		testconn->refnet->type |= GATING;
+	    continue;
+	}
+	if (testconn->refnet->type & (CLOCK | ENABLE)) continue;
+	testconn->refnet->type |= CLOCK;
+	find_clock_gates(testconn->refnet);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Assign types to each net.  This identifies which nets are	*/
+/* clock inputs, which are latch enable inputs, and which are	*/
+/* asynchronous set/reset inputs,.				*/
+/*								*/
+/* Whenever a clock input to a flop or an enable input to a	*/
+/* latch is found, add the connection record to clockedlist	*/
+/*								*/
+/* The clock network is then traced back from the clock and	*/
+/* enable inputs to find the clock gating inputs, which are	*/
+/* checked by check_gating_timing().				*/
+/*								*/
+/* For diagnostics, return the number of entries in clockedlist	*/
+/*--------------------------------------------------------------*/
+
+int assign_net_types(netptr netlist, connlistptr *clockedlist)
+{
+    int i, numterms;
+    netptr testnet;
+    connptr testrcvr;
+    pinptr testpin;
+    connlistptr newclocked;
+
+    numterms = 0;
+
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	for (i = 0; i < testnet->fanout; i++) {
+	    testrcvr = testnet->receivers[i];
+	    testpin = testrcvr->refpin;
+	    if (testpin == NULL)
+		testnet->type |= OUTTERM;
+	    else {
+		switch (testpin->type & (DFFMASK | LATCHMASK)) {
+		    case DFFCLK:
+			testnet->type |= CLOCK;
+			newclocked = (connlistptr)malloc(sizeof(connlist));
+			newclocked->connection = testrcvr;
+			newclocked->next = *clockedlist;
+			*clockedlist = newclocked;
+			numterms++;
+			break;
+		    case DFFIN:
+			testnet->type |= TERMINAL;
+			break;
+		    case DFFSET:
+		    case DFFRST:
+			testnet->type |= ASYNC;
+			break;
+		    case LATCHIN:
+			testnet->type |= LATCHTERM;
+			break;
+		    case LATCHEN:
+			testnet->type |= ENABLE;
+			newclocked = (connlistptr)malloc(sizeof(connlist));
+			newclocked->connection = testrcvr;
+			newclocked->next = *clockedlist;
+			*clockedlist = newclocked;
+			numterms++;
+			break;
+		}
+	    }
+	}
+    }
+
+    for (newclocked = *clockedlist; newclocked; newclocked = newclocked->next)
+	find_clock_gates(newclocked->connection->refnet);
+
+    return numterms;
+}
+
+/*--------------------------------------------------------------*/
+/* Create the links representing the netlist connections.	*/
+/*								*/
+/* The verilogRead() routine added all nets and instances, and	*/
+/* for each instance, generated a list of net connections to	*/
+/* each pin.  To make the netlist easily traversible, this	*/
+/* routine does the following:					*/
+/*								*/
+/* For each instance, work through the list of pin		*/
+/*	connections.  If the pin is an output, then add the	*/
+/*	connection as the net's driver entry.  If the pin is	*/
+/*	an input, then add the connection to the list of the	*/
+/*	net's receivers, and increment the net's fanout.	*/
+/*								*/
+/* For each module input, add the input connection as the	*/
+/*	net's driver (flag an error if the net already has a	*/
+/*	driver).						*/
+/*								*/
+/* For each module output, add the output connection as one of	*/
+/*	the net's receivers (it may be the only one).		*/
+/*								*/
+/*--------------------------------------------------------------*/
+
+void
+createLinks(netptr netlist, instptr instlist, connptr inputlist, connptr outputlist)
+{
+    netptr testnet;
+    instptr testinst;
+    connptr testconn;
+
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    testnet = testconn->refnet;
+	    testnet->fanout++;
+	    if (testnet->receivers == NULL)
+		testnet->receivers = (connptr *)malloc(sizeof(connptr));
+
+	    else
+		testnet->receivers = (connptr *)realloc(testnet->receivers,
+				testnet->fanout * sizeof(connptr));
+
+	    testnet->receivers[testnet->fanout - 1] = testconn;
+	} 
+
+	for (testconn = testinst->out_connects; testconn; testconn = testconn->next) {
+	    testnet = testconn->refnet;
+	    testnet->driver = testconn;
+	} 
+    }
+
+    for (testconn = inputlist; testconn; testconn = testconn->next) {
+	testnet = testconn->refnet;
+	if (testnet->driver != NULL)
+	    fprintf(stderr, "Error:  Input pin \"%s\" has an internal driver!\n",
+			testnet->name);
+	// else
+	//    testnet->driver = testconn;	// Don't do this, makes connectivity circular
+    }
+
+    for (testconn = outputlist; testconn; testconn = testconn->next) {
+	testnet = testconn->refnet;
+	testnet->fanout++;
+	if (testnet->receivers == NULL)
+	    testnet->receivers = (connptr *)malloc(sizeof(connptr));
+
+	else 
+	    testnet->receivers = (connptr *)realloc(testnet->receivers,
+			testnet->fanout * sizeof(connptr));
+
+	testnet->receivers[testnet->fanout - 1] = testconn;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Compare the names of two connections, as "instance/pin".	*/
+/*--------------------------------------------------------------*/
+
+int compconnname(connptr a, connptr b)
+{
+    int r;
+
+    r = strcmp(a->refinst->name, b->refinst->name);
+    if (r != 0) return r;
+    return strcmp(a->refpin->name, b->refpin->name);
+}
+
+/*--------------------------------------------------------------*/
+/* Find combinational loops as the strongly connected		*/
+/* components of the graph of gates (registers cut the graph),	*/
+/* using Tarjan's algorithm, and break each loop by cutting	*/
+/* one timing arc (gate input) inside it.  The arc cut is the	*/
+/* first by "instance/pin" name among the arcs marked		*/
+/* CONN_PREFER (from the --break-loop option) if there are any,	*/
+/* and among all arcs of the loop otherwise, so that the choice	*/
+/* does not depend on the order of the search.  Nested loops	*/
+/* are broken by repeating the search until the graph is	*/
+/* acyclic.							*/
+/*								*/
+/* The final search leaves the gates in topological order in	*/
+/* "toporder", with each gate's position in its "index" field.	*/
+/*								*/
+/* Return the number of loops broken.				*/
+/*--------------------------------------------------------------*/
+
+int break_loops(instptr instlist)
+{
+    instptr testinst, *nodes;
+    connptr testconn, outconn, cutconn, *curconn;
+    netptr  loadnet;
+    int     *lowlink, *order, *stack, *callstack, *curidx;
+    char    *onstack;
+    int     numnodes, n, v, w, sp, csp, counter, numscc, numloops, total;
+    int     i, first;
+
+    numnodes = 0;
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	testinst->index = -1;
+	if (testinst->refcell->type & (DFF | LATCH)) continue;
+	testinst->index = numnodes++;
+    }
+
+    nodes = (instptr *)malloc((numnodes + 1) * sizeof(instptr));
+    for (testinst = instlist; testinst; testinst = testinst->next)
+	if (testinst->index >= 0)
+	    nodes[testinst->index] = testinst;
+
+    order = (int *)malloc((numnodes + 1) * sizeof(int));
+    lowlink = (int *)malloc((numnodes + 1) * sizeof(int));
+    stack = (int *)malloc((numnodes + 1) * sizeof(int));
+    callstack = (int *)malloc((numnodes + 1) * sizeof(int));
+    curidx = (int *)malloc((numnodes + 1) * sizeof(int));
+    curconn = (connptr *)malloc((numnodes + 1) * sizeof(connptr));
+    onstack = (char *)malloc(numnodes + 1);
+
+    if (toporder != NULL) free(toporder);
+    toporder = (instptr *)malloc((numnodes + 1) * sizeof(instptr));
+    numtoporder = numnodes;
+
+    total = 0;
+    do {
+	for (n = 0; n < numnodes; n++) {
+	    order[n] = -1;
+	    onstack[n] = 0;
+	}
+	counter = sp = 0;
+	numscc = numloops = 0;
+
+	for (n = 0; n < numnodes; n++) {
+	    if (order[n] >= 0) continue;
+
+	    // Iterative depth-first search from node n.  Each node on
+	    // the call stack keeps its position in the list of outputs
+	    // and in the fanout of the current output net.
+
+	    csp = 0;
+	    callstack[csp++] = n;
+	    order[n] = lowlink[n] = counter++;
+	    stack[sp++] = n;
+	    onstack[n] = 1;
+	    curconn[n] = nodes[n]->out_connects;
+	    curidx[n] = 0;
+
+	    while (csp > 0) {
+		v = callstack[csp - 1];
+		w = -1;
+		while ((outconn = curconn[v]) != NULL) {
+		    loadnet = outconn->refnet;
+		    if ((loadnet == NULL) || (curidx[v] >= loadnet->fanout)) {
+			curconn[v] = outconn->next;
+			curidx[v] = 0;
+			continue;
+		    }
+		    testconn = loadnet->receivers[curidx[v]++];
+		    if (testconn->refinst == NULL) continue;
+		    if (testconn->refinst->index < 0) continue;
+		    if (testconn->flags & CONN_BROKEN) continue;
+		    w = testconn->refinst->index;
+		    if (order[w] < 0) break;		// Descend into w
+		    if (onstack[w] && (order[w] < lowlink[v]))
+			lowlink[v] = order[w];
+		    w = -1;
+		}
+
+		if (w >= 0) {
+		    callstack[csp++] = w;
+		    order[w] = lowlink[w] = counter++;
+		    stack[sp++] = w;
+		    onstack[w] = 1;
+		    curconn[w] = nodes[w]->out_connects;
+		    curidx[w] = 0;
+		    continue;
+		}
+
+		// All arcs out of v are done
+
+		csp--;
+		if (csp > 0) {
+		    w = callstack[csp - 1];
+		    if (lowlink[v] < lowlink[w]) lowlink[w] = lowlink[v];
+		}
+		if (lowlink[v] != order[v]) continue;
+
+		// v is the root of a strongly connected component.  The
+		// components are found in reverse topological order.
+
+		first = sp;
+		do {
+		    w = stack[--first];
+		    onstack[w] = 0;
+		} while (w != v);
+
+		// Find the arcs inside the component and choose one to
+		// cut.  A component of one gate is a loop only if the
+		// gate drives one of its own inputs.
+
+		for (i = first; i < sp; i++) nodes[stack[i]]->flags |= CONE_INST;
+		cutconn = NULL;
+		for (i = first; i < sp; i++) {
+		    testinst = nodes[stack[i]];
+		    for (testconn = testinst->in_connects; testconn;
+				testconn = testconn->next) {
+			if (testconn->flags & CONN_BROKEN) continue;
+			if ((testconn->refnet == NULL) ||
+				(testconn->refnet->driver == NULL) ||
+				(testconn->refnet->driver->refinst == NULL))
+			    continue;
+			if (!(testconn->refnet->driver->refinst->flags & CONE_INST))
+			    continue;
+			if ((cutconn == NULL) ||
+				((testconn->flags & CONN_PREFER) &&
+				!(cutconn->flags & CONN_PREFER)) ||
+				(((testconn->flags & CONN_PREFER) ==
+				(cutconn->flags & CONN_PREFER)) &&
+				(compconnname(testconn, cutconn) < 0)))
+			    cutconn = testconn;
+		    }
+		}
+		for (i = first; i < sp; i++) nodes[stack[i]]->flags &= ~CONE_INST;
+
+		if (cutconn != NULL) {
+		    fprintf(stdout, "Combinational loop through %d gate%s:", sp - first,
+				(sp - first == 1) ? "" : "s");
+		    for (i = sp - 1; i >= first; i--)
+			fprintf(stdout, " %s", nodes[stack[i]]->name);
+		    fprintf(stdout, "\n   Loop broken at %s/%s\n",
+				cutconn->refinst->name, cutconn->refpin->name);
+		    cutconn->flags |= CONN_BROKEN;
+		    numloops++;
+		}
+		for (i = sp - 1; i >= first; i--)
+		    toporder[numnodes - 1 - numscc++] = nodes[stack[i]];
+		sp = first;
+	    }
+	}
+	total += numloops;
+    } while (numloops > 0);
+
+    for (n = 0; n < numnodes; n++)
+	toporder[n]->index = n;
+
+    free(nodes);
+    free(order);
+    free(lowlink);
+    free(stack);
+    free(callstack);
+    free(curidx);
+    free(curconn);
+    free(onstack);
+
+    if (total > 0) fflush(stdout);
+    return total;
+}
+
+/*--------------------------------------------------------------*/
+/* Delay comparison used by qsort() to sort paths in order from	*/
+/* longest to shortest propagation delay.			*/
+/*--------------------------------------------------------------*/
+
+int
+compdelay(ddataptr *a, ddataptr *b)
+{
+    ddataptr p = *a;
+    ddataptr q = *b;
+
+    if (p->delay < q->delay)
+	return (1);
+    if (p->delay > q->delay)
+	return (-1);
+    return (0);
+}
+
+/*--------------------------------------------------------------*/
+/* Delay comparison used by qsort() to sort paths in order from	*/
+/* shortest to longest propagation delay.			*/
+/*--------------------------------------------------------------*/
+
+int
+compmindelay(ddataptr *a, ddataptr *b)
+{
+    ddataptr p = *a;
+    ddataptr q = *b;
+
+    if (p->delay > q->delay)
+	return (1);
+    if (p->delay < q->delay)
+	return (-1);
+    return (0);
+}
+
+/*--------------------------------------------------------------*/
+/* Return the load on edge "e" of net "loadnet" driven through	*/
+/* a pin with transition time table "ttable", for the input	*/
+/* transition time "slew" on one path:  The effective		*/
+/* capacitance at that slew if the net has a pi model, or the	*/
+/* total load.  This is the load at which computeLoads()	*/
+/* collapsed the tables, but for the slew on the path, not the	*/
+/* middle of the table.						*/
+/*--------------------------------------------------------------*/
+
+double pba_load(netptr loadnet, short e, lutableptr ttable, double slew)
+{
+    if (loadnet->rpi < 0.0)
+	return (e == 0) ? loadnet->loadr : loadnet->loadf;
+    if ((ttable == NULL) || (ttable->size1 < 1) || (loadnet->driver == NULL) ||
+		(loadnet->driver->refinst == NULL))
+	return loadnet->ceff[e];
+    return effective_cap(loadnet, e, ttable, slew);
+}
+
+/*--------------------------------------------------------------*/
+/* Path-based versions of calc_prop_delay() and			*/
+/* calc_transition():  The same delay or transition time of	*/
+/* receiver "testconn" driving "loadnet", but read from the	*/
+/* full tables at the load from pba_load(), and with the delay	*/
+/* derated by "derate", in place of the vectors collapsed by	*/
+/* computeLoads().						*/
+/*--------------------------------------------------------------*/
+
+double pba_prop_delay(double trans, connptr testconn, short sense, char minmax,
+		netptr loadnet, double derate)
+{
+    pinptr testpin;
+    lutableptr rtable, ftable;
+    double propdelayr, propdelayf;
+
+    propdelayr = 0.0;
+    propdelayf = 0.0;
+
+    testpin = testconn->refpin;
+    if (testpin == NULL) return 0.0;
+
+    rtable = testpin->propdelr;
+    ftable = testpin->propdelf;
+    if ((minmax != MAXIMUM_TIME) && (testpin->minpropdelr != NULL)) {
+	rtable = testpin->minpropdelr;
+	ftable = testpin->minpropdelf;
+    }
+
+    if (sense != SENSE_NEGATIVE) {
+	if (rtable)
+	    propdelayr = fixed_time(derate * binomial_get_value(rtable,
+			trans, pba_load(loadnet, 0, testpin->transr, trans)));
+	if (sense == SENSE_POSITIVE) return propdelayr;
+    }
+
+    if (sense != SENSE_POSITIVE) {
+	if (ftable)
+	    propdelayf = fixed_time(derate * binomial_get_value(ftable,
+			trans, pba_load(loadnet, 1, testpin->transf, trans)));
+	if (sense == SENSE_NEGATIVE) return propdelayf;
+    }
+
+    if (minmax == MAXIMUM_TIME)
+	return (propdelayr > propdelayf) ? propdelayr : propdelayf;
+    else
+	return (propdelayr < propdelayf) ? propdelayr : propdelayf;
+}
+
+double pba_transition(double trans, connptr testconn, short sense, char minmax,
+		netptr loadnet)
+{
+    pinptr testpin;
+    lutableptr rtable, ftable;
+    double transr, transf;
+
+    testpin = testconn->refpin;
+    if (testpin == NULL) return 0.0;
+
+    transr = 0.0;
+    transf = 0.0;
+
+    rtable = testpin->transr;
+    ftable = testpin->transf;
+    if ((minmax != MAXIMUM_TIME) && (testpin->mintransr != NULL)) {
+	rtable = testpin->mintransr;
+	ftable = testpin->mintransf;
+    }
+
+    if (sense != SENSE_NEGATIVE) {
+	if (rtable)
+	    transr = binomial_get_value(rtable, trans,
+			pba_load(loadnet, 0, testpin->transr, trans));
+	if (sense == SENSE_POSITIVE) return transr;
+    }
+
+    if (sense != SENSE_POSITIVE) {
+	if (ftable)
+	    transf = binomial_get_value(ftable, trans,
+			pba_load(loadnet, 1, testpin->transf, trans));
+	if (sense == SENSE_NEGATIVE) return transf;
+    }
+
+    if (minmax == MAXIMUM_TIME)
+	return (transr > transf) ? transr : transf;
+    else
+	return (transr < transf) ? transr : transf;
+}
+
+/*--------------------------------------------------------------*/
+/* Thread worker for report_pba():  Re-time paths "start" to	*/
+/* "end" - 1 along their backtraces, from the start point's	*/
+/* delay and transition time, following the same edges.  Each	*/
+/* gate's delay is found at the transition time arriving on	*/
+/* the path.  Where the graph-based search took the load of a	*/
+/* pi model net at an assumed slew, and the AOCV derate at the	*/
+/* shortest logic depth through the gate, the path's own slew	*/
+/* and logic depth are used.  The clock skew and setup or hold	*/
+/* time at the end of the path are kept from the graph-based	*/
+/* search.							*/
+/*--------------------------------------------------------------*/
+
+void pba_worker(void *data, int start, int end, int thread)
+{
+    pbadata *pd = (pbadata *)data;
+    ddataptr testddata;
+    btptr testbt, *path;
+    connptr testconn;
+    instptr testinst;
+    cellptr testcell;
+    netptr loadnet;
+    double delay, trans, derate;
+    int n, i, len, depth;
+
+    for (n = start; n < end; n++) {
+	testddata = pd->paths[n];
+
+	len = 0;
+	for (testbt = testddata->backtrace; testbt; testbt = testbt->next) len++;
+	path = (btptr *)malloc(len * sizeof(btptr));
+	i = len;
+	depth = 0;
+	for (testbt = testddata->backtrace; testbt; testbt = testbt->next) {
+	    path[--i] = testbt;
+	    testinst = testbt->receiver->refinst;
+	    if ((testbt != testddata->backtrace) && (testinst != NULL))
+		depth++;
+	}
+
+	delay = path[0]->delay;
+	trans = path[0]->trans;
+	for (i = 0; i < len - 1; i++) {
+	    testconn = path[i]->receiver;
+	    testinst = testconn->refinst;
+	    loadnet = (testinst) ? testinst->out_connects->refnet : testconn->refnet;
+
+	    derate = 1.0;
+	    if (testinst != NULL) {
+		testcell = testinst->refcell;
+		if (pd->minmax == MAXIMUM_TIME)
+		    derate = (testcell->late > 0.0) ? testcell->late : derate_late;
+		else
+		    derate = (testcell->early > 0.0) ? testcell->early : derate_early;
+		if (aocv != NULL)
+		    derate *= aocv_derate((pd->minmax == MAXIMUM_TIME) ? aocv->late :
+				aocv->early, depth);
+	    }
+
+	    delay += pba_prop_delay(trans, testconn, path[i + 1]->dir, pd->minmax,
+			loadnet, derate);
+	    trans = pba_transition(trans, testconn, path[i + 1]->dir, pd->minmax,
+			loadnet);
+	    delay += path[i + 1]->receiver->wiredelay;
+	}
+	pd->delay[n] = testddata->delay + delay - testddata->backtrace->delay;
+	free(path);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Re-time the worst "pbapaths" paths in "pathlist" by path-	*/
+/* based analysis (see pba_worker()), in parallel, and report	*/
+/* the graph-based and path-based slack of each (or the delay,	*/
+/* for maximum delay paths with no clock "period").		*/
+/*--------------------------------------------------------------*/
+
+void report_pba(ddataptr pathlist, char minmax, double period)
+{
+    ddataptr testddata;
+    pbadata pd;
+    double gbaslack, pbaslack, gbawns, pbawns;
+    char hasslack;
+    int i, n;
+
+    n = 0;
+    for (testddata = pathlist; testddata; testddata = testddata->next) n++;
+    if ((pbapaths <= 0) || (n == 0)) return;
+
+    pd.paths = (ddataptr *)malloc(n * sizeof(ddataptr));
+    n = 0;
+    for (testddata = pathlist; testddata; testddata = testddata->next)
+	pd.paths[n++] = testddata;
+    qsort(pd.paths, n, sizeof(ddataptr), (minmax == MAXIMUM_TIME) ?
+		(__compar_fn_t)compdelay : (__compar_fn_t)compmindelay);
+    if (n > pbapaths) n = pbapaths;
+
+    pd.delay = (double *)malloc(n * sizeof(double));
+    pd.minmax = minmax;
+    run_parallel(n, pba_worker, (void *)&pd);
+
+    hasslack = ((minmax == MINIMUM_TIME) || (period > 0.0)) ? 1 : 0;
+    fprintf(stdout, "\nPath-based analysis of the top %d %s delay path%s:\n", n,
+		(minmax == MAXIMUM_TIME) ? "maximum" : "minimum", (n == 1) ? "" : "s");
+
+    gbawns = pbawns = 1E50;
+    for (i = 0; i < n; i++) {
+	testddata = pd.paths[i];
+	print_path_ends(testddata);
+	if (hasslack) {
+	    gbaslack = path_slack(testddata, minmax, period);
+	    if (minmax == MAXIMUM_TIME)
+		pbaslack = gbaslack - (pd.delay[i] - testddata->delay);
+	    else
+		pbaslack = gbaslack + (pd.delay[i] - testddata->delay);
+	    if (gbaslack < gbawns) gbawns = gbaslack;
+	    if (pbaslack < pbawns) pbawns = pbaslack;
+	    fprintf(stdout, "   GBA slack = %g ps   PBA slack = %g ps\n",
+			gbaslack, pbaslack);
+	}
+	else
+	    fprintf(stdout, "   GBA delay = %g ps   PBA delay = %g ps\n",
+			testddata->delay, pd.delay[i]);
+    }
+    if (hasslack && (n > 0))
+	fprintf(stdout, "Worst slack:  GBA %g ps, PBA %g ps\n", gbawns, pbawns);
+
+    free(pd.delay);
+    free(pd.paths);
+}
+
+/*--------------------------------------------------------------*/
+/* Comparison used by qsort() to sort design rule violations	*/
+/* from worst to best (by the ratio of value to limit).		*/
+/*--------------------------------------------------------------*/
+
+int
+compdrc(drcptr a, drcptr b)
+{
+    double ra = a->value / a->limit;
+    double rb = b->value / b->limit;
+
+    if (ra < rb)
+	return (1);
+    if (ra > rb)
+	return (-1);
+    return (0);
+}
+
+/*--------------------------------------------------------------*/
+/* Report maximum load and maximum transition time design rule	*/
+/* violations.  Loads are checked against the "maxcap" of the	*/
+/* driving cell.  Transition times are the worst recorded on	*/
+/* each net by compute_arrival_times(), and are checked		*/
+/* against the smallest "maxtrans" of the driving and		*/
+/* receiving cells.  Nets driven by module inputs have no	*/
+/* driving cell, and only the receivers' limits apply.  The	*/
+/* sorted list is written to stdout, and, if "fdrc" is not	*/
+/* NULL, to "fdrc" as tab-separated records.			*/
+/*								*/
+/* Return the number of violations found.			*/
+/*--------------------------------------------------------------*/
+
+int report_drc(netptr netlist, FILE *fdrc)
+{
+    netptr testnet;
+    connptr driver;
+    cellptr testcell, drvcell;
+    drcviol *drclist;
+    drcptr testdrc;
+    double load, limit;
+    int i, numdrc, maxdrc;
+    char *typename, *units;
+
+    numdrc = 0;
+    maxdrc = 16;
+    drclist = (drcviol *)malloc(maxdrc * sizeof(drcviol));
+
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	driver = testnet->driver;
+	if (driver == NULL) continue;
+	drvcell = (driver->refinst) ? driver->refinst->refcell : NULL;
+
+	if (numdrc + 2 > maxdrc) {
+	    maxdrc <<= 1;
+	    drclist = (drcviol *)realloc(drclist, maxdrc * sizeof(drcviol));
+	}
+
+	// Maximum load check
+	load = (testnet->loadr > testnet->loadf) ? testnet->loadr : testnet->loadf;
+	limit = (drvcell) ? drvcell->maxcap : 0.0;
+	if ((limit > 0.0) && (load > limit)) {
+	    testdrc = drclist + numdrc++;
+	    testdrc->net = testnet;
+	    testdrc->type = DRC_MAXCAP;
+	    testdrc->value = load;
+	    testdrc->limit = limit;
+	}
+
+	// Maximum transition time check
+	limit = (drvcell) ? drvcell->maxtrans : 0.0;
+	for (i = 0; i < testnet->fanout; i++) {
+	    if (testnet->receivers[i]->refinst == NULL) continue;
+	    testcell = testnet->receivers[i]->refinst->refcell;
+	    if ((testcell->maxtrans > 0.0) && ((limit <= 0.0) ||
+			(testcell->maxtrans < limit)))
+		limit = testcell->maxtrans;
+	}
+	if ((limit > 0.0) && (testnet->slew > limit)) {
+	    testdrc = drclist + numdrc++;
+	    testdrc->net = testnet;
+	    testdrc->type = DRC_MAXTRANS;
+	    testdrc->value = testnet->slew;
+	    testdrc->limit = limit;
+	}
+    }
+
+    qsort(drclist, numdrc, sizeof(drcviol), (__compar_fn_t)compdrc);
+
+    if (numdrc == 0)
+	fprintf(stdout, "No maximum load or transition time violations.\n");
+    else
+	fprintf(stdout, "%d maximum load and transition time violations:\n", numdrc);
+
+    if (fdrc != NULL)
+	fprintf(fdrc, "# type\tnet\tdriver\tvalue\tlimit\n");
+
+    for (i = 0; i < numdrc; i++) {
+	testdrc = drclist + i;
+	driver = testdrc->net->driver;
+	typename = (testdrc->type == DRC_MAXCAP) ? "max_capacitance" : "max_transition";
+	units = (testdrc->type == DRC_MAXCAP) ? "fF" : "ps";
+
+	fprintf(stdout, "   %s on net %s (%s/%s): %g %s > %g %s\n",
+		typename, testdrc->net->name, driver->refinst->name,
+		driver->refpin->name, testdrc->value, units, testdrc->limit, units);
+	if (fdrc != NULL)
+	    fprintf(fdrc, "%s\t%s\t%s/%s\t%g\t%g\n", typename,
+			testdrc->net->name, driver->refinst->name,
+			driver->refpin->name, testdrc->value, testdrc->limit);
+    }
+    fprintf(stdout, "-----------------------------------------\n\n");
+    fflush(stdout);
+
+    free(drclist);
+    return numdrc;
+}
+
+/*--------------------------------------------------------------*/
+/* Set the arrival times at the output "loadnet" of latch	*/
+/* "testinst", which has been given its enable-to-output delay	*/
+/* by compute_arrival_times().  The latch opens at "opentime",	*/
+/* and if data arrives while it is open (it borrows time), the	*/
+/* output follows the data through the data-to-output arc.	*/
+/*--------------------------------------------------------------*/
+
+void latch_output_arrival(instptr testinst, netptr loadnet)
+{
+    connptr dconn;
+    double delay, trans;
+    int o;
+
+    for (o = 0; o < 2; o++) {
+	if (loadnet->arrival[o] <= -1E50) continue;
+	loadnet->arrival[o] += testinst->opentime;
+	loadnet->minarrival[o] += testinst->opentime;
+    }
+
+    dconn = find_latch_data(testinst);
+    if ((dconn == NULL) || (testinst->borrow <= 0.0)) return;
+
+    for (o = 0; o < 2; o++) {
+	delay = testinst->opentime + testinst->borrow + calc_prop_delay(testinst->dtrans,
+			dconn, (o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+	trans = calc_transition(testinst->dtrans, dconn,
+			(o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+	if (trans > loadnet->slew) loadnet->slew = trans;
+	if (delay > loadnet->arrival[o]) {
+	    loadnet->arrival[o] = delay;
+	    loadnet->atrans[o] = trans;
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Clear the arrival times of all nets in "netlist", so that	*/
+/* no edge arrives on any net, and the worst transition times.	*/
+/*--------------------------------------------------------------*/
+
+void clear_arrival_times(netptr netlist)
+{
+    netptr testnet;
+    int e;
+
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	for (e = 0; e < 2; e++) {
+	    testnet->arrival[e] = -1E50;
+	    testnet->minarrival[e] = 1E50;
+	    testnet->atrans[e] = testnet->mintrans[e] = 0.0;
+	}
+	testnet->slew = 0.0;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Set the arrival times at the outputs of register "testinst"	*/
+/* at the clock-to-output delay after an ideal clock edge at	*/
+/* its launch time (see compute_launch_times()), or for		*/
+/* latches, at the times set by latch_output_arrival().		*/
+/*--------------------------------------------------------------*/
+
+void register_arrival_times(instptr testinst)
+{
+    netptr loadnet;
+    connptr clkconn, outconn;
+    short outdir, dir;
+    int e, o;
+
+    clkconn = find_register_clock(testinst);
+    for (outconn = testinst->out_connects; outconn; outconn = outconn->next) {
+	loadnet = outconn->refnet;
+	if (loadnet == NULL) continue;
+	if (clkconn == NULL) {
+	    for (e = 0; e < 2; e++)
+		loadnet->arrival[e] = loadnet->minarrival[e] = 0.0;
+	    continue;
+	}
+	dir = register_edge(testinst);
+	outdir = calc_dir(clkconn->refpin, dir);
+	for (o = 0; o < 2; o++) {
+	    if (!(outdir & ((o == 0) ? RISING : FALLING))) continue;
+	    loadnet->arrival[o] = calc_prop_delay(0.0, clkconn,
+			(o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+	    loadnet->atrans[o] = calc_transition(0.0, clkconn,
+			(o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+	    if (loadnet->atrans[o] > loadnet->slew)
+		loadnet->slew = loadnet->atrans[o];
+	    loadnet->minarrival[o] = calc_prop_delay(0.0, clkconn,
+			(o == 0) ? RISING : FALLING, MINIMUM_TIME);
+	    loadnet->mintrans[o] = calc_transition(0.0, clkconn,
+			(o == 0) ? RISING : FALLING, MINIMUM_TIME);
+	}
+	if (testinst->refcell->type & LATCH)
+	    latch_output_arrival(testinst, loadnet);
+	else {
+	    for (o = 0; o < 2; o++) {
+		if (loadnet->arrival[o] > -1E50)
+		    loadnet->arrival[o] += testinst->opentime;
+		if (loadnet->minarrival[o] < 1E50)
+		    loadnet->minarrival[o] += testinst->opentime;
+	    }
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Propagate the arrival times already set on the nets through	*/
+/* the gates, in topological order, keeping the latest and	*/
+/* earliest arrivals of each edge on each gate output.  The	*/
+/* worst transition time of every latest arrival on a net,	*/
+/* whether kept or not, goes in its "slew" for report_drc().	*/
+/*--------------------------------------------------------------*/
+
+void propagate_arrival_times()
+{
+    netptr testnet, loadnet;
+    instptr testinst;
+    connptr testconn;
+    double delay, trans;
+    short outdir;
+    int e, o, n;
+
+    for (n = 0; n < numtoporder; n++) {
+	testinst = toporder[n];
+	loadnet = testinst->out_connects->refnet;
+	if (loadnet == NULL) continue;
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    if (testconn->refnet == NULL) continue;
+	    if (testconn->flags & CONN_BROKEN) continue;
+	    testnet = testconn->refnet;
+	    for (e = 0; e < 2; e++) {
+		if (testnet->arrival[e] <= -1E50) continue;
+		outdir = calc_dir(testconn->refpin, (e == 0) ? RISING : FALLING);
+		for (o = 0; o < 2; o++) {
+		    if (!(outdir & ((o == 0) ? RISING : FALLING))) continue;
+
+		    delay = testnet->arrival[e] + testconn->wiredelay +
+			calc_prop_delay(testnet->atrans[e], testconn,
+			(o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+		    trans = calc_transition(testnet->atrans[e], testconn,
+			(o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+		    if (trans > loadnet->slew) loadnet->slew = trans;
+		    if (delay > loadnet->arrival[o]) {
+			loadnet->arrival[o] = delay;
+			loadnet->atrans[o] = trans;
+		    }
+
+		    delay = testnet->minarrival[e] + testconn->wiredelay +
+			calc_prop_delay(testnet->mintrans[e], testconn,
+			(o == 0) ? RISING : FALLING, MINIMUM_TIME);
+		    trans = calc_transition(testnet->mintrans[e], testconn,
+			(o == 0) ? RISING : FALLING, MINIMUM_TIME);
+		    if (delay < loadnet->minarrival[o]) {
+			loadnet->minarrival[o] = delay;
+			loadnet->mintrans[o] = trans;
+		    }
+		}
+	    }
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Compute the latest and earliest arrival time of each edge	*/
+/* on every net, by one forward pass over the gates in		*/
+/* topological order.  Paths start at module inputs (at time	*/
+/* zero) and at register outputs (see register_arrival_times()).	*/
+/* Unlike find_path_delay(), which follows each path from its	*/
+/* start, this keeps only the worst arrivals on each net, with	*/
+/* the transition time at each.					*/
+/*--------------------------------------------------------------*/
+
+void compute_arrival_times(netptr netlist, instptr instlist)
+{
+    netptr testnet;
+    instptr testinst;
+    int e;
+
+    clear_arrival_times(netlist);
+    for (testnet = netlist; testnet; testnet = testnet->next)
+	if ((testnet->driver == NULL) || (testnet->driver->refinst == NULL))
+	    for (e = 0; e < 2; e++)
+		testnet->arrival[e] = testnet->minarrival[e] = 0.0;
+
+    for (testinst = instlist; testinst; testinst = testinst->next)
+	if (testinst->index < 0)
+	    register_arrival_times(testinst);
+
+    propagate_arrival_times();
+}
+
+/*--------------------------------------------------------------*/
+/* Return the clock input of the gate with clock gating input	*/
+/* "gateconn":  The input that is on the clock network and is	*/
+/* not itself a gating input.					*/
+/*--------------------------------------------------------------*/
+
+connptr gating_clock(connptr gateconn)
+{
+    connptr testconn;
+
+    for (testconn = gateconn->refinst->in_connects; testconn; testconn = testconn->next) {
+	if (testconn == gateconn) continue;
+	if (testconn->flags & (CONN_GATE_HIGH | CONN_GATE_LOW | CONN_BROKEN)) continue;
+	if ((testconn->refnet != NULL) && (testconn->refnet->type & (CLOCK | ENABLE)))
+	    return testconn;
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the time required at clock gating input "gateconn"	*/
+/* for setup (the latest time, if "minmax" is MAXIMUM_TIME) or	*/
+/* hold (the earliest time), for a path launched at time zero	*/
+/* and a clock period "treq".  The gating input must not change	*/
+/* while the clock at the gate is high (CONN_GATE_HIGH) or low	*/
+/* (CONN_GATE_LOW).  It must settle before the next edge that	*/
+/* starts that phase, at the earliest clock arrival, and must	*/
+/* hold until the edge that ends the phase before it, at the	*/
+/* latest clock arrival.  The arrivals are those computed by	*/
+/* compute_clock_network(), where an edge from the falling edge	*/
+/* of the clock root is half a period later.  Setup and hold	*/
+/* times at the gate are taken as zero.  With no clock arrival,	*/
+/* return 1E50 (or -1E50), for no requirement.			*/
+/*--------------------------------------------------------------*/
+
+double gating_required(connptr gateconn, double treq, char minmax)
+{
+    connptr clkconn;
+    clkptr clkdata;
+    double topen;
+    short open, close;
+
+    clkconn = gating_clock(gateconn);
+    clkdata = (clkconn != NULL) ? clkconn->refnet->clkdata : NULL;
+    if ((clkdata == NULL) || (clkdata->state != CLK_DONE))
+	return (minmax == MAXIMUM_TIME) ? 1E50 : -1E50;
+
+    open = (gateconn->flags & CONN_GATE_HIGH) ? CLKEDGE(RISING) : CLKEDGE(FALLING);
+    close = 1 - open;
+    if ((clkdata->srcdir[open] == 0) || (clkdata->srcdir[close] == 0))
+	return (minmax == MAXIMUM_TIME) ? 1E50 : -1E50;
+
+    topen = (clkdata->srcdir[open] == FALLING) ? 0.5 * treq : treq;
+    if (minmax == MAXIMUM_TIME)
+	return topen + clkdata->mindelay[open] + clkconn->wiredelay;
+    else
+	return topen - 0.5 * treq + clkdata->maxdelay[close] + clkconn->wiredelay;
+}
+
+/*--------------------------------------------------------------*/
+/* Set the times at which each edge must arrive at receiver	*/
+/* "testconn" to meet setup ("required", the latest time) and	*/
+/* hold ("minrequired", the earliest time).  "treq" is the	*/
+/* setup time required at path ends;  hold is checked against	*/
+/* the same clock edge that launched the path.  A register data	*/
+/* input requires the setup time before "treq" and the hold	*/
+/* time after the clock edge.  A gate input requires the gate	*/
+/* delay before the times required on the gate output, and a	*/
+/* clock gating input also requires the times set by		*/
+/* gating_required().  A set or reset input requires the	*/
+/* recovery and removal times.  Other receivers (clock inputs	*/
+/* and broken loops) have no requirement, and are set to 1E50	*/
+/* and -1E50.							*/
+/*--------------------------------------------------------------*/
+
+void receiver_required(connptr testconn, double treq)
+{
+    pinptr testpin;
+    netptr testnet, loadnet;
+    double rtime;
+    short outdir, dir;
+    int e, o;
+
+    testpin = testconn->refpin;
+    testnet = testconn->refnet;
+
+    for (e = 0; e < 2; e++) {
+	testconn->required[e] = 1E50;
+	testconn->minrequired[e] = -1E50;
+	dir = (e == 0) ? RISING : FALLING;
+
+	if (testpin == NULL) {			// Module output
+	    testconn->required[e] = treq;
+	    testconn->minrequired[e] = 0.0;
+	    continue;
+	}
+	if (testconn->flags & CONN_BROKEN) continue;
+	if (testpin->type & (DFFIN | LATCHIN)) {
+	    testconn->required[e] = ((testpin->type & LATCHIN) ?
+			latch_close_time(testconn->refinst, treq) : treq) -
+			calc_setup_time(testnet->atrans[e],
+			testpin, 0.0, dir, MAXIMUM_TIME);
+	    testconn->minrequired[e] = calc_hold_time(testnet->mintrans[e],
+			testpin, 0.0, dir, MINIMUM_TIME);
+	    continue;
+	}
+	if (testpin->type & (DFFSET | DFFRST)) {
+	    if (e != async_release_edge(testconn)) continue;
+	    testconn->required[e] = treq - calc_recovery_time(testnet->atrans[e],
+			testpin, 0.0, MAXIMUM_TIME);
+	    testconn->minrequired[e] = calc_recovery_time(testnet->mintrans[e],
+			testpin, 0.0, MINIMUM_TIME);
+	    continue;
+	}
+	if (testconn->flags & (CONN_GATE_HIGH | CONN_GATE_LOW)) {
+	    testconn->required[e] = gating_required(testconn, treq, MAXIMUM_TIME);
+	    testconn->minrequired[e] = gating_required(testconn, treq, MINIMUM_TIME);
+	}
+	if ((testconn->refinst == NULL) || (testconn->refinst->index < 0)) continue;
+
+	loadnet = testconn->refinst->out_connects->refnet;
+	if (loadnet == NULL) continue;
+
+	outdir = calc_dir(testpin, dir);
+	for (o = 0; o < 2; o++) {
+	    if (!(outdir & ((o == 0) ? RISING : FALLING))) continue;
+	    if (loadnet->required[o] < 1E50) {
+		rtime = loadnet->required[o] - calc_prop_delay(testnet->atrans[e],
+			testconn, (o == 0) ? RISING : FALLING, MAXIMUM_TIME);
+		if (rtime < testconn->required[e]) testconn->required[e] = rtime;
+	    }
+	    if (loadnet->minrequired[o] > -1E50) {
+		rtime = loadnet->minrequired[o] - calc_prop_delay(testnet->mintrans[e],
+			testconn, (o == 0) ? RISING : FALLING, MINIMUM_TIME);
+		if (rtime > testconn->minrequired[e]) testconn->minrequired[e] = rtime;
+	    }
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Set the required times of each edge on net "testnet" and on	*/
+/* each of its receivers.  The nets driven by the receivers	*/
+/* must have their required times set already.			*/
+/*--------------------------------------------------------------*/
+
+void net_required(netptr testnet, double treq)
+{
+    connptr testconn;
+    double rtime;
+    int e, i;
+
+    for (e = 0; e < 2; e++) {
+	testnet->required[e] = 1E50;
+	testnet->minrequired[e] = -1E50;
+    }
+    for (i = 0; i < testnet->fanout; i++) {
+	testconn = testnet->receivers[i];
+	receiver_required(testconn, treq);
+	for (e = 0; e < 2; e++) {
+	    if (testnet->arrival[e] <= -1E50) continue;
+	    rtime = testconn->required[e] - testconn->wiredelay;
+	    if ((testconn->required[e] < 1E50) && (rtime < testnet->required[e]))
+		testnet->required[e] = rtime;
+	    rtime = testconn->minrequired[e] - testconn->wiredelay;
+	    if ((testconn->minrequired[e] > -1E50) && (rtime > testnet->minrequired[e]))
+		testnet->minrequired[e] = rtime;
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Compute the setup and hold required times of each edge on	*/
+/* every net and at every receiver, by one backward pass over	*/
+/* the gates in topological order, after			*/
+/* compute_arrival_times().  Path ends are required at the	*/
+/* clock period "period", or if there is no period, at the	*/
+/* latest path end arrival, so that the worst slack is zero.	*/
+/*								*/
+/* Return the latest path end arrival (the critical delay).	*/
+/*--------------------------------------------------------------*/
+
+double compute_required_times(netptr netlist, double period)
+{
+    netptr testnet, loadnet;
+    connptr testconn;
+    instptr drvinst;
+    double dmax, treq, rtime;
+    int e, i, n;
+
+    // Find the latest arrival at a path end, including setup time,
+    // as the difference between the time the path end needs and the
+    // time required there.
+
+    dmax = 0.0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	for (i = 0; i < testnet->fanout; i++) {
+	    testconn = testnet->receivers[i];
+	    if ((testconn->refpin != NULL) &&
+			!(testconn->refpin->type & (DFFIN | LATCHIN | DFFSET | DFFRST)))
+		continue;
+	    receiver_required(testconn, 0.0);
+	    for (e = 0; e < 2; e++) {
+		if (testnet->arrival[e] <= -1E50) continue;
+		rtime = testnet->arrival[e] + testconn->wiredelay - testconn->required[e];
+		if (rtime > dmax) dmax = rtime;
+	    }
+	}
+    }
+    treq = (period > 0.0) ? period : dmax;
+
+    for (n = numtoporder - 1; n >= 0; n--) {
+	loadnet = toporder[n]->out_connects->refnet;
+	if (loadnet != NULL) net_required(loadnet, treq);
+    }
+
+    // Nets driven by module inputs and registers
+
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	drvinst = (testnet->driver) ? testnet->driver->refinst : NULL;
+	if ((drvinst == NULL) || (drvinst->index < 0))
+	    net_required(testnet, treq);
+    }
+    return dmax;
+}
+
+/*--------------------------------------------------------------*/
+/* Comparisons used by qsort() to sort recovery and removal	*/
+/* checks from worst to best slack.				*/
+/*--------------------------------------------------------------*/
+
+int
+comprecovery(asyncptr a, asyncptr b)
+{
+    if (a->slack > b->slack)
+	return (1);
+    if (a->slack < b->slack)
+	return (-1);
+    return (0);
+}
+
+int
+compremoval(asyncptr a, asyncptr b)
+{
+    if (a->minslack > b->minslack)
+	return (1);
+    if (a->minslack < b->minslack)
+	return (-1);
+    return (0);
+}
+
+/*--------------------------------------------------------------*/
+/* Check the asynchronous set and reset inputs of flops against	*/
+/* their recovery and removal times.  The release of a set or	*/
+/* reset must reach the flop by the recovery time before the	*/
+/* next clock edge (one "period" after the launch), and no	*/
+/* sooner than the removal time after the launching edge.  The	*/
+/* arrival times come from one levelized pass of		*/
+/* compute_arrival_times(), which times the reset networks along	*/
+/* with everything else, so each check adds only the lookups at	*/
+/* its own pin.  Recovery is checked only if there is a clock	*/
+/* period.  The worst "maxpaths" checks of each kind are	*/
+/* written to stdout.						*/
+/*								*/
+/* Return the number of pins checked.  If nonzero, the arrival	*/
+/* times on all nets are left set.				*/
+/*--------------------------------------------------------------*/
+
+int check_async_timing(netptr netlist, instptr instlist, double period)
+{
+    netptr testnet;
+    connptr testconn;
+    asyncchk *chklist;
+    asyncptr testchk;
+    double wns, tns;
+    int i, e, n, numchk, numfail;
+
+    numchk = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->type & ASYNC)) continue;
+	for (i = 0; i < testnet->fanout; i++) {
+	    testconn = testnet->receivers[i];
+	    if (testconn->refpin && (testconn->refpin->type & (DFFSET | DFFRST)))
+		numchk++;
+	}
+    }
+    if (numchk == 0) return 0;
+
+    compute_arrival_times(netlist, instlist);
+
+    chklist = (asyncchk *)malloc(numchk * sizeof(asyncchk));
+    n = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->type & ASYNC)) continue;
+	for (i = 0; i < testnet->fanout; i++) {
+	    testconn = testnet->receivers[i];
+	    if (!testconn->refpin || !(testconn->refpin->type & (DFFSET | DFFRST)))
+		continue;
+	    e = async_release_edge(testconn);
+	    if (testnet->arrival[e] <= -1E50) continue;
+	    receiver_required(testconn, period);
+	    testchk = chklist + n++;
+	    testchk->conn = testconn;
+	    testchk->edge = e;
+	    testchk->slack = testconn->required[e] - testnet->arrival[e] -
+			testconn->wiredelay;
+	    testchk->minslack = testnet->minarrival[e] + testconn->wiredelay -
+			testconn->minrequired[e];
+	}
+    }
+
+    numfail = 0;
+    if (period > 0.0) {
+	qsort(chklist, n, sizeof(asyncchk), (__compar_fn_t)comprecovery);
+	wns = tns = 0.0;
+	for (i = 0; i < n; i++) {
+	    if (chklist[i].slack >= 0.0) break;
+	    if (chklist[i].slack < wns) wns = chklist[i].slack;
+	    tns += chklist[i].slack;
+	    numfail++;
+	}
+	fprintf(stdout, "\nRecovery checks:  %d pin%s, WNS = %g ps, TNS = %g ps\n",
+		n, (n == 1) ? "" : "s", wns, tns);
+	for (i = 0; (i < n) && (i < maxpaths); i++) {
+	    testchk = chklist + i;
+	    testconn = testchk->conn;
+	    fprintf(stdout, "Pin %s/%s %s arrival %g ps   Slack = %g ps\n",
+			testconn->refinst->name, testconn->refpin->name,
+			(testchk->edge == 0) ? "rise" : "fall",
+			testconn->refnet->arrival[testchk->edge] + testconn->wiredelay,
+			testchk->slack);
+	}
+    }
+    else
+	fprintf(stderr, "Recovery checks require a clock period (-p).\n");
+
+    qsort(chklist, n, sizeof(asyncchk), (__compar_fn_t)compremoval);
+    wns = tns = 0.0;
+    for (i = 0; i < n; i++) {
+	if (chklist[i].minslack >= 0.0) break;
+	if (chklist[i].minslack < wns) wns = chklist[i].minslack;
+	tns += chklist[i].minslack;
+	numfail++;
+    }
+    fprintf(stdout, "\nRemoval checks:  %d pin%s, WNS = %g ps, TNS = %g ps\n",
+		n, (n == 1) ? "" : "s", wns, tns);
+    for (i = 0; (i < n) && (i < maxpaths); i++) {
+	testchk = chklist + i;
+	testconn = testchk->conn;
+	fprintf(stdout, "Pin %s/%s %s arrival %g ps   Slack = %g ps\n",
+			testconn->refinst->name, testconn->refpin->name,
+			(testchk->edge == 0) ? "rise" : "fall",
+			testconn->refnet->minarrival[testchk->edge] + testconn->wiredelay,
+			testchk->minslack);
+    }
+
+    if (numfail > 0)
+	fprintf(stdout, "ERROR:  Design fails recovery and removal checks.\n");
+    else
+	fprintf(stdout, "Design meets recovery and removal checks.\n");
+    fprintf(stdout, "-----------------------------------------\n\n");
+    fflush(stdout);
+
+    free(chklist);
+    return numchk;
+}
+
+/*--------------------------------------------------------------*/
+/* Comparisons used by qsort() to sort clock gating checks from	*/
+/* worst to best slack.						*/
+/*--------------------------------------------------------------*/
+
+int
+compgatingsetup(gatingptr a, gatingptr b)
+{
+    if (a->slack > b->slack)
+	return (1);
+    if (a->slack < b->slack)
+	return (-1);
+    return (0);
+}
+
+int
+compgatinghold(gatingptr a, gatingptr b)
+{
+    if (a->minslack > b->minslack)
+	return (1);
+    if (a->minslack < b->minslack)
+	return (-1);
+    return (0);
+}
+
+/*--------------------------------------------------------------*/
+/* Check the clock gating inputs found by assign_net_types()	*/
+/* for setup and hold against the clock at the gate (see	*/
+/* gating_required()), for clock "period".  Like the recovery	*/
+/* and removal checks, these use the arrival times of one pass	*/
+/* of compute_arrival_times(), which is made here unless	*/
+/* "arrived" is nonzero.  The worst "maxpaths" checks of each	*/
+/* kind are written to stdout.					*/
+/*								*/
+/* Return the number of pins checked.  If nonzero, the arrival	*/
+/* times on all nets are left set.				*/
+/*--------------------------------------------------------------*/
+
+int check_gating_timing(netptr netlist, instptr instlist, double period, int arrived)
+{
+    netptr testnet;
+    connptr testconn;
+    gatingchk *chklist;
+    gatingptr testchk;
+    double wns, tns, slack, treq, minreq;
+    int i, e, n, numchk, numfail;
+
+    numchk = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->type & GATING)) continue;
+	for (i = 0; i < testnet->fanout; i++)
+	    if (testnet->receivers[i]->flags & (CONN_GATE_HIGH | CONN_GATE_LOW))
+		numchk++;
+    }
+    if (numchk == 0) return 0;
+    if (period <= 0.0) {
+	fprintf(stderr, "Clock gating checks require a clock period (-p).\n");
+	return 0;
+    }
+
+    if (!arrived) compute_arrival_times(netlist, instlist);
+
+    chklist = (gatingchk *)malloc(numchk * sizeof(gatingchk));
+    n = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->type & GATING)) continue;
+	for (i = 0; i < testnet->fanout; i++) {
+	    testconn = testnet->receivers[i];
+	    if (!(testconn->flags & (CONN_GATE_HIGH | CONN_GATE_LOW))) continue;
+	    treq = gating_required(testconn, period, MAXIMUM_TIME);
+	    minreq = gating_required(testconn, period, MINIMUM_TIME);
+	    if (treq >= 1E50) continue;
+	    testchk = chklist + n;
+	    testchk->conn = testconn;
+	    testchk->slack = 1E50;
+	    testchk->minslack = 1E50;
+	    for (e = 0; e < 2; e++) {
+		if (testnet->arrival[e] <= -1E50) continue;
+		slack = treq - testnet->arrival[e] - testconn->wiredelay;
+		if (slack < testchk->slack) {
+		    testchk->slack = slack;
+		    testchk->edge = e;
+		}
+		slack = testnet->minarrival[e] + testconn->wiredelay - minreq;
+		if (slack < testchk->minslack) {
+		    testchk->minslack = slack;
+		    testchk->minedge = e;
+		}
+	    }
+	    if (testchk->slack < 1E50) n++;
+	}
+    }
 
-		    // Note:  Timing type is apparently redundant information;
-		    // e.g., "falling_edge" can be determined by "clocked_on : !CLK"
-		    // in the ff {} block.  How reliable is this?
+    numfail = 0;
+    qsort(chklist, n, sizeof(gatingchk), (__compar_fn_t)compgatingsetup);
+    wns = tns = 0.0;
+    for (i = 0; i < n; i++) {
+	if (chklist[i].slack >= 0.0) break;
+	if (chklist[i].slack < wns) wns = chklist[i].slack;
+	tns += chklist[i].slack;
+	numfail++;
+    }
+    fprintf(stdout, "\nClock gating setup checks:  %d pin%s, WNS = %g ps, TNS = %g ps\n",
+		n, (n == 1) ? "" : "s", wns, tns);
+    for (i = 0; (i < n) && (i < maxpaths); i++) {
+	testchk = chklist + i;
+	testconn = testchk->conn;
+	fprintf(stdout, "Pin %s/%s %s arrival %g ps   Slack = %g ps\n",
+			testconn->refinst->name, testconn->refpin->name,
+			(testchk->edge == 0) ? "rise" : "fall",
+			testconn->refnet->arrival[testchk->edge] + testconn->wiredelay,
+			testchk->slack);
+    }
 
-		    if (!strcasecmp(token, "rising_edge"))
-			timing_type = TIMING_PROP_TRANS;
-		    else if (!strcasecmp(token, "falling_edge"))
-			timing_type = TIMING_PROP_TRANS;
-		    else if (!strcasecmp(token, "hold_rising"))
-			timing_type = TIMING_HOLD;
-		    else if (!strcasecmp(token, "hold_falling"))
-			timing_type = TIMING_HOLD;
-		    else if (!strcasecmp(token, "setup_rising"))
-			timing_type = TIMING_SETUP;
-		    else if (!strcasecmp(token, "setup_falling"))
-			timing_type = TIMING_SETUP;
-		    else if (!strcasecmp(token, "clear"))
-			timing_type = TIMING_SET_RESET;
-		    else if (!strcasecmp(token, "preset"))
-			timing_type = TIMING_SET_RESET;
-		    else if (!strcasecmp(token, "recovery_rising"))
-			timing_type = TIMING_RECOVERY;
-		    else if (!strcasecmp(token, "recovery_falling"))
-			timing_type = TIMING_RECOVERY;
-		    else if (!strcasecmp(token, "removal_rising"))
-			timing_type = TIMING_REMOVAL;
-		    else if (!strcasecmp(token, "removal_falling"))
-			timing_type = TIMING_REMOVAL;
-		    else if (!strcasecmp(token, "three_state_enable"))
-			timing_type = TIMING_TRISTATE;
-		    else if (!strcasecmp(token, "three_state_disable"))
-			timing_type = TIMING_TRISTATE;
+    qsort(chklist, n, sizeof(gatingchk), (__compar_fn_t)compgatinghold);
+    wns = tns = 0.0;
+    for (i = 0; i < n; i++) {
+	if (chklist[i].minslack >= 0.0) break;
+	if (chklist[i].minslack < wns) wns = chklist[i].minslack;
+	tns += chklist[i].minslack;
+	numfail++;
+    }
+    fprintf(stdout, "\nClock gating hold checks:  %d pin%s, WNS = %g ps, TNS = %g ps\n",
+		n, (n == 1) ? "" : "s", wns, tns);
+    for (i = 0; (i < n) && (i < maxpaths); i++) {
+	testchk = chklist + i;
+	testconn = testchk->conn;
+	fprintf(stdout, "Pin %s/%s %s arrival %g ps   Slack = %g ps\n",
+			testconn->refinst->name, testconn->refpin->name,
+			(testchk->minedge == 0) ? "rise" : "fall",
+			testconn->refnet->minarrival[testchk->minedge] + testconn->wiredelay,
+			testchk->minslack);
+    }
+
+    if (numfail > 0)
+	fprintf(stdout, "ERROR:  Design fails clock gating checks.\n");
+    else
+	fprintf(stdout, "Design meets clock gating checks.\n");
+    fprintf(stdout, "-----------------------------------------\n\n");
+    fflush(stdout);
+
+    free(chklist);
+    return numchk;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the time borrowed by each latch, for clock "period"	*/
+/* with a 50% duty cycle, and report it.  A latch opens on its	*/
+/* enable edge and closes half a period later (see		*/
+/* latch_close_time()).  Data arriving while the latch is open	*/
+/* borrows the time past the opening edge, and passes through	*/
+/* to the output, so the borrow of one latch moves the arrival	*/
+/* times at the next.  Each pass is one levelized		*/
+/* compute_arrival_times(), after which the borrows are updated	*/
+/* from the data arrivals;  passes repeat until no borrow	*/
+/* changes, which takes one pass for each latch on the longest	*/
+/* chain of borrowing latches.  Borrowing is limited to the	*/
+/* setup time before the closing edge, and data arriving later	*/
+/* than that is a setup violation.				*/
+/*								*/
+/* Latch outputs are timed from the rising clock edge before	*/
+/* their opening edge, so a latch that opens on the falling	*/
+/* edge starts its paths half a period late.  Latches that are	*/
+/* enabled on the same edge and feed each other directly are	*/
+/* taken to be a full period apart.				*/
+/*								*/
+/* Return the number of latches with a setup violation.		*/
+/*--------------------------------------------------------------*/
+
+int compute_latch_timing(netptr netlist, instptr instlist, double period)
+{
+    instptr testinst, *latches;
+    connptr dconn;
+    netptr dnet;
+    double open, close, limit, arrival, borrow, slack, setup;
+    int i, e, pass, numlatches, numfail, numshown, changed;
+
+    numlatches = 0;
+    for (testinst = instlist; testinst; testinst = testinst->next)
+	if (testinst->refcell->type & LATCH) numlatches++;
+    if (numlatches == 0) return 0;
+    if (period <= 0.0) {
+	fprintf(stderr, "Latch time borrowing requires a clock period (-p).\n");
+	return 0;
+    }
+
+    latches = (instptr *)malloc(numlatches * sizeof(instptr));
+    numlatches = 0;
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	if (!(testinst->refcell->type & LATCH)) continue;
+	latches[numlatches++] = testinst;
+	testinst->borrow = 0.0;
+	testinst->dtrans = 0.0;
+    }
+
+    for (pass = 1; pass <= numlatches + 1; pass++) {
+	compute_arrival_times(netlist, instlist);
+	changed = 0;
+	for (i = 0; i < numlatches; i++) {
+	    testinst = latches[i];
+	    dconn = find_latch_data(testinst);
+	    if ((dconn == NULL) || (dconn->refnet == NULL)) continue;
+	    dnet = dconn->refnet;
+
+	    // The latch opens half a period before it closes, and data
+	    // can arrive up to the setup time before the close.
+
+	    close = latch_close_time(testinst, period);
+	    open = close - 0.5 * period;
+	    limit = close;
+	    arrival = -1E50;
+	    for (e = 0; e < 2; e++) {
+		if (dnet->arrival[e] <= -1E50) continue;
+		setup = calc_setup_time(dnet->atrans[e], dconn->refpin, 0.0,
+			(e == 0) ? RISING : FALLING, MAXIMUM_TIME);
+		if (close - setup < limit) limit = close - setup;
+		if (dnet->arrival[e] + dconn->wiredelay > arrival) {
+		    arrival = dnet->arrival[e] + dconn->wiredelay;
+		    testinst->dtrans = dnet->atrans[e];
 		}
-		else if ((!strcasecmp(token, "cell_rise")) ||
-			(!strcasecmp(token, "cell_fall")) ||
-			(!strcasecmp(token, "rise_transition")) ||
-			(!strcasecmp(token, "fall_transition")) ||
-			(!strcasecmp(token, "rise_constraint")) ||
-			(!strcasecmp(token, "fall_constraint"))) {
+	    }
+	    if (arrival <= -1E50) continue;
 
-		    tableptr = (lutable *)malloc(sizeof(lutable));
-		    tableptr->name = NULL;	// Not used
-		    tableptr->invert = 0;
-		    tableptr->var1 = UNKNOWN;
-		    tableptr->var2 = UNKNOWN;
-		    tableptr->size1 = 0;
-		    tableptr->size2 = 0;
-		    tableptr->idx1.times = NULL;
-		    tableptr->idx2.caps = NULL;
-		    tableptr->values = NULL;
-		    tableptr->next = NULL;	// Not used
+	    borrow = arrival - open;
+	    if (borrow > limit - open) borrow = limit - open;
+	    if (borrow < 0.0) borrow = 0.0;
+	    if (fabs(borrow - testinst->borrow) > 1E-3) changed = 1;
+	    testinst->borrow = borrow;
+	}
+	if (!changed) break;
+    }
 
-		    // Note that propagation delays (cell rise, cell fall) and
-		    // transition times (rise transition, fall transition) have
-		    // their lookup tables stored in the "related pin" pin record.
-		    // Setup and hold times (rise constraint, fall constraint)
-		    // have their lookup tables stored in the original pin record.
-		    // These should not overlap.
+    // Report the latches that borrow time or fail setup
+
+    fprintf(stdout, "Latch time borrowing (%d latch%s, %d pass%s):\n", numlatches,
+		(numlatches == 1) ? "" : "es", pass, (pass == 1) ? "" : "es");
+    numfail = 0;
+    numshown = 0;
+    for (i = 0; i < numlatches; i++) {
+	testinst = latches[i];
+	dconn = find_latch_data(testinst);
+	if ((dconn == NULL) || (dconn->refnet == NULL)) continue;
+	dnet = dconn->refnet;
+	close = latch_close_time(testinst, period);
+	slack = 1E50;
+	for (e = 0; e < 2; e++) {
+	    if (dnet->arrival[e] <= -1E50) continue;
+	    setup = calc_setup_time(dnet->atrans[e], dconn->refpin, 0.0,
+			(e == 0) ? RISING : FALLING, MAXIMUM_TIME);
+	    if (close - setup - dnet->arrival[e] - dconn->wiredelay < slack)
+		slack = close - setup - dnet->arrival[e] - dconn->wiredelay;
+	}
+	if (slack < 0.0) numfail++;
+	if ((testinst->borrow > 0.0) || (slack < 0.0)) {
+	    fprintf(stdout, "   Latch %s:  borrows %g ps, slack %g ps%s\n",
+			testinst->name, testinst->borrow, slack,
+			(slack < 0.0) ? " (VIOLATED)" : "");
+	    numshown++;
+	}
+    }
+    if (numshown == 0)
+	fprintf(stdout, "   No latch borrows time or fails setup.\n");
+    if (numfail > 0)
+	fprintf(stdout, "ERROR:  %d latch%s fail setup at the closing edge.\n",
+		numfail, (numfail == 1) ? "" : "es");
+    fprintf(stdout, "-----------------------------------------\n\n");
+    fflush(stdout);
 
-		    // Recovery and removal tables are not yet handled. . .
+    free(latches);
+    return numfail;
+}
 
-		    if (!strcasecmp(token, "cell_rise"))
-			testpin->propdelr = tableptr;
-		    else if (!strcasecmp(token, "cell_fall"))
-			testpin->propdelf = tableptr;
-		    else if (!strcasecmp(token, "rise_transition"))
-			testpin->transr = tableptr;
-		    else if (!strcasecmp(token, "fall_transition"))
-			testpin->transf = tableptr;
-		    else if (!strcasecmp(token, "rise_constraint")) {
-			if (timing_type == TIMING_SETUP)
-			    newpin->propdelr = tableptr;
-			else if (timing_type == TIMING_HOLD)
-			    newpin->transr = tableptr;
-		    }
-		    else if (!strcasecmp(token, "fall_constraint")) {
-			if (timing_type == TIMING_SETUP)
-			    newpin->propdelf = tableptr;
-			else if (timing_type == TIMING_HOLD)
-			    newpin->transf = tableptr;
-		    }
+/*--------------------------------------------------------------*/
+/* Find the module named "name" in "modlist", or return NULL.	*/
+/*--------------------------------------------------------------*/
 
-		    token = advancetoken(flib, 0);	// Open parens
-		    if (!strcmp(token, "("))
-			token = advancetoken(flib, ')');
-		    if (strcmp(token, "scalar")) {
-			
-		        for (reftable = *tablelist; reftable; reftable = reftable->next)
-			    if (!strcmp(reftable->name, token))
-			        break;
-		        if (reftable == NULL)
-			    fprintf(stderr, "Failed to find a valid table \"%s\"\n",
-				    token);
-		        else {
-			    // Fill in default values from template reftable
-			    tableptr->invert = reftable->invert;
-			    if (reftable->size1 > 0) {
-				tableptr->var1 = reftable->var1;
-				tableptr->size1 = reftable->size1;
-				tableptr->idx1.times = (double *)malloc(tableptr->size1 * sizeof(double));
-				memcpy(tableptr->idx1.times, reftable->idx1.times,
-						tableptr->size1 * sizeof(double));
-			    }
-			    if (reftable->size2 > 0) {
-				tableptr->var2 = reftable->var2;
-				tableptr->size2 = reftable->size2;
-				tableptr->idx2.caps = (double *)malloc(tableptr->size2 * sizeof(double));
-				memcpy(tableptr->idx2.caps, reftable->idx2.caps,
-						tableptr->size2 * sizeof(double));
-			    }
-			}
-		    }
+moduleptr find_module(moduleptr modlist, char *name)
+{
+    moduleptr testmod;
 
-		    token = advancetoken(flib, 0);
-		    if (strcmp(token, "{"))
-			fprintf(stderr, "Failed to find start of timing block\n");
+    for (testmod = modlist; testmod; testmod = testmod->next)
+	if (!strcmp(testmod->name, name))
+	    return testmod;
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Count the instances of each module of "modlist" in the	*/
+/* other modules, and return the top module:  the last module	*/
+/* read that is not instanced by another.  Its name is kept in	*/
+/* "topmodule".							*/
+/*--------------------------------------------------------------*/
+
+moduleptr find_top_module(moduleptr modlist)
+{
+    moduleptr testmod, submod, topmod;
+    instptr testinst;
+
+    if (modlist == NULL) return NULL;
+
+    if (modlist->next != NULL)
+	for (testmod = modlist; testmod; testmod = testmod->next)
+	    for (testinst = testmod->instlist; testinst; testinst = testinst->next)
+		if ((submod = find_module(modlist, testinst->cellname)) != NULL)
+		    submod->uses++;
+
+    topmod = NULL;
+    for (testmod = modlist; testmod; testmod = testmod->next)
+	if ((testmod->uses == 0) || ((testmod->next == NULL) && (topmod == NULL)))
+	    topmod = testmod;
+
+    topmodule = strdup(topmod->name);
+    if (modlist->next != NULL)
+	fprintf(stdout, "Top module is \"%s\".\n", topmodule);
+    return topmod;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the name "prefix/name" of an object of an instance	*/
+/* "prefix" of a module, in allocated memory.			*/
+/*--------------------------------------------------------------*/
+
+char *hier_name(char *prefix, char *name)
+{
+    char *newname;
+
+    newname = (char *)malloc(strlen(prefix) + strlen(name) + 2);
+    sprintf(newname, "%s/%s", prefix, name);
+    return newname;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the net connected to port "portname" of module	*/
+/* instance "testinst", or NULL if the port is not connected.	*/
+/*--------------------------------------------------------------*/
+
+netptr port_net(instptr testinst, char *portname)
+{
+    connptr testconn;
+
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	if (!strcmp(testconn->pinname, portname))
+	    return testconn->refnet;
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Trace the net "clknet" on the clock of a register back	*/
+/* through the gates driving it to a net with no driver (a	*/
+/* module input), and return that net, or NULL if the clock is	*/
+/* generated by a register.  Of the inputs of each gate, the	*/
+/* first that leads to an undriven net is followed.  "dir" is	*/
+/* the active clock edge at the register, and is set to the	*/
+/* edge at the net found.					*/
+/*--------------------------------------------------------------*/
+
+netptr etm_clock_port(netptr clknet, short *dir)
+{
+    connptr driver, testconn;
+    netptr portnet;
+    short indir;
+
+    driver = clknet->driver;
+    if ((driver == NULL) || (driver->refinst == NULL)) return clknet;
+    if (driver->refinst->index < 0) return NULL;
+
+    for (testconn = driver->refinst->in_connects; testconn; testconn = testconn->next) {
+	if (testconn->flags & CONN_BROKEN) continue;
+	indir = *dir;
+	if (testconn->refpin->sense == SENSE_NEGATIVE)
+	    indir = (indir == RISING) ? FALLING : RISING;
+	portnet = etm_clock_port(testconn->refnet, &indir);
+	if (portnet != NULL) {
+	    *dir = indir;
+	    return portnet;
+	}
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Add a cell named "<module>__<suffix>" of type "type" to the	*/
+/* extracted timing model of module "mod".  The model's delays	*/
+/* are already derated, so the cell has derates of 1.		*/
+/*--------------------------------------------------------------*/
+
+cellptr etm_cell(moduleptr mod, char *suffix, short type)
+{
+    cellptr newcell;
+
+    newcell = (cellptr)malloc(sizeof(cell));
+    newcell->name = (char *)malloc(strlen(mod->name) + strlen(suffix) + 3);
+    sprintf(newcell->name, "%s__%s", mod->name, suffix);
+    newcell->type = type;
+    newcell->function = NULL;
+    newcell->pins = NULL;
+    newcell->area = 0.0;
+    newcell->maxtrans = 0.0;
+    newcell->maxcap = 0.0;
+    newcell->libindex = -1;
+    newcell->early = 1.0;
+    newcell->late = 1.0;
+    newcell->next = NULL;
+
+    mod->etm = (cellptr *)realloc(mod->etm, (mod->numetm + 1) * sizeof(cellptr));
+    mod->etm[mod->numetm++] = newcell;
+    return newcell;
+}
+
+/*--------------------------------------------------------------*/
+/* Add pin "name" to cell "newcell" of a timing model.		*/
+/*--------------------------------------------------------------*/
+
+pinptr etm_pin(cellptr newcell, char *name, short type, short sense)
+{
+    pinptr newpin;
+    char *pinname;
+
+    pinname = strdup(name);	// parse_pin() modifies the name
+    newpin = parse_pin(newcell, pinname, sense);
+    free(pinname);
+    newpin->type = type;
+    newpin->sense = sense;
+    return newpin;
+}
+
+/*--------------------------------------------------------------*/
+/* Make a table of a timing model from "values", with the	*/
+/* index arrays of "reftable".  "size2" is 0 for a table of	*/
+/* transition time only (setup and hold), or the size of the	*/
+/* load index.							*/
+/*--------------------------------------------------------------*/
+
+lutableptr etm_table(lutableptr reftable, int size2, double *values)
+{
+    lutableptr newtable;
+    int size;
+
+    newtable = (lutableptr)malloc(sizeof(lutable));
+    newtable->name = NULL;
+    newtable->invert = 0;
+    newtable->var1 = reftable->var1;
+    newtable->var2 = (size2 > 0) ? reftable->var2 : UNKNOWN;
+    newtable->size1 = reftable->size1;
+    newtable->size2 = size2;
+    newtable->idx1.times = (double *)malloc(newtable->size1 * sizeof(double));
+    memcpy(newtable->idx1.times, reftable->idx1.times, newtable->size1 * sizeof(double));
+    newtable->idx2.caps = NULL;
+    if (size2 > 0) {
+	newtable->idx2.caps = (double *)malloc(size2 * sizeof(double));
+	memcpy(newtable->idx2.caps, reftable->idx2.caps, size2 * sizeof(double));
+    }
+    size = newtable->size1 * ((size2 > 0) ? size2 : 1);
+    newtable->values = (double *)malloc(size * sizeof(double));
+    memcpy(newtable->values, values, size * sizeof(double));
+    newtable->rspan1 = NULL;
+    newtable->rspan2 = NULL;
+    newtable->next = NULL;
+
+    // Share the index arrays of reftable
+    table_finish(newtable, reftable);
+    return newtable;
+}
+
+/*--------------------------------------------------------------*/
+/* Set the tables of pin "newpin" of a timing model from the	*/
+/* delays "delay" and transition times "trans", by output edge	*/
+/* (or data edge, for setup and hold), each "size" values, and	*/
+/* the early tables from "mindelay" and "mintrans", unless	*/
+/* NULL.  An edge with no arc (first value -1E50) gets the	*/
+/* tables of the other edge.  For a flop data pin, "delay"	*/
+/* holds the setup times and "trans" the hold times.  "size2"	*/
+/* is passed to etm_table().					*/
+/*--------------------------------------------------------------*/
+
+void etm_pin_tables(pinptr newpin, lutableptr reftable, int size2, double *delay[2],
+		double *trans[2], double *mindelay[2], double *mintrans[2])
+{
+    lutableptr tables[2][4];
+    int e, t;
+
+    for (e = 0; e < 2; e++) {
+	for (t = 0; t < 4; t++) tables[e][t] = NULL;
+	if (delay[e][0] <= -1E50) continue;
+	tables[e][0] = etm_table(reftable, size2, delay[e]);
+	tables[e][1] = etm_table(reftable, size2, trans[e]);
+	if (mindelay == NULL) continue;
+	tables[e][2] = etm_table(reftable, size2, mindelay[e]);
+	tables[e][3] = etm_table(reftable, size2, mintrans[e]);
+    }
+    for (e = 0; e < 2; e++)
+	if (tables[e][0] == NULL)
+	    for (t = 0; t < 4; t++)
+		tables[e][t] = tables[1 - e][t];
+    newpin->propdelr = tables[0][0];
+    newpin->propdelf = tables[1][0];
+    newpin->transr = tables[0][1];
+    newpin->transf = tables[1][1];
+    newpin->minpropdelr = tables[0][2];
+    newpin->minpropdelf = tables[1][2];
+    newpin->mintransr = tables[0][3];
+    newpin->mintransf = tables[1][3];
+}
+
+/*--------------------------------------------------------------*/
+/* Set the arrival times at the outputs of register "testinst"	*/
+/* of a module being modeled, at the clock-to-output delay	*/
+/* after the earliest and latest clock arrivals "clklat[0]" and	*/
+/* "clklat[1]" at the register, at their transition times	*/
+/* "clktrans[0]" and "clktrans[1]".  The early delay is the	*/
+/* shorter of that and the delay from an ideal clock.		*/
+/*--------------------------------------------------------------*/
+
+void etm_launch(instptr testinst, double *clklat, double *clktrans)
+{
+    netptr loadnet;
+    connptr clkconn, outconn;
+    double delay;
+    short outdir, dir;
+    int o;
+
+    clkconn = find_register_clock(testinst);
+    if (clkconn == NULL) return;
+    outdir = calc_dir(clkconn->refpin, register_edge(testinst));
+    for (outconn = testinst->out_connects; outconn; outconn = outconn->next) {
+	loadnet = outconn->refnet;
+	if (loadnet == NULL) continue;
+	for (o = 0; o < 2; o++) {
+	    dir = (o == 0) ? RISING : FALLING;
+	    if (!(outdir & dir)) continue;
+	    loadnet->arrival[o] = clklat[1] + calc_prop_delay(clktrans[1], clkconn,
+			dir, MAXIMUM_TIME);
+	    loadnet->atrans[o] = calc_transition(clktrans[1], clkconn, dir,
+			MAXIMUM_TIME);
+	    loadnet->minarrival[o] = calc_prop_delay(clktrans[0], clkconn, dir,
+			MINIMUM_TIME);
+	    loadnet->mintrans[o] = calc_transition(clktrans[0], clkconn, dir,
+			MINIMUM_TIME);
+	    delay = calc_prop_delay(0.0, clkconn, dir, MINIMUM_TIME);
+	    if (delay < loadnet->minarrival[o]) {
+		loadnet->minarrival[o] = delay;
+		loadnet->mintrans[o] = calc_transition(0.0, clkconn, dir,
+			MINIMUM_TIME);
+	    }
+	    loadnet->minarrival[o] += clklat[0];
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Keep in "setup[k]" and "hold[k]" the worst setup and hold	*/
+/* times of flop "testinst" of a module being modeled, at each	*/
+/* data transition time "k" of the index of "reftable", taken	*/
+/* from the clock at the module input:  less the earliest	*/
+/* clock arrival "clklat[0]" at the flop for setup, and plus	*/
+/* the latest, "clklat[1]", for hold.  Each check uses the	*/
+/* worse of the rising and falling tables, and of the clock	*/
+/* transition times "clktrans[]" and an ideal clock.		*/
+/*--------------------------------------------------------------*/
+
+void etm_register_checks(instptr testinst, double *clklat, double *clktrans,
+		lutableptr reftable, double *setup, double *hold)
+{
+    connptr dconn;
+    double check, trans, ctrans;
+    int k, c;
+
+    for (dconn = testinst->in_connects; dconn; dconn = dconn->next)
+	if (dconn->refpin->type & DFFIN)
+	    break;
+    if (dconn == NULL) return;
+
+    for (k = 0; k < reftable->size1; k++) {
+	trans = reftable->idx1.times[k];
+	for (c = 0; c < 3; c++) {
+	    ctrans = (c < 2) ? clktrans[c] : 0.0;
+	    check = calc_setup_time(trans, dconn->refpin, ctrans, SENSE_NONE,
+			MAXIMUM_TIME) - clklat[0];
+	    if (check > setup[k]) setup[k] = check;
+	    check = calc_hold_time(trans, dconn->refpin, ctrans, SENSE_NONE,
+			MAXIMUM_TIME) + clklat[1];
+	    if (check > hold[k]) hold[k] = check;
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Copy to "arr", "trn", "marr", and "mtrn" the latest and	*/
+/* earliest arrival times of edge "e" at path end "endnet" of	*/
+/* a module being modeled, and their transition times.  The	*/
+/* wire delay to flop data input "endconn" is added, unless it	*/
+/* is NULL (for a module output).				*/
+/*--------------------------------------------------------------*/
+
+void etm_end_times(netptr endnet, connptr endconn, int e, double *arr,
+		double *trn, double *marr, double *mtrn)
+{
+    double wire;
+
+    wire = (endconn != NULL) ? endconn->wiredelay : 0.0;
+    *arr = endnet->arrival[e];
+    *trn = endnet->atrans[e];
+    *marr = endnet->minarrival[e];
+    *mtrn = endnet->mintrans[e];
+    if (*arr > -1E50) *arr += wire;
+    if (*marr < 1E50) *marr += wire;
+}
+
+/*--------------------------------------------------------------*/
+/* Add the combinational cell of a timing model ending paths at	*/
+/* output "outname" of module "mod", or, if "outname" is NULL,	*/
+/* at the data input of register "regname", whose output pin	*/
+/* is named for the cell.					*/
+/*--------------------------------------------------------------*/
 
-		    while (*token != '}') {
-		        token = advancetoken(flib, 0);
-		        if (!strcasecmp(token, "index_1")) {
+cellptr etm_end_cell(moduleptr mod, char *outname, char *regname)
+{
+    cellptr newcell;
+    char *suffix;
 
-			    // Local index values override those in the template
+    if (outname != NULL) {
+	newcell = etm_cell(mod, outname, GATE);
+	etm_pin(newcell, outname, OUTPUT, SENSE_NONE);
+	return newcell;
+    }
+    suffix = (char *)malloc(strlen(regname) + 4);
+    sprintf(suffix, "%s__d", regname);
+    newcell = etm_cell(mod, suffix, GATE);
+    free(suffix);
+    etm_pin(newcell, newcell->name, OUTPUT, SENSE_NONE);
+    return newcell;
+}
 
-			    token = advancetoken(flib, 0);	// Open parens
-			    token = advancetoken(flib, 0);	// Quote
-			    if (!strcmp(token, "\""))
-				token = advancetoken(flib, '\"');
+/*--------------------------------------------------------------*/
+/* Replace the delays and transition times of the arcs of a	*/
+/* timing model in "values", "tvalues" (latest), "mvalues", and	*/
+/* "mtvalues" (earliest), by input transition time and output	*/
+/* load, by the worst over all output loads.  This is used for	*/
+/* arcs ending at register data inputs, which see no load from	*/
+/* outside of the module.					*/
+/*--------------------------------------------------------------*/
 
-			    //-------------------------
+void etm_worst_load(double *values[2], double *tvalues[2], double *mvalues[2],
+		double *mtvalues[2])
+{
+    double v, t, mv, mt;
+    int e, k, j;
+
+    for (e = 0; e < 2; e++)
+	for (k = 0; k < ETM_GRID; k++) {
+	    v = values[e][k * ETM_GRID];
+	    t = tvalues[e][k * ETM_GRID];
+	    mv = mvalues[e][k * ETM_GRID];
+	    mt = mtvalues[e][k * ETM_GRID];
+	    for (j = 1; j < ETM_GRID; j++) {
+		if (values[e][k * ETM_GRID + j] > v) v = values[e][k * ETM_GRID + j];
+		if (tvalues[e][k * ETM_GRID + j] > t) t = tvalues[e][k * ETM_GRID + j];
+		if (mvalues[e][k * ETM_GRID + j] < mv) mv = mvalues[e][k * ETM_GRID + j];
+		if (mtvalues[e][k * ETM_GRID + j] < mt) mt = mtvalues[e][k * ETM_GRID + j];
+	    }
+	    for (j = 0; j < ETM_GRID; j++) {
+		values[e][k * ETM_GRID + j] = v;
+		tvalues[e][k * ETM_GRID + j] = t;
+		mvalues[e][k * ETM_GRID + j] = mv;
+		mtvalues[e][k * ETM_GRID + j] = mt;
+	    }
+	}
+}
 
-			    if (reftable && (reftable->invert == 1)) {
-				// Entries had better match the ref table
-				iptr = token;
-				i = 0;
-				sscanf(iptr, "%lg", &tableptr->idx2.caps[0]);
-				if (tableptr->var2 == OUTPUT_CAP)
-				    tableptr->idx2.caps[0] *= cap_unit;
-				else
-				    tableptr->idx2.cons[0] *= time_unit;
-				while ((iptr = strchr(iptr, ',')) != NULL) {
-				    iptr++;
-				    i++;
-				    sscanf(iptr, "%lg", &tableptr->idx2.caps[i]);
-				    if (tableptr->var2 == OUTPUT_CAP)
-					tableptr->idx2.caps[i] *= cap_unit;
-				    else
-					tableptr->idx2.cons[i] *= time_unit;
-				}
-			    }
-			    else if (reftable && (reftable->invert == 0)) {
-				iptr = token;
-				i = 0;
-				sscanf(iptr, "%lg", &tableptr->idx1.times[0]);
-				tableptr->idx1.times[0] *= time_unit;
-				while ((iptr = strchr(iptr, ',')) != NULL) {
-				    iptr++;
-				    i++;
-				    sscanf(iptr, "%lg", &tableptr->idx1.times[i]);
-				    tableptr->idx1.times[i] *= time_unit;
-				}
-			    }
+/*--------------------------------------------------------------*/
+/* Extract a timing model of module "mod", whose instances of	*/
+/* other modules have been expanded by expand_hierarchy().  The	*/
+/* module is linked and timed on its own, from ideal clocks at	*/
+/* its clock inputs, and its model is a set of cells added to	*/
+/* "cells", each named "<module>__...":				*/
+/*								*/
+/*   <module>__<output>		Combinational cell with the	*/
+/*				delays from each input, and	*/
+/*				from each clock (through the	*/
+/*				launch cells), to the output,	*/
+/*				by input transition time and	*/
+/*				output load			*/
+/*   <module>__<clock>__rise	Flop launching the paths from	*/
+/*   <module>__<clock>__fall	registers on "clock" that end	*/
+/*				in rising or falling edges	*/
+/*   <module>__<reg>__d		Combinational cell with the	*/
+/*				delays from each input and	*/
+/*				launch cell to the data input	*/
+/*				of register "reg", by input	*/
+/*				transition time			*/
+/*   <module>__<reg>__<clock>	Flop ending the paths of the	*/
+/*				cell above at register "reg" on	*/
+/*				"clock", with its setup and	*/
+/*				hold times, so that each	*/
+/*				instance of the module has the	*/
+/*				endpoints of its own registers	*/
+/*								*/
+/* Clock names have "_n" appended for registers active on the	*/
+/* falling clock edge.  The clock and data pins of the flops	*/
+/* have the names of the module pins they stand for as		*/
+/* aliases, which path reports use.  Each input pin of the	*/
+/* model has the load of its module input net on the first	*/
+/* cell using it.  Register clocks are found by			*/
+/* etm_clock_port(), and registers whose clock does not come	*/
+/* from a module input are not modeled.  Arcs have early and	*/
+/* late tables, and paths include the clock insertion delay	*/
+/* inside the module, so that the model is never more		*/
+/* optimistic than the flattened module.  The model is not	*/
+/* derated again.						*/
+/*								*/
+/* Return the number of cells in the model.			*/
+/*--------------------------------------------------------------*/
 
-			    token = advancetoken(flib, ')'); 	// Close paren
-			    token = advancetoken(flib, ';');	// EOL semicolon
-			}
-		        else if (!strcasecmp(token, "index_2")) {
+int make_etm(moduleptr mod, cellptr *cells, wireloadptr wireloads,
+		wlselptr wlselections, char *wlname)
+{
+    netptr testnet, *inputs, *outputs, *clocks, *ends;
+    instptr testinst, *regs;
+    connptr testconn, *endconns;
+    cellptr newcell, capcell, *launch;
+    pinptr newpin;
+    lutableptr reftable, tables[2];
+    wireloadptr wlmodel;
+    double *arr, *trn, *marr, *mtrn, *larr, *ltrn, *lmarr, *lmtrn;
+    double *setup, *hold, *clklat, *clktrn;
+    double *values[2], *tvalues[2], *mvalues[2], *mtvalues[2];
+    double tmax, cmax, area, f;
+    short *clkdirs, dir;
+    int *reggroup, *endregs;
+    int numin, numout, numends, numregs, numgroups, unclocked;
+    int i, o, g, h, r, e, oe, j, k, n, arcs;
+    char *suffix;
+
+    if (mod->state == MOD_ETM) return mod->numetm;
+
+    bindCells(*cells, &mod->instlist);
+    createLinks(mod->netlist, mod->instlist, mod->inputlist, mod->outputlist);
+    break_loops(mod->instlist);
+    wlmodel = select_wireload(wireloads, wlselections, wlname, mod->instlist);
+
+    // Ports, in the order declared
+
+    numin = numout = 0;
+    for (testconn = mod->inputlist; testconn; testconn = testconn->next) numin++;
+    for (testconn = mod->outputlist; testconn; testconn = testconn->next) numout++;
+    inputs = (netptr *)malloc((numin + 1) * sizeof(netptr));
+    outputs = (netptr *)malloc((numout + 1) * sizeof(netptr));
+    i = numin;
+    for (testconn = mod->inputlist; testconn; testconn = testconn->next)
+	inputs[--i] = testconn->refnet;
+    o = numout;
+    for (testconn = mod->outputlist; testconn; testconn = testconn->next)
+	outputs[--o] = testconn->refnet;
+
+    // The table indexes span the input transition times and loads
+    // of the tables of the module's cells, spaced more closely at
+    // the low end.
+
+    tmax = cmax = area = 0.0;
+    for (testinst = mod->instlist; testinst; testinst = testinst->next) {
+	area += testinst->refcell->area;
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    tables[0] = testconn->refpin->propdelr;
+	    tables[1] = testconn->refpin->propdelf;
+	    for (e = 0; e < 2; e++) {
+		if (tables[e] == NULL) continue;
+		if ((tables[e]->size1 > 0) &&
+			(tables[e]->idx1.times[tables[e]->size1 - 1] > tmax))
+		    tmax = tables[e]->idx1.times[tables[e]->size1 - 1];
+		if ((tables[e]->size2 > 1) &&
+			(tables[e]->idx2.caps[tables[e]->size2 - 1] > cmax))
+		    cmax = tables[e]->idx2.caps[tables[e]->size2 - 1];
+	    }
+	}
+    }
+    if (tmax <= 0.0) tmax = 1000.0;
+    if (cmax <= 0.0) cmax = 100.0;
+
+    reftable = (lutableptr)malloc(sizeof(lutable));
+    reftable->name = strdup(mod->name);
+    reftable->invert = 0;
+    reftable->var1 = TRANSITION_TIME;
+    reftable->var2 = OUTPUT_CAP;
+    reftable->size1 = reftable->size2 = ETM_GRID;
+    reftable->idx1.times = (double *)malloc(ETM_GRID * sizeof(double));
+    reftable->idx2.caps = (double *)malloc(ETM_GRID * sizeof(double));
+    for (k = 0; k < ETM_GRID; k++) {
+	f = (double)k / (double)(ETM_GRID - 1);
+	reftable->idx1.times[k] = tmax * f * f;
+	reftable->idx2.caps[k] = cmax * f * f;
+    }
+    reftable->values = NULL;
+    reftable->next = NULL;
+    table_finish(reftable, NULL);
+
+    // Group the registers by clock input and edge
+
+    numregs = 0;
+    for (testinst = mod->instlist; testinst; testinst = testinst->next)
+	if (testinst->index < 0) numregs++;
+    regs = (instptr *)malloc((numregs + 1) * sizeof(instptr));
+    reggroup = (int *)malloc((numregs + 1) * sizeof(int));
+    clocks = (netptr *)malloc((numregs + 1) * sizeof(netptr));
+    clkdirs = (short *)malloc((numregs + 1) * sizeof(short));
+
+    numgroups = unclocked = 0;
+    r = 0;
+    for (testinst = mod->instlist; testinst; testinst = testinst->next) {
+	if (testinst->index >= 0) continue;
+	regs[r] = testinst;
+	reggroup[r] = -1;
+	testnet = NULL;
+	dir = RISING;
+	testconn = find_register_clock(testinst);
+	if (testconn != NULL) {
+	    dir = register_edge(testinst);
+	    testnet = etm_clock_port(testconn->refnet, &dir);
+	}
+	for (i = 0; i < numin; i++)
+	    if (inputs[i] == testnet)
+		break;
+	if (i == numin)
+	    unclocked++;
+	else {
+	    for (g = 0; g < numgroups; g++)
+		if ((clocks[g] == testnet) && (clkdirs[g] == dir))
+		    break;
+	    if (g == numgroups) {
+		clocks[g] = testnet;
+		clkdirs[g] = dir;
+		numgroups++;
+	    }
+	    reggroup[r] = g;
+	}
+	r++;
+    }
 
-			    // Local index values override those in the template
+    // Path ends:  the outputs, then the data inputs of the modeled
+    // flops
 
-			    token = advancetoken(flib, 0);	// Open parens
-			    token = advancetoken(flib, 0);	// Quote
-			    if (!strcmp(token, "\""))
-				token = advancetoken(flib, '\"');
+    ends = (netptr *)malloc((numout + numregs + 1) * sizeof(netptr));
+    endconns = (connptr *)malloc((numout + numregs + 1) * sizeof(connptr));
+    endregs = (int *)malloc((numout + numregs + 1) * sizeof(int));
+    for (o = 0; o < numout; o++) {
+	ends[o] = outputs[o];
+	endconns[o] = NULL;
+	endregs[o] = -1;
+    }
+    numends = numout;
+    for (r = 0; r < numregs; r++) {
+	if ((reggroup[r] < 0) || !(regs[r]->refcell->type & DFF)) continue;
+	for (testconn = regs[r]->in_connects; testconn; testconn = testconn->next)
+	    if (testconn->refpin->type & DFFIN)
+		break;
+	if ((testconn == NULL) || (testconn->refnet == NULL)) continue;
+	ends[numends] = testconn->refnet;
+	endconns[numends] = testconn;
+	endregs[numends] = r;
+	numends++;
+    }
 
-			    //-------------------------
+    // Latest and earliest arrival times at the path ends, by input,
+    // input edge, end edge, input transition time, and output load;
+    // at the path ends by clock group, end edge, and output load;  and
+    // setup and hold at the registers, by data transition time.
+
+    n = numin * numends * 4 * ETM_GRID * ETM_GRID;
+    arr = (double *)malloc((n + 1) * sizeof(double));
+    trn = (double *)malloc((n + 1) * sizeof(double));
+    marr = (double *)malloc((n + 1) * sizeof(double));
+    mtrn = (double *)malloc((n + 1) * sizeof(double));
+    for (i = 0; i < n; i++) {
+	arr[i] = -1E50;		// No arcs from clocks
+	marr[i] = 1E50;
+    }
+    n = numgroups * numends * 2 * ETM_GRID;
+    larr = (double *)malloc((n + 1) * sizeof(double));
+    ltrn = (double *)malloc((n + 1) * sizeof(double));
+    lmarr = (double *)malloc((n + 1) * sizeof(double));
+    lmtrn = (double *)malloc((n + 1) * sizeof(double));
+    clklat = (double *)malloc((2 * numregs + 1) * sizeof(double));
+    clktrn = (double *)malloc((2 * numregs + 1) * sizeof(double));
+    n = numregs * ETM_GRID;
+    setup = (double *)malloc((n + 1) * sizeof(double));
+    hold = (double *)malloc((n + 1) * sizeof(double));
+    for (i = 0; i < n; i++) setup[i] = hold[i] = -1E50;
+
+    for (j = 0; j < ETM_GRID; j++) {
+	for (testnet = mod->netlist; testnet; testnet = testnet->next)
+	    testnet->loadr = testnet->loadf = 0.0;
+	computeLoads(mod->netlist, mod->instlist, reftable->idx2.caps[j], wlmodel);
+
+	// Earliest and latest clock arrivals at each register, from
+	// the active edge at its clock input at time zero, and their
+	// transition times.  The launch delays and the setup and hold
+	// times of the model include this insertion delay.
+
+	for (g = 0; g < numgroups; g++) {
+	    clear_arrival_times(mod->netlist);
+	    e = CLKEDGE(clkdirs[g]);
+	    clocks[g]->arrival[e] = clocks[g]->minarrival[e] = 0.0;
+	    propagate_arrival_times();
+	    for (r = 0; r < numregs; r++) {
+		if (reggroup[r] != g) continue;
+		testconn = find_register_clock(regs[r]);
+		testnet = testconn->refnet;
+		e = CLKEDGE(register_edge(regs[r]));
+		clklat[r * 2] = clklat[r * 2 + 1] = testconn->wiredelay;
+		clktrn[r * 2] = clktrn[r * 2 + 1] = 0.0;
+		if (testnet->minarrival[e] < 1E50) {
+		    clklat[r * 2] += testnet->minarrival[e];
+		    clktrn[r * 2] = testnet->mintrans[e];
+		}
+		if (testnet->arrival[e] > -1E50) {
+		    clklat[r * 2 + 1] += testnet->arrival[e];
+		    clktrn[r * 2 + 1] = testnet->atrans[e];
+		}
 
-			    if (reftable && (reftable->invert == 1)) {
-				// Entries had better match the ref table
-				iptr = token;
-				i = 0;
-				sscanf(iptr, "%lg", &tableptr->idx1.times[0]);
-				tableptr->idx1.times[0] *= time_unit;
-				while ((iptr = strchr(iptr, ',')) != NULL) {
-				    iptr++;
-				    i++;
-				    sscanf(iptr, "%lg", &tableptr->idx1.times[i]);
-				    tableptr->idx1.times[i] *= time_unit;
-				}
-			    }
-			    else if (reftable && (reftable->invert == 0)) {
-				iptr = token;
-				i = 0;
-				sscanf(iptr, "%lg", &tableptr->idx2.caps[0]);
-				tableptr->idx2.caps[0] *= cap_unit;
-				while ((iptr = strchr(iptr, ',')) != NULL) {
-				    iptr++;
-				    i++;
-				    sscanf(iptr, "%lg", &tableptr->idx2.caps[i]);
-				    tableptr->idx2.caps[i] *= cap_unit;
-				}
-			    }
+		// Setup and hold are kept at the worst output load
+		if (regs[r]->refcell->type & DFF)
+		    etm_register_checks(regs[r], clklat + r * 2, clktrn + r * 2,
+				reftable, setup + r * ETM_GRID, hold + r * ETM_GRID);
+	    }
+	}
 
-			    token = advancetoken(flib, ')'); 	// Close paren
-			    token = advancetoken(flib, ';');	// EOL semicolon
+	for (i = 0; i < numin; i++) {
+	    for (g = 0; g < numgroups; g++)
+		if (clocks[g] == inputs[i])
+		    break;
+	    if (g < numgroups) continue;	// Clocks are not data
+
+	    for (k = 0; k < ETM_GRID; k++) {
+		for (e = 0; e < 2; e++) {
+		    clear_arrival_times(mod->netlist);
+		    inputs[i]->arrival[e] = inputs[i]->minarrival[e] = 0.0;
+		    inputs[i]->atrans[e] = inputs[i]->mintrans[e] =
+				reftable->idx1.times[k];
+		    propagate_arrival_times();
+
+		    for (o = 0; o < numends; o++)
+			for (oe = 0; oe < 2; oe++) {
+			    n = ((((i * numends + o) * 2 + e) * 2 + oe) * ETM_GRID + k)
+					* ETM_GRID + j;
+			    etm_end_times(ends[o], endconns[o], oe, arr + n, trn + n,
+					marr + n, mtrn + n);
 			}
-			else if (!strcasecmp(token, "values")) {
-			    token = advancetoken(flib, 0);	
-			    if (strcmp(token, "("))
-				fprintf(stderr, "Failed to find start of"
-						" value table\n");
-			    token = advancetoken(flib, ')');
+		}
+	    }
+	}
 
-			    // Parse the string of values and enter it into the
-			    // table "values", which is size size2 x size1
+	for (g = 0; g < numgroups; g++) {
+	    clear_arrival_times(mod->netlist);
+	    for (r = 0; r < numregs; r++)
+		if (reggroup[r] == g)
+		    etm_launch(regs[r], clklat + r * 2, clktrn + r * 2);
+	    propagate_arrival_times();
+	    for (o = 0; o < numends; o++)
+		for (oe = 0; oe < 2; oe++) {
+		    n = ((g * numends + o) * 2 + oe) * ETM_GRID + j;
+		    etm_end_times(ends[o], endconns[o], oe, larr + n, ltrn + n,
+				lmarr + n, lmtrn + n);
+		}
+	}
+    }
 
-			    if (reftable && reftable->size1 > 0) {
-				int locsize2;
-			        locsize2 = (reftable->size2 > 0) ? reftable->size2 : 1;
-				if (reftable->invert) {
-				    tableptr->values = (double *)malloc(locsize2 *
-						reftable->size1 * sizeof(double));
-				    iptr = token;
-				    for (i = 0; i < reftable->size1; i++) {
-					for (j = 0; j < locsize2; j++) {
-					    while (*iptr == ' ' || *iptr == '\"' ||
-							*iptr == ',')
-						iptr++;
-					    sscanf(iptr, "%lg", &gval);
-					    *(tableptr->values + j * reftable->size1
-							+ i) = gval * time_unit;
-					    while (*iptr != ' ' && *iptr != '\"' &&
-							*iptr != ',')
-						iptr++;
-					}
-				    }
-				}
-				else {
-				    tableptr->values = (double *)malloc(locsize2 *
-						reftable->size1 * sizeof(double));
-				    iptr = token;
-				    for (j = 0; j < locsize2; j++) {
-					for (i = 0; i < reftable->size1; i++) {
-					    while (*iptr == ' ' || *iptr == '\"' ||
-							*iptr == ',')
-						iptr++;
-					    sscanf(iptr, "%lg", &gval);
-					    *(tableptr->values + j * reftable->size1
-							+ i) = gval * time_unit;
-					    while (*iptr != ' ' && *iptr != '\"' &&
-							*iptr != ',')
-						iptr++;
-					}
-				    }
-				}
-			    }
+    // Build the cells of the model
 
-			    token = advancetoken(flib, 0);
-			    if (strcmp(token, ";"))
-				fprintf(stderr, "Failed to find end of value table\n");
-			    token = advancetoken(flib, 0);
+    suffix = (char *)malloc(LIB_LINE_MAX);
+    for (e = 0; e < 2; e++) {
+	values[e] = (double *)malloc(ETM_GRID * ETM_GRID * sizeof(double));
+	tvalues[e] = (double *)malloc(ETM_GRID * ETM_GRID * sizeof(double));
+	mvalues[e] = (double *)malloc(ETM_GRID * ETM_GRID * sizeof(double));
+	mtvalues[e] = (double *)malloc(ETM_GRID * ETM_GRID * sizeof(double));
+    }
+    launch = (cellptr *)calloc(2 * numgroups + 1, sizeof(cellptr));
+
+    for (o = 0; o < numends; o++) {
+	newcell = NULL;
+	for (i = 0; i < numin; i++) {
+
+	    // Find which input edges reach which output edges.  An arc
+	    // with input and output edges of one sense only is unate.
 
+	    arcs = 0;
+	    for (e = 0; e < 2; e++)
+		for (oe = 0; oe < 2; oe++) {
+		    n = (((i * numends + o) * 2 + e) * 2 + oe) * ETM_GRID * ETM_GRID;
+		    if (arr[n] > -1E50) arcs |= 1 << (e * 2 + oe);
+		}
+	    if (arcs == 0) continue;
+
+	    if (newcell == NULL)
+		newcell = etm_end_cell(mod, (o < numout) ? outputs[o]->name : NULL,
+			(o < numout) ? NULL : regs[endregs[o]]->name);
+	    newpin = etm_pin(newcell, inputs[i]->name, INPUT,
+			(arcs & 0x9) ? SENSE_POSITIVE : SENSE_NEGATIVE);
+
+	    // Non-unate arcs are taken as positive-unate, with the
+	    // delay from the later of the two input edges, and the early
+	    // delay from the earlier.
+
+	    for (oe = 0; oe < 2; oe++)
+		for (k = 0; k < ETM_GRID * ETM_GRID; k++) {
+		    values[oe][k] = -1E50;
+		    tvalues[oe][k] = 0.0;
+		    mvalues[oe][k] = 1E50;
+		    mtvalues[oe][k] = 0.0;
+		    for (e = 0; e < 2; e++) {
+			n = (((i * numends + o) * 2 + e) * 2 + oe) * ETM_GRID * ETM_GRID + k;
+			if (arr[n] > values[oe][k]) {
+			    values[oe][k] = arr[n];
+			    tvalues[oe][k] = trn[n];
+			}
+			if (marr[n] < mvalues[oe][k]) {
+			    mvalues[oe][k] = marr[n];
+			    mtvalues[oe][k] = mtrn[n];
 			}
-			else if (strcmp(token, "{"))
-			    fprintf(stderr, "Failed to find end of timing block\n");
 		    }
 		}
-		else {
-		    // For unhandled tokens, read in tokens.  If it is
-		    // a definition or function, read to end-of-line.  If
-		    // it is a block definition, read to end-of-block.
-		    while (1) {
-			token = advancetoken(flib, 0);
-			if (token == NULL) break;
-			if (!strcmp(token, ";")) break;
-			if (!strcmp(token, "\""))
-			    token = advancetoken(flib, '\"');
-			if (!strcmp(token, "{")) {
-			    token = advancetoken(flib, '}');
-			    break;
-			}
+	    if (o >= numout) etm_worst_load(values, tvalues, mvalues, mtvalues);
+	    etm_pin_tables(newpin, reftable, ETM_GRID, values, tvalues, mvalues,
+			mtvalues);
+	}
+
+	for (g = 0; g < numgroups; g++) {
+	    for (oe = 0; oe < 2; oe++) {
+		n = ((g * numends + o) * 2 + oe) * ETM_GRID;
+		if (larr[n] <= -1E50) continue;
+
+		// The launch flop's clock pin sense sets the output edge
+		if (launch[g * 2 + oe] == NULL) {
+		    sprintf(suffix, "%s%s__%s", clocks[g]->name,
+				(clkdirs[g] == FALLING) ? "_n" : "",
+				(oe == 0) ? "rise" : "fall");
+		    launch[g * 2 + oe] = etm_cell(mod, suffix, DFF |
+				((clkdirs[g] == FALLING) ? CLK_SENSE_MASK : 0));
+		    newpin = etm_pin(launch[g * 2 + oe], clocks[g]->name,
+				INPUT | DFFCLK, ((oe == 0) == (clkdirs[g] == RISING)) ?
+				SENSE_POSITIVE : SENSE_NEGATIVE);
+		    newpin->alias = strdup(clocks[g]->name);
+		    etm_pin(launch[g * 2 + oe], launch[g * 2 + oe]->name, OUTPUT,
+				SENSE_NONE);
+		}
+		if (newcell == NULL)
+		    newcell = etm_end_cell(mod, (o < numout) ? outputs[o]->name :
+				NULL, (o < numout) ? NULL : regs[endregs[o]]->name);
+		newpin = etm_pin(newcell, launch[g * 2 + oe]->name, INPUT,
+				SENSE_POSITIVE);
+
+		// The delay does not depend on the input transition
+		for (k = 0; k < ETM_GRID; k++)
+		    for (j = 0; j < ETM_GRID; j++) {
+			values[oe][k * ETM_GRID + j] = larr[n + j];
+			tvalues[oe][k * ETM_GRID + j] = ltrn[n + j];
+			mvalues[oe][k * ETM_GRID + j] = lmarr[n + j];
+			mtvalues[oe][k * ETM_GRID + j] = lmtrn[n + j];
 		    }
+		if (o >= numout) etm_worst_load(values, tvalues, mvalues, mtvalues);
+		values[1 - oe][0] = -1E50;
+		etm_pin_tables(newpin, reftable, ETM_GRID, values, tvalues, mvalues,
+			mtvalues);
+	    }
+	}
+	if ((newcell == NULL) || (o < numout)) continue;
+
+	// The flop ending the paths at the register, clocked from the
+	// module's clock input, with the setup and hold times of the
+	// register for both data edges
+
+	r = endregs[o];
+	h = reggroup[r];
+	sprintf(suffix, "%s__%s%s", regs[r]->name, clocks[h]->name,
+		(clkdirs[h] == FALLING) ? "_n" : "");
+	capcell = etm_cell(mod, suffix, DFF |
+		((clkdirs[h] == FALLING) ? CLK_SENSE_MASK : 0));
+	newpin = etm_pin(capcell, newcell->name, INPUT | DFFIN, SENSE_NONE);
+	newpin->alias = (char *)malloc(strlen(regs[r]->name) +
+		strlen(endconns[o]->refpin->name) + 2);
+	sprintf(newpin->alias, "%s/%s", regs[r]->name, endconns[o]->refpin->name);
+	for (k = 0; k < ETM_GRID; k++) {
+	    values[0][k] = values[1][k] = setup[r * ETM_GRID + k];
+	    tvalues[0][k] = tvalues[1][k] = hold[r * ETM_GRID + k];
+	}
+	etm_pin_tables(newpin, reftable, 0, values, tvalues, NULL, NULL);
+	newpin = etm_pin(capcell, clocks[h]->name, INPUT | DFFCLK, SENSE_POSITIVE);
+	testconn = find_register_clock(regs[r]);
+	newpin->alias = (char *)malloc(strlen(regs[r]->name) +
+		strlen(testconn->refpin->name) + 2);
+	sprintf(newpin->alias, "%s/%s", regs[r]->name, testconn->refpin->name);
+	etm_pin(capcell, capcell->name, OUTPUT, SENSE_NONE);
+    }
+
+    // Input pin loads, on the first pin of each input
+
+    for (i = 0; i < numin; i++) {
+	newpin = NULL;
+	for (k = 0; (k < mod->numetm) && (newpin == NULL); k++)
+	    for (newpin = mod->etm[k]->pins; newpin; newpin = newpin->next)
+		if (!(newpin->type & OUTPUT) && !strcmp(newpin->name, inputs[i]->name))
+		    break;
+	if (newpin == NULL) continue;
+	newpin->capr = inputs[i]->loadr;
+	newpin->capf = inputs[i]->loadf;
+    }
+
+    if (mod->numetm > 0) mod->etm[0]->area = area;
+    for (k = mod->numetm - 1; k >= 0; k--) {
+	mod->etm[k]->next = *cells;
+	*cells = mod->etm[k];
+    }
+    mod->state = MOD_ETM;
+
+    fprintf(stdout, "Extracted timing model for module \"%s\":  %d cell%s, %d clock%s.\n",
+		mod->name, mod->numetm, (mod->numetm == 1) ? "" : "s",
+		numgroups, (numgroups == 1) ? "" : "s");
+    if (unclocked > 0)
+	fprintf(stderr, "Warning:  %d register%s of module \"%s\" not clocked from "
+		"a module input, and not modeled.\n", unclocked,
+		(unclocked == 1) ? "" : "s", mod->name);
+
+    for (e = 0; e < 2; e++) {
+	free(values[e]);
+	free(tvalues[e]);
+	free(mvalues[e]);
+	free(mtvalues[e]);
+    }
+    free(suffix);
+    free(launch);
+    free(arr);
+    free(trn);
+    free(marr);
+    free(mtrn);
+    free(larr);
+    free(ltrn);
+    free(lmarr);
+    free(lmtrn);
+    free(clklat);
+    free(clktrn);
+    free(setup);
+    free(hold);
+    free(ends);
+    free(endconns);
+    free(endregs);
+    free(regs);
+    free(reggroup);
+    free(clocks);
+    free(clkdirs);
+    free(inputs);
+    free(outputs);
+    return mod->numetm;
+}
+
+/*--------------------------------------------------------------*/
+/* Add instances of the cells of the timing model of module	*/
+/* "mod", named "<instance>/<cell>", to "newlist", in place of	*/
+/* the module's instance "testinst".  Pins named for a module	*/
+/* port connect to the net on that port of "testinst", and	*/
+/* other pins to nets "<instance>/<pin>", added to "netlist".	*/
+/*--------------------------------------------------------------*/
+
+void etm_instance(moduleptr mod, instptr testinst, netptr *netlist, instptr *newlist)
+{
+    netptr firstnet, testnet;
+    instptr newinst;
+    pinptr testpin;
+    char *name;
+    int k;
+
+    firstnet = *netlist;	// Nets added here are ahead of this one
+
+    for (k = 0; k < mod->numetm; k++) {
+	name = hier_name(testinst->name, mod->etm[k]->name);
+	newinst = create_instance(newlist, name, mod->etm[k]->name);
+	free(name);
+
+	for (testpin = mod->etm[k]->pins; testpin; testpin = testpin->next) {
+	    testnet = port_net(testinst, testpin->name);
+	    if (testnet == NULL) {
+		name = hier_name(testinst->name, testpin->name);
+		for (testnet = *netlist; testnet != firstnet; testnet = testnet->next)
+		    if (!strcmp(testnet->name, name))
+			break;
+		if (testnet == firstnet) {
+		    testnet = create_net(netlist);
+		    testnet->name = name;
 		}
+		else
+		    free(name);
+	    }
+	    create_connect(newinst, testpin->name, testnet);
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Add a copy of the contents of module "mod" to "newlist", in	*/
+/* place of the module's instance "testinst".  The module's	*/
+/* port nets are replaced by the nets on the ports of		*/
+/* "testinst", and its other nets and instances are copied with	*/
+/* names "<instance>/<name>".					*/
+/*--------------------------------------------------------------*/
+
+void flatten_instance(moduleptr mod, instptr testinst, netptr *netlist,
+		instptr *newlist)
+{
+    netptr *nets, *mapped, testnet;
+    instptr subinst, newinst;
+    connptr subconn;
+    unsigned int mask, h;
+    char *name;
+    int pass;
+
+    nets = hash_nets(mod->netlist, &mask);
+    mapped = (netptr *)calloc(mask + 1, sizeof(netptr));
+    for (h = 0; h <= mask; h++) {
+	if (nets[h] == NULL) continue;
+	testnet = port_net(testinst, nets[h]->name);
+	if (testnet == NULL) {
+	    testnet = create_net(netlist);
+	    testnet->name = hier_name(testinst->name, nets[h]->name);
+	}
+	mapped[h] = testnet;
+    }
+
+    for (subinst = mod->instlist; subinst; subinst = subinst->next) {
+	name = hier_name(testinst->name, subinst->name);
+	newinst = create_instance(newlist, name, (subinst->refcell) ?
+			subinst->refcell->name : subinst->cellname);
+	free(name);
+
+	// The module may be bound already (see make_etm())
+	for (pass = 0; pass < 2; pass++) {
+	    subconn = (pass == 0) ? subinst->in_connects : subinst->out_connects;
+	    for (; subconn; subconn = subconn->next) {
+		if (subconn->refnet == NULL) continue;
+		for (h = hash_name(subconn->refnet->name) & mask; nets[h] != subconn->refnet;
+				h = (h + 1) & mask);
+		create_connect(newinst, (subconn->refpin) ? subconn->refpin->name :
+				subconn->pinname, mapped[h]);
+	    }
+	}
+    }
+    free(nets);
+    free(mapped);
+}
+
+/*--------------------------------------------------------------*/
+/* Replace the instances of other modules in module "mod".	*/
+/* Instances named in "flatlist" are flattened, and all others	*/
+/* are replaced by the extracted timing model of their module	*/
+/* (see make_etm()), so that each module is timed once however	*/
+/* many times it is used.  Names in "flatlist" are instances	*/
+/* of "mod";  the name "*" flattens the whole hierarchy.	*/
+/*								*/
+/* Return 0 on success, or 1 if a module instances itself.	*/
+/*--------------------------------------------------------------*/
+
+int expand_hierarchy(moduleptr mod, moduleptr modlist, cellptr *cells,
+		char **flatlist, int numflat, wireloadptr wireloads,
+		wlselptr wlselections, char *wlname)
+{
+    moduleptr submod;
+    instptr testinst, nextinst, *instptrptr, newlist;
+    connptr testconn, nextconn;
+    int i, flatall, numflattened, nummodeled;
+
+    if (mod->state == MOD_BUSY) {
+	fprintf(stderr, "Error:  Module \"%s\" instances itself!\n", mod->name);
+	return 1;
+    }
+    if (mod->state != MOD_NEW) return 0;
+    mod->state = MOD_BUSY;
+
+    flatall = 0;
+    for (i = 0; i < numflat; i++)
+	if (!strcmp(flatlist[i], "*"))
+	    flatall = 1;
+
+    newlist = NULL;
+    numflattened = nummodeled = 0;
+    instptrptr = &mod->instlist;
+    while ((testinst = *instptrptr) != NULL) {
+	submod = find_module(modlist, testinst->cellname);
+	if (submod == NULL) {
+	    instptrptr = &testinst->next;
+	    continue;
+	}
+
+	if (expand_hierarchy(submod, modlist, cells, (flatall) ? flatlist : NULL,
+			(flatall) ? numflat : 0, wireloads, wlselections, wlname) != 0)
+	    return 1;
+
+	for (i = 0; i < numflat; i++)
+	    if (flatall || !strcmp(flatlist[i], testinst->name))
 		break;
+	if (i < numflat) {
+	    flatten_instance(submod, testinst, &mod->netlist, &newlist);
+	    numflattened++;
 	}
-	token = advancetoken(flib, 0);
+	else {
+	    make_etm(submod, cells, wireloads, wlselections, wlname);
+	    etm_instance(submod, testinst, &mod->netlist, &newlist);
+	    nummodeled++;
+	}
+
+	*instptrptr = testinst->next;
+	for (testconn = testinst->in_connects; testconn; testconn = nextconn) {
+	    nextconn = testconn->next;
+	    free(testconn->pinname);
+	    free(testconn);
+	}
+	free(testinst->cellname);
+	free(testinst->name);
+	free(testinst);
     }
+
+    for (testinst = newlist; testinst; testinst = nextinst) {
+	nextinst = testinst->next;
+	testinst->next = mod->instlist;
+	mod->instlist = testinst;
+    }
+    mod->state = MOD_FLAT;
+
+    if (numflattened + nummodeled > 0)
+	fprintf(stdout, "Module \"%s\":  %d instance%s flattened, %d replaced by "
+		"timing models.\n", mod->name, numflattened,
+		(numflattened == 1) ? "" : "s", nummodeled);
+    return 0;
 }
 
 /*--------------------------------------------------------------*/
-/* Read a verilog netlist and collect information about the	*/
-/* cells instantiated and the network structure			*/
+/* Write the timing criticality of each net to "fcrit", for	*/
+/* timing-driven placement, after compute_required_times()	*/
+/* has returned the critical delay "dmax".  The slack of a net	*/
+/* is the worst slack of any path through it, found from the	*/
+/* arrival and required times of its edges.  The criticality	*/
+/* is the slack scaled to the range 0 to 1, with 1 for the nets	*/
+/* of worst slack and 0 for nets with the critical delay or	*/
+/* more of slack to spare.  Nets not on any timed path are not	*/
+/* written.							*/
+/*								*/
+/* Return the number of nets written.				*/
 /*--------------------------------------------------------------*/
 
-void
-verilogRead(FILE *fsrc, cell *cells, net **netlist, instance **instlist,
-		connect **inputlist, connect **outputlist)
+int write_criticality(netptr netlist, double dmax, FILE *fcrit)
 {
-    char *token;
-    char *modname = NULL;
-    int section = MODULE;
-
-    instptr newinst;
-    netptr newnet, testnet;
-    cellptr testcell;
-    connptr newconn, testconn;
-    pinptr testpin;
+    netptr testnet;
+    double slack, wns, crit;
+    int e, numnets;
 
-    int vstart, vend, vtarget, isinput;
+    wns = 1E50;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	for (e = 0; e < 2; e++) {
+	    if (testnet->required[e] >= 1E50) continue;
+	    slack = testnet->required[e] - testnet->arrival[e];
+	    if (slack < wns) wns = slack;
+	}
+    }
 
-    /* Read tokens off of the line */
-    token = advancetoken(fsrc, 0);
+    fprintf(fcrit, "# net\tcriticality\tslack\n");
+    numnets = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	slack = 1E50;
+	for (e = 0; e < 2; e++) {
+	    if (testnet->required[e] >= 1E50) continue;
+	    if (testnet->required[e] - testnet->arrival[e] < slack)
+		slack = testnet->required[e] - testnet->arrival[e];
+	}
+	if (slack >= 1E50) continue;
 
-    while (token != NULL) {
+	crit = (dmax > 0.0) ? 1.0 - (slack - wns) / dmax : 0.0;
+	if (crit < 0.0) crit = 0.0;
+	fprintf(fcrit, "%s\t%.4f\t%g\n", testnet->name, crit, slack);
+	numnets++;
+    }
 
-	switch (section) {
-	    case MODULE:
-		if (!strcasecmp(token, "module")) {
-		    token = advancetoken(fsrc, 0);
-		    fprintf(stderr, "Parsing module \"%s\"\n", token);
+    fprintf(stdout, "Net criticality:  %d nets, worst slack %g ps, critical delay %g ps.\n",
+		numnets, (numnets > 0) ? wns : 0.0, dmax);
+    return numnets;
+}
 
-		    token = advancetoken(fsrc, 0);
-		    if (strcmp(token, "("))
-			fprintf(stderr, "Module not followed by pin list\n");
-		    else
-			token = advancetoken(fsrc, ')');
-		    token = advancetoken(fsrc, ';');	// Get end-of-line
+/*--------------------------------------------------------------*/
+/* Write the arrival and required times and the setup and hold	*/
+/* slack of each edge at connection "testconn" to "fslack", as	*/
+/* tab-separated records.  A receiver is timed at its pin,	*/
+/* after the wire delay, and a driver (a gate output or module	*/
+/* input) at the net.  Times that are not constrained are	*/
+/* written as "-".						*/
+/*--------------------------------------------------------------*/
 
-		    // Ignore the pin list, go straight to the input/output declarations
-		    section = IOLIST;
-		}
-		break;
+void write_pin_slack(connptr testconn, FILE *fslack)
+{
+    netptr testnet;
+    char pinname[1024];
+    double arrival, minarrival, required, minrequired, wdelay;
+    char isdriver;
+    int e, i;
+
+    testnet = testconn->refnet;
+    if (testnet == NULL) return;
+    isdriver = 1;
+    for (i = 0; i < testnet->fanout; i++)
+	if (testnet->receivers[i] == testconn)
+	    isdriver = 0;
+
+    if ((testconn->refinst != NULL) && (testconn->refpin != NULL))
+	snprintf(pinname, 1024, "%s/%s", testconn->refinst->name,
+		testconn->refpin->name);
+    else
+	snprintf(pinname, 1024, "%s", testnet->name);
+
+    wdelay = (isdriver) ? 0.0 : testconn->wiredelay;
+    for (e = 0; e < 2; e++) {
+	if (testnet->arrival[e] <= -1E50) continue;
+	arrival = testnet->arrival[e] + wdelay;
+	minarrival = testnet->minarrival[e] + wdelay;
+	required = (isdriver) ? testnet->required[e] : testconn->required[e];
+	minrequired = (isdriver) ? testnet->minrequired[e] : testconn->minrequired[e];
+
+	fprintf(fslack, "%s\t%s\t%g\t", pinname, (e == 0) ? "rise" : "fall", arrival);
+	if (required < 1E50)
+	    fprintf(fslack, "%g\t%g\t", required, required - arrival);
+	else
+	    fprintf(fslack, "-\t-\t");
+	fprintf(fslack, "%g\t", minarrival);
+	if (minrequired > -1E50)
+	    fprintf(fslack, "%g\t%g\n", minrequired, minarrival - minrequired);
+	else
+	    fprintf(fslack, "-\t-\n");
+    }
+}
 
-	    case IOLIST:
-		if (!strcasecmp(token, "input") || !strcasecmp(token, "output")) {
+/*--------------------------------------------------------------*/
+/* Write the slack of every pin (see write_pin_slack()) to	*/
+/* "fslack":  The inputs and outputs of each instance, and the	*/
+/* module inputs and outputs.					*/
+/*--------------------------------------------------------------*/
 
-		    testconn = NULL;
-		    vstart = vend = 0;
+void write_slack(instptr instlist, connptr inputlist, connptr outputlist,
+		FILE *fslack)
+{
+    instptr testinst;
+    connptr testconn;
 
-		    if (!strcasecmp(token, "input")) {
-			isinput = 1;
-		    }
-		    else { 	// output
-			isinput = 0;
-		    }
+    fprintf(fslack, "# pin\tedge\tarrival\trequired\tslack"
+		"\tmin_arrival\tmin_required\thold_slack\n");
 
-		    token = advancetoken(fsrc, 0);
-		    if (*token == '[') {
-			sscanf(token + 1, "%d", &vstart);
-			token = advancetoken(fsrc, ':');
-			token = advancetoken(fsrc, ']');	// Read to end of vector
-			sscanf(token, "%d", &vend);
-			token = advancetoken(fsrc, 0);		// Read signal name
-		    }
+    for (testconn = inputlist; testconn; testconn = testconn->next)
+	write_pin_slack(testconn, fslack);
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	    write_pin_slack(testconn, fslack);
+	for (testconn = testinst->out_connects; testconn; testconn = testconn->next)
+	    write_pin_slack(testconn, fslack);
+    }
+    for (testconn = outputlist; testconn; testconn = testconn->next)
+	write_pin_slack(testconn, fslack);
+}
 
-		    // Create a net entry for the input or output, add to the list of nets
+/*--------------------------------------------------------------*/
+/* Find the connection named by "pinspec", which is either	*/
+/* "<instance>/<pin>" or the name of a module input or output.	*/
+/* Return NULL if there is no such connection.			*/
+/*--------------------------------------------------------------*/
 
-		    if (vstart == 0 && vend == 0) {
-			newnet = create_net(netlist);
-			newnet->name = strdup(token);
+connptr find_pin(char *pinspec, instptr instlist, connptr inputlist,
+		connptr outputlist)
+{
+    instptr testinst;
+    connptr testconn;
+    char *pinname;
+    int len;
 
-			testconn = (connptr)malloc(sizeof(connect));
-			testconn->refnet = newnet;
-			testconn->refpin = NULL;	// No associated pin
-			testconn->refinst = NULL;	// No associated instance
-			testconn->tag = NULL;
-			testconn->metric = -1.0;
-			testconn->prvector = NULL;
-			testconn->pfvector = NULL;
-			testconn->trvector = NULL;
-			testconn->tfvector = NULL;
+    pinname = strrchr(pinspec, '/');
+    if (pinname != NULL) {
+	len = pinname - pinspec;
+	pinname++;
+	for (testinst = instlist; testinst; testinst = testinst->next) {
+	    if (strncmp(testinst->name, pinspec, len) || (testinst->name[len] != '\0'))
+		continue;
+	    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+		if (testconn->refpin && !strcmp(testconn->refpin->name, pinname))
+		    return testconn;
+	    for (testconn = testinst->out_connects; testconn; testconn = testconn->next)
+		if (testconn->refpin && !strcmp(testconn->refpin->name, pinname))
+		    return testconn;
+	}
+    }
+    for (testconn = inputlist; testconn; testconn = testconn->next)
+	if (testconn->refnet && !strcmp(testconn->refnet->name, pinspec))
+	    return testconn;
+    for (testconn = outputlist; testconn; testconn = testconn->next)
+	if (testconn->refnet && !strcmp(testconn->refnet->name, pinspec))
+	    return testconn;
+    return NULL;
+}
 
-			if (isinput) {			// driver (input)
-			    testconn->next = *inputlist;
-			    *inputlist = testconn;
-			}
-			else {				// receiver (output)
-			    testconn->next = *outputlist;
-			    *outputlist = testconn;
-			}
-		    }
-		    else {
-			vtarget = vend + (vstart < vend) ? 1 : -1;
-			while (vstart != vtarget) {
-			    newnet = create_net(netlist);
-			    newnet->name = (char *)malloc(strlen(token) + 6);
-			    sprintf(newnet->name, "%s[%d]", token, vstart);
+/*--------------------------------------------------------------*/
+/* Write "name" to the SDF file "fsdf" as an SDF identifier:	*/
+/* Drop the backslash and trailing space of a verilog escaped	*/
+/* name, and escape any character that is not allowed in an	*/
+/* SDF identifier.						*/
+/*--------------------------------------------------------------*/
 
-			    vstart += (vtarget > vend) ? 1 : -1;
+void sdf_name(FILE *fsdf, char *name)
+{
+    char *sptr;
+
+    sptr = name;
+    if (*sptr == '\\') sptr++;
+    for (; *sptr != '\0'; sptr++) {
+	if ((*sptr == ' ') && (*(sptr + 1) == '\0')) break;
+	if (!isalnum(*sptr) && (*sptr != '_') && (*sptr != '[') && (*sptr != ']'))
+	    putc('\\', fsdf);
+	putc(*sptr, fsdf);
+    }
+}
 
-			    testconn = (connptr)malloc(sizeof(connect));
-			    testconn->refnet = newnet;
-			    testconn->refpin = NULL;	// No associated pin
-			    testconn->refinst = NULL;	// No associated instance
-			    testconn->tag = NULL;
-			    testconn->metric = -1.0;
-			    testconn->prvector = NULL;
-			    testconn->pfvector = NULL;
-			    testconn->trvector = NULL;
-			    testconn->tfvector = NULL;
+/*--------------------------------------------------------------*/
+/* Write the SDF name of pin connection "testconn":		*/
+/* "<instance>/<pin>", or the net name for a module pin.	*/
+/*--------------------------------------------------------------*/
 
-			    if (isinput) {		// driver (input)
-				testconn->next = *inputlist;
-				*inputlist = testconn;
-			    }
-			    else {			// receiver (output)
-				testconn->next = *outputlist;
-				*outputlist = testconn;
-			    }
-			}
-		    }
-		    token = advancetoken(fsrc, ';');	// Get rest of input/output entry
-		    break;
-		}
+void sdf_pin(FILE *fsdf, connptr testconn)
+{
+    if ((testconn->refinst == NULL) || (testconn->refpin == NULL)) {
+	sdf_name(fsdf, testconn->refnet->name);
+	return;
+    }
+    sdf_name(fsdf, testconn->refinst->name);
+    putc('/', fsdf);
+    sdf_name(fsdf, testconn->refpin->name);
+}
 
-		/* Drop through on anything that isn't an input, output, or blank line */
+/*--------------------------------------------------------------*/
+/* Write the IOPATH delays from input pin "testconn" to the	*/
+/* instance output as "(min::max)" for the rising and falling	*/
+/* output.  Delays are read from the collapsed vectors at the	*/
+/* transition times found by compute_arrival_times().  For a	*/
+/* register clock, "dir" is the active clock edge, on which	*/
+/* the output may rise or fall;  otherwise it is EITHER, and	*/
+/* each output edge takes the worst of the input edges that	*/
+/* cause it.							*/
+/*--------------------------------------------------------------*/
 
-	    case GATELIST:
+void sdf_iopath(FILE *fsdf, connptr testconn, short dir)
+{
+    netptr innet;
+    double delay, mindelay, maxdelay, trans, mintrans;
+    short outdir, odir, osense;
+    int e, o;
+
+    // calc_prop_delay() selects the rise or fall table by sense
+
+    innet = testconn->refnet;
+    for (o = 0; o < 2; o++) {
+	odir = (o == 0) ? RISING : FALLING;
+	osense = (o == 0) ? SENSE_POSITIVE : SENSE_NEGATIVE;
+	mindelay = 1E50;
+	maxdelay = -1E50;
+	for (e = 0; e < 2; e++) {
+	    if (!(dir & ((e == 0) ? RISING : FALLING))) continue;
+	    if (dir == EITHER) {
+		outdir = calc_dir(testconn->refpin, (e == 0) ? RISING : FALLING);
+		if (!(outdir & odir)) continue;
+	    }
+	    trans = (innet != NULL) ? innet->atrans[e] : 0.0;
+	    mintrans = (innet != NULL) ? innet->mintrans[e] : 0.0;
+	    delay = calc_prop_delay(trans, testconn, osense, MAXIMUM_TIME);
+	    if (delay > maxdelay) maxdelay = delay;
+	    delay = calc_prop_delay(mintrans, testconn, osense, MINIMUM_TIME);
+	    if (delay < mindelay) mindelay = delay;
+	}
+	if (maxdelay <= -1E50)
+	    fprintf(fsdf, " ()");
+	else
+	    fprintf(fsdf, " (%g::%g)", mindelay, maxdelay);
+    }
+}
 
-		if (!strcasecmp(token, "endmodule")) {
-		    section = MODULE;
-		    break;    
-		}
+/*--------------------------------------------------------------*/
+/* Write an SDF file for back-annotated gate-level simulation	*/
+/* to "fsdf":  INTERCONNECT delays from the wire delay of each	*/
+/* receiver (from --delay, --spef, --pi-model, or the wire load	*/
+/* model), and IOPATH delays for each instance arc.  Must be	*/
+/* called after compute_arrival_times().  The file is written	*/
+/* as a stream, one net or instance at a time.			*/
+/*--------------------------------------------------------------*/
 
-		/* Confirm that the token is a known cell, and continue parsing line if so */
-		/* Otherwise, parse to semicolon line end and continue */
+void write_sdf(netptr netlist, instptr instlist, FILE *fsdf)
+{
+    netptr testnet;
+    instptr testinst;
+    connptr testconn, clkconn, outconn;
+    char *design;
+    short dir;
+    int i;
 
-		for (testcell = cells; testcell; testcell = testcell->next)
-		    if (!strcasecmp(testcell->name, token))
-			break;
+    design = (topmodule != NULL) ? topmodule : "";
+    fprintf(fsdf, "(DELAYFILE\n");
+    fprintf(fsdf, " (SDFVERSION \"3.0\")\n");
+    fprintf(fsdf, " (DESIGN \"%s\")\n", design);
+    fprintf(fsdf, " (VENDOR \"Open Circuit Design\")\n");
+    fprintf(fsdf, " (PROGRAM \"Vesta\")\n");
+    fprintf(fsdf, " (VERSION \"0.2\")\n");
+    fprintf(fsdf, " (DIVIDER /)\n");
+    fprintf(fsdf, " (TIMESCALE 1ps)\n");
 
-		if (testcell != NULL) {
-		    section = INSTANCE;
-		    newinst = (instptr)malloc(sizeof(instance));
-		    newinst->next = *instlist;
-		    *instlist = newinst;
-		    newinst->refcell = testcell;
-		    newinst->in_connects = NULL;
-		    newinst->out_connects = NULL;
-		}
-		else {
-		    /* Ignore all wire and assign statements	*/
-		    /* Qflow does not generate these, but other	*/
-		    /* synthesis tools may.			*/
+    // Wire delays, in one cell for the top level
 
-		    if (!strcasecmp(token, "assign") && (verbose > 0)) {
-			fprintf(stdout, "Wire assignments are not handled!\n");
-		    }
-		    else if (strcasecmp(token, "wire") && (verbose > 0)) {
-			fprintf(stdout, "Unknown cell \"%s\" instanced.\n",
-				token);
-		    }
-		    token = advancetoken(fsrc, ';');	// Get rest of entry, and ignore
-		}
-		break;
+    fprintf(fsdf, " (CELL\n  (CELLTYPE \"%s\")\n  (INSTANCE)\n", design);
+    fprintf(fsdf, "  (DELAY\n   (ABSOLUTE\n");
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	for (i = 0; i < testnet->fanout; i++) {
+	    testconn = testnet->receivers[i];
+	    if (testconn->wiredelay == 0.0) continue;
+	    fprintf(fsdf, "    (INTERCONNECT ");
+	    if ((testnet->driver != NULL) && (testnet->driver->refinst != NULL))
+		sdf_pin(fsdf, testnet->driver);
+	    else
+		sdf_name(fsdf, testnet->name);
+	    putc(' ', fsdf);
+	    sdf_pin(fsdf, testconn);
+	    fprintf(fsdf, " (%g::%g) (%g::%g))\n", testconn->wiredelay,
+			testconn->wiredelay, testconn->wiredelay, testconn->wiredelay);
+	}
+    }
+    fprintf(fsdf, "   )\n  )\n )\n");
 
-	    case INSTANCE:
-		newinst->name = strdup(token);
-		token = advancetoken(fsrc, '(');	// Find beginning of pin list
-		section = INSTPIN;
-		break;
+    // Cell delays
 
-	    case INSTPIN:
-		if (*token == '.') {
-		    newconn = (connptr)malloc(sizeof(connect));
-		    // Pin name is in (token + 1)
-		    for (testpin = testcell->pins; testpin; testpin = testpin->next) {
-			if (!strcmp(testpin->name, token + 1))
-			    break;
-		    }
-		    // Sanity check
-		    if (testpin == NULL) {
-			fprintf(stderr, "No such pin \"%s\" in cell \"%s\"!\n",
-				token + 1, testcell->name);
-		    }
-		    else {
-			if (testpin->type & OUTPUT) {
-			    newconn->next = newinst->out_connects;
-			    newinst->out_connects = newconn;
-			}
-			else {
-			    newconn->next = newinst->in_connects;
-			    newinst->in_connects = newconn;
-			}
-		    }
-		    newconn->refinst = newinst;
-		    newconn->refpin = testpin;
-		    newconn->refnet = NULL;
-		    newconn->tag = NULL;
-		    newconn->metric = -1.0;
-		    newconn->prvector = NULL;
-		    newconn->pfvector = NULL;
-		    newconn->trvector = NULL;
-		    newconn->tfvector = NULL;
-		    token = advancetoken(fsrc, '(');	// Read to beginning of pin name
-		    section = PINCONN;
-		}
-		else if (*token == ';') {
-		    // End of instance record
-		    section = GATELIST;
-		}
-		else if (*token != ',' && *token != ')') {
-		    fprintf(stderr, "Unexpected entry in instance pin connection list!\n");
-		    token = advancetoken(fsrc, ';');	// Read to end-of-line
-		    section = GATELIST;
-		}
-		break;
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	outconn = testinst->out_connects;
+	if (outconn == NULL) continue;
+	fprintf(fsdf, " (CELL\n  (CELLTYPE \"%s\")\n  (INSTANCE ",
+		testinst->refcell->name);
+	sdf_name(fsdf, testinst->name);
+	fprintf(fsdf, ")\n  (DELAY\n   (ABSOLUTE\n");
+
+	if (testinst->index < 0) {
+	    clkconn = find_register_clock(testinst);
+	    if (clkconn != NULL) {
+		dir = register_edge(testinst);
+		fprintf(fsdf, "    (IOPATH (%s ", (dir == RISING) ? "posedge" : "negedge");
+		sdf_name(fsdf, clkconn->refpin->name);
+		fprintf(fsdf, ") ");
+		sdf_name(fsdf, outconn->refpin->name);
+		sdf_iopath(fsdf, clkconn, dir);
+		fprintf(fsdf, ")\n");
+	    }
 
-	    case PINCONN:
-		// Token is net name
-		for (testnet = *netlist; testnet; testnet = testnet->next) {
-		    if (!strcmp(testnet->name, token))
-			break;
-		}
-		if (testnet == NULL) {
-		    // This is a new net, and we need to record it
-		    newnet = create_net(netlist);
-		    newnet->name = strdup(token);
-		    newconn->refnet = newnet;
-		}
-		else
-		    newconn->refnet = testnet;
-		section = INSTPIN;
-		break;
+	    // A latch also passes its data input while it is open
+
+	    testconn = NULL;
+	    if (testinst->refcell->type & LATCH)
+		testconn = find_latch_data(testinst);
+	    if ((testconn != NULL) && ((testconn->prvector != NULL) ||
+			(testconn->pfvector != NULL))) {
+		fprintf(fsdf, "    (IOPATH ");
+		sdf_name(fsdf, testconn->refpin->name);
+		putc(' ', fsdf);
+		sdf_name(fsdf, outconn->refpin->name);
+		sdf_iopath(fsdf, testconn, EITHER);
+		fprintf(fsdf, ")\n");
+	    }
 	}
-	if (section == PINCONN)
-	    token = advancetoken(fsrc, ')');	// Name token parsing
-	else
-	    token = advancetoken(fsrc, 0);
+	else {
+	    for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+		if ((testconn->prvector == NULL) && (testconn->pfvector == NULL))
+		    continue;
+		fprintf(fsdf, "    (IOPATH ");
+		sdf_name(fsdf, testconn->refpin->name);
+		putc(' ', fsdf);
+		sdf_name(fsdf, outconn->refpin->name);
+		sdf_iopath(fsdf, testconn, EITHER);
+		fprintf(fsdf, ")\n");
+	    }
+	}
+	fprintf(fsdf, "   )\n  )\n )\n");
     }
+    fprintf(fsdf, ")\n");
 }
 
 /*--------------------------------------------------------------*/
-/* For each net, go through the list of receivers and add the	*/
-/* contributions of each to the total load.  This is either	*/
-/* the input pin capacitance, if the receiver is a pin, or the	*/
-/* designated output load (given on the command line), if the	*/
-/* receiver is an output pin.					*/
+/* Trace the fan-in cone of a net back to the module inputs	*/
+/* and to the clock (or enable) pins of registers.  Register	*/
+/* data inputs are cut, and become inputs of the cone.		*/
 /*--------------------------------------------------------------*/
 
-void
-computeLoads(netptr netlist, instptr instlist, double out_load)
+void trace_cone(netptr endnet)
 {
+    netptr *stack, testnet;
+    connptr driver, testconn;
     instptr testinst;
-    pinptr testpin;
-    netptr testnet, driver, loadnet;
+    int sp, maxsp;
+    char isreg;
+
+    if (endnet->flags & CONE_TRACED) return;
+
+    maxsp = 64;
+    stack = (netptr *)malloc(maxsp * sizeof(netptr));
+    sp = 0;
+    endnet->flags |= CONE_TRACED;
+    stack[sp++] = endnet;
+
+    while (sp > 0) {
+	testnet = stack[--sp];
+	driver = testnet->driver;
+	if ((driver == NULL) || (driver->refinst == NULL)) continue;
+	testinst = driver->refinst;
+	if (testinst->flags & CONE_INST) continue;
+	testinst->flags |= CONE_INST;
+
+	isreg = (testinst->refcell->type & (DFF | LATCH)) ? 1 : 0;
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    if (testconn->refnet == NULL) continue;
+	    if (isreg && !(testconn->refpin->type & (DFFCLK | LATCHEN))) continue;
+	    if (testconn->refnet->flags & CONE_TRACED) continue;
+	    testconn->refnet->flags |= CONE_TRACED;
+	    if (sp == maxsp) {
+		maxsp <<= 1;
+		stack = (netptr *)realloc(stack, maxsp * sizeof(netptr));
+	    }
+	    stack[sp++] = testconn->refnet;
+	}
+    }
+    free(stack);
+}
+
+/*--------------------------------------------------------------*/
+/* Add a path endpoint to the cone.  For a register or gate	*/
+/* input, the whole instance is added and all of its inputs	*/
+/* are traced.  For a module output, the net is traced.		*/
+/*--------------------------------------------------------------*/
+
+void add_cone_endpoint(connptr endpoint)
+{
     connptr testconn;
-    int i;
+    instptr testinst = endpoint->refinst;
 
-    for (testnet = netlist; testnet; testnet = testnet->next) {
-	for (i = 0; i < testnet->fanout; i++) {
-	    testconn = testnet->receivers[i];
-	    testpin = testconn->refpin;
-	    if (testpin == NULL) {
-		testnet->loadr += out_load;
-		testnet->loadf += out_load;
+    if (testinst == NULL) {
+	endpoint->refnet->flags |= CONE_OUTPUT;
+	trace_cone(endpoint->refnet);
+	return;
+    }
+    testinst->flags |= CONE_INST;
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	if (testconn->refnet != NULL)
+	    trace_cone(testconn->refnet);
+}
+
+/*--------------------------------------------------------------*/
+/* Write a net name to a verilog file, as an escaped		*/
+/* identifier if it is not a simple identifier.			*/
+/*--------------------------------------------------------------*/
+
+void write_verilog_name(FILE *fout, char *name)
+{
+    char *cptr;
+
+    if (*name == '\\') {
+	fprintf(fout, "%s ", name);
+	return;
+    }
+    for (cptr = name; *cptr; cptr++) {
+	if (isalpha(*cptr) || (*cptr == '_')) continue;
+	if ((cptr > name) && (isdigit(*cptr) || (*cptr == '$'))) continue;
+	break;
+    }
+    if (*cptr == '\0')
+	fprintf(fout, "%s", name);
+    else
+	fprintf(fout, "\\%s ", name);
+}
+
+/*--------------------------------------------------------------*/
+/* Return 1 if pin "testconn" of an instance in the extracted	*/
+/* cone keeps its net in the extracted netlist, where "isout"	*/
+/* is 1 for an output pin.  Instances that only load cone nets	*/
+/* keep just their inputs on traced nets, so that they add	*/
+/* load without adding paths of their own.			*/
+/*--------------------------------------------------------------*/
+
+int cone_pin(connptr testconn, char isout)
+{
+    if (testconn->refnet == NULL) return 0;
+    if (testconn->refinst->flags & CONE_INST) return 1;
+    if (isout) return 0;
+    return (testconn->refnet->flags & CONE_TRACED) ? 1 : 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Write the name of the unconnected wire on output pin		*/
+/* "testconn" of an instance that only loads cone nets.		*/
+/*--------------------------------------------------------------*/
+
+void write_cone_open(FILE *fout, connptr testconn)
+{
+    char *iname = testconn->refinst->name;
+
+    if (*iname == '\\') iname++;
+    fprintf(fout, "\\%s/%s ", iname, testconn->refpin->name);
+}
+
+/*--------------------------------------------------------------*/
+/* Extract the fan-in cones of a set of path endpoints into a	*/
+/* self-contained structural verilog netlist.  "spec" is	*/
+/* either a number N, in which case the endpoints of the N	*/
+/* worst maximum delay paths in "orderedpaths" are used, or	*/
+/* the name of an endpoint, given as <instance>/<pin>, an	*/
+/* instance name, or a net name.  Gates outside of the cone	*/
+/* that load nets in the cone are included with only their	*/
+/* inputs on those nets connected, and their outputs on wires	*/
+/* of their own, so that the cone is timed with the same net	*/
+/* loads as the full netlist.					*/
+/*								*/
+/* Return the number of endpoints extracted, or -1 on error.	*/
+/*--------------------------------------------------------------*/
+
+int extract_cone(char *spec, ddataptr *orderedpaths, int numpaths,
+		netptr netlist, instptr instlist, connptr outputlist, char *conefile)
+{
+    FILE *fout;
+    netptr testnet;
+    instptr testinst;
+    connptr testconn, driver;
+    char *endp, *pinname;
+    int i, numends, numinsts, numnets, count;
+
+    numends = 0;
+    count = (int)strtol(spec, &endp, 10);
+
+    if ((*endp == '\0') && (endp != spec)) {
+	if (count > numpaths) count = numpaths;
+	for (i = 0; i < count; i++) {
+	    add_cone_endpoint(orderedpaths[i]->backtrace->receiver);
+	    numends++;
+	}
+    }
+    else {
+	pinname = strrchr(spec, '/');
+	if (pinname != NULL) *pinname = '\0';
+	for (testinst = instlist; testinst; testinst = testinst->next)
+	    if (!strcmp(testinst->name, spec))
+		break;
+	if (pinname != NULL) *pinname++ = '/';
+
+	if (testinst == NULL) {
+	    for (testinst = instlist; testinst; testinst = testinst->next)
+		if (!strcmp(testinst->name, spec))
+		    break;
+	    pinname = NULL;
+	}
+	if (testinst != NULL) {
+	    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+		if ((pinname == NULL) || !strcmp(testconn->refpin->name, pinname))
+		    break;
+	    if (testconn == NULL) {
+		fprintf(stderr, "No input pin \"%s\" on instance \"%s\"\n",
+			pinname, testinst->name);
+		return -1;
 	    }
-	    else {
-		testnet->loadr += testpin->capr;
-		testnet->loadf += testpin->capf;
+	    add_cone_endpoint(testconn);
+	    numends++;
+	}
+	else {
+	    for (testnet = netlist; testnet; testnet = testnet->next)
+		if (!strcmp(testnet->name, spec))
+		    break;
+	    if (testnet == NULL) {
+		fprintf(stderr, "No endpoint \"%s\" found for cone extraction\n", spec);
+		return -1;
 	    }
+	    testnet->flags |= CONE_OUTPUT;
+	    trace_cone(testnet);
+	    numends++;
 	}
     }
 
-    // For each instance input pin, collapse the pin's lookup table
-    // to a vector by interpolating/extrapolating the table at the
-    // calculated output load.  Save this vector in the connection
-    // record for the pin.
+    // Receivers of traced nets that are outside of the cone are
+    // kept as loads, so that net loads are the same as in the
+    // full netlist.
+
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->flags & CONE_TRACED)) continue;
+	for (i = 0; i < testnet->fanout; i++) {
+	    testinst = testnet->receivers[i]->refinst;
+	    if ((testinst != NULL) && !(testinst->flags & CONE_INST))
+		testinst->flags |= CONE_LOAD;
+	}
+    }
+
+    // Find all nets connected to instances in the cone.  Module
+    // outputs in the cone remain outputs of the extracted netlist.
 
+    numinsts = 0;
     for (testinst = instlist; testinst; testinst = testinst->next) {
-	loadnet = testinst->out_connects->refnet;
-	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
-	    testpin = testconn->refpin;
+	if (!(testinst->flags & CONE_MEMBER)) continue;
+	numinsts++;
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	    if (cone_pin(testconn, 0)) testconn->refnet->flags |= CONE_USED;
+	for (testconn = testinst->out_connects; testconn; testconn = testconn->next)
+	    if (cone_pin(testconn, 1)) testconn->refnet->flags |= CONE_USED;
+    }
+    for (testconn = outputlist; testconn; testconn = testconn->next)
+	if (testconn->refnet->flags & CONE_USED)
+	    testconn->refnet->flags |= CONE_OUTPUT;
+
+    // Nets not driven by an instance in the cone are inputs;
+    // a net cannot be both input and output, so inputs win.
+
+    numnets = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->flags & (CONE_USED | CONE_OUTPUT))) continue;
+	testnet->flags |= CONE_USED;
+	numnets++;
+	driver = testnet->driver;
+	if ((driver == NULL) || (driver->refinst == NULL) ||
+		!(driver->refinst->flags & CONE_MEMBER))
+	    testnet->flags &= ~CONE_OUTPUT;
+    }
+
+    fout = fopen(conefile, "w");
+    if (fout == NULL) {
+	fprintf(stderr, "Cannot open %s for writing\n", conefile);
+	return -1;
+    }
+
+    fprintf(fout, "/* Fan-in cone of %d endpoint%s (%s) */\n\n", numends,
+		(numends == 1) ? "" : "s", spec);
+    fprintf(fout, "module %s_cone (", (topmodule) ? topmodule : "vesta");
+    i = 0;
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->flags & CONE_USED)) continue;
+	driver = testnet->driver;
+	if ((testnet->flags & CONE_OUTPUT) || (driver == NULL) ||
+		(driver->refinst == NULL) || !(driver->refinst->flags & CONE_MEMBER)) {
+	    fprintf(fout, (i == 0) ? "\n    " : ",\n    ");
+	    write_verilog_name(fout, testnet->name);
+	    i++;
+	}
+    }
+    fprintf(fout, "\n);\n\n");
+
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->flags & CONE_USED)) continue;
+	driver = testnet->driver;
+	if ((driver == NULL) || (driver->refinst == NULL) ||
+		!(driver->refinst->flags & CONE_MEMBER)) {
+	    fprintf(fout, "input ");
+	    write_verilog_name(fout, testnet->name);
+	    fprintf(fout, ";\n");
+	}
+    }
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->flags & CONE_OUTPUT)) continue;
+	fprintf(fout, "output ");
+	write_verilog_name(fout, testnet->name);
+	fprintf(fout, ";\n");
+    }
+    fprintf(fout, "\n");
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (!(testnet->flags & CONE_USED)) continue;
+	if (testnet->flags & CONE_OUTPUT) continue;
+	driver = testnet->driver;
+	if ((driver == NULL) || (driver->refinst == NULL) ||
+		!(driver->refinst->flags & CONE_MEMBER)) continue;
+	fprintf(fout, "wire ");
+	write_verilog_name(fout, testnet->name);
+	fprintf(fout, ";\n");
+    }
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	if ((testinst->flags & CONE_MEMBER) != CONE_LOAD) continue;
+	for (testconn = testinst->out_connects; testconn; testconn = testconn->next) {
+	    if (testconn->refnet == NULL) continue;
+	    fprintf(fout, "wire ");
+	    write_cone_open(fout, testconn);
+	    fprintf(fout, ";\n");
+	}
+    }
+    fprintf(fout, "\n");
 
-	    if (testpin->propdelr)
-		testconn->prvector = table_collapse(testpin->propdelr, loadnet->loadr);
-	    if (testpin->propdelf)
-		testconn->pfvector = table_collapse(testpin->propdelf, loadnet->loadf);
-	    if (testpin->transr)
-		testconn->trvector = table_collapse(testpin->transr, loadnet->loadr);
-	    if (testpin->transf)
-		testconn->tfvector = table_collapse(testpin->transf, loadnet->loadf);
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	if (!(testinst->flags & CONE_MEMBER)) continue;
+	fprintf(fout, "%s ", testinst->refcell->name);
+	write_verilog_name(fout, testinst->name);
+	fprintf(fout, " (");
+	i = 0;
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    if (!cone_pin(testconn, 0)) continue;
+	    fprintf(fout, "%s.%s(", (i++ == 0) ? "" : ", ", testconn->refpin->name);
+	    write_verilog_name(fout, testconn->refnet->name);
+	    fprintf(fout, ")");
+	}
+	for (testconn = testinst->out_connects; testconn; testconn = testconn->next) {
+	    if (testconn->refnet == NULL) continue;
+	    fprintf(fout, "%s.%s(", (i++ == 0) ? "" : ", ", testconn->refpin->name);
+	    if (cone_pin(testconn, 1))
+		write_verilog_name(fout, testconn->refnet->name);
+	    else
+		write_cone_open(fout, testconn);
+	    fprintf(fout, ")");
 	}
+	fprintf(fout, ");\n");
     }
+    fprintf(fout, "\nendmodule\n");
+    fclose(fout);
+
+    fprintf(stdout, "Wrote fan-in cone of %d endpoint%s to %s (%d instances, %d nets).\n",
+		numends, (numends == 1) ? "" : "s", conefile, numinsts, numnets);
+    return numends;
 }
 
 /*--------------------------------------------------------------*/
-/* Assign types to each net.  This identifies which nets are	*/
-/* clock inputs, which are latch enable inputs, and which are	*/
-/* asynchronous set/reset inputs,.				*/
-/*								*/
-/* Whenever a clock input to a flop is found, add the		*/
-/* connection record to clockedlist				*/
-/*								*/
-/* For diagnostics, return the number of entries in clockedlist	*/
+/* Convert the pointers in object "obj" of kind "kind" and	*/
+/* "size" bytes with "reloc", which turns a pointer into an	*/
+/* offset when saving the database, and an offset into a	*/
+/* pointer when loading it.  This is the one place that lists	*/
+/* the pointer fields of each database structure.		*/
 /*--------------------------------------------------------------*/
 
-int assign_net_types(netptr netlist, connlistptr *clockedlist)
+void db_relocate(void *obj, int kind, unsigned long long size,
+		void *(*reloc)(void *, void *), void *data)
 {
-    int i, numterms;
+    lutableptr testtable;
+    pinptr testpin;
+    cellptr testcell;
     netptr testnet;
-    connptr testrcvr;
+    connptr testconn;
+    instptr testinst;
+    void **ptrs;
+    unsigned long long i;
+
+    switch (kind) {
+	case DB_PTRS:
+	    ptrs = (void **)obj;
+	    for (i = 0; i < size / sizeof(void *); i++)
+		ptrs[i] = (*reloc)(ptrs[i], data);
+	    break;
+	case DB_TABLE:
+	    testtable = (lutableptr)obj;
+	    testtable->name = (*reloc)(testtable->name, data);
+	    testtable->idx1.times = (*reloc)(testtable->idx1.times, data);
+	    testtable->idx2.caps = (*reloc)(testtable->idx2.caps, data);
+	    testtable->values = (*reloc)(testtable->values, data);
+	    testtable->rspan1 = (*reloc)(testtable->rspan1, data);
+	    testtable->rspan2 = (*reloc)(testtable->rspan2, data);
+	    testtable->next = (*reloc)(testtable->next, data);
+	    break;
+	case DB_PIN:
+	    testpin = (pinptr)obj;
+	    testpin->name = (*reloc)(testpin->name, data);
+	    testpin->alias = (*reloc)(testpin->alias, data);
+	    testpin->propdelr = (*reloc)(testpin->propdelr, data);
+	    testpin->propdelf = (*reloc)(testpin->propdelf, data);
+	    testpin->transr = (*reloc)(testpin->transr, data);
+	    testpin->transf = (*reloc)(testpin->transf, data);
+	    testpin->minpropdelr = (*reloc)(testpin->minpropdelr, data);
+	    testpin->minpropdelf = (*reloc)(testpin->minpropdelf, data);
+	    testpin->mintransr = (*reloc)(testpin->mintransr, data);
+	    testpin->mintransf = (*reloc)(testpin->mintransf, data);
+	    testpin->recovery = (*reloc)(testpin->recovery, data);
+	    testpin->removal = (*reloc)(testpin->removal, data);
+	    testpin->refcell = (*reloc)(testpin->refcell, data);
+	    testpin->next = (*reloc)(testpin->next, data);
+	    break;
+	case DB_CELL:
+	    testcell = (cellptr)obj;
+	    testcell->name = (*reloc)(testcell->name, data);
+	    testcell->function = (*reloc)(testcell->function, data);
+	    testcell->pins = (*reloc)(testcell->pins, data);
+	    testcell->next = (*reloc)(testcell->next, data);
+	    break;
+	case DB_NET:
+	    testnet = (netptr)obj;
+	    testnet->name = (*reloc)(testnet->name, data);
+	    testnet->driver = (*reloc)(testnet->driver, data);
+	    testnet->receivers = (*reloc)(testnet->receivers, data);
+	    testnet->next = (*reloc)(testnet->next, data);
+	    break;
+	case DB_CONN:
+	    testconn = (connptr)obj;
+	    testconn->refinst = (*reloc)(testconn->refinst, data);
+	    testconn->refpin = (*reloc)(testconn->refpin, data);
+	    testconn->refnet = (*reloc)(testconn->refnet, data);
+	    testconn->prvector = (*reloc)(testconn->prvector, data);
+	    testconn->pfvector = (*reloc)(testconn->pfvector, data);
+	    testconn->prminvector = (*reloc)(testconn->prminvector, data);
+	    testconn->pfminvector = (*reloc)(testconn->pfminvector, data);
+	    testconn->trvector = (*reloc)(testconn->trvector, data);
+	    testconn->tfvector = (*reloc)(testconn->tfvector, data);
+	    testconn->trminvector = (*reloc)(testconn->trminvector, data);
+	    testconn->tfminvector = (*reloc)(testconn->tfminvector, data);
+	    testconn->pinname = (*reloc)(testconn->pinname, data);
+	    testconn->next = (*reloc)(testconn->next, data);
+	    break;
+	case DB_INST:
+	    testinst = (instptr)obj;
+	    testinst->name = (*reloc)(testinst->name, data);
+	    testinst->refcell = (*reloc)(testinst->refcell, data);
+	    testinst->in_connects = (*reloc)(testinst->in_connects, data);
+	    testinst->out_connects = (*reloc)(testinst->out_connects, data);
+	    testinst->cellname = (*reloc)(testinst->cellname, data);
+	    testinst->next = (*reloc)(testinst->next, data);
+	    break;
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Find the record of the object at address "ptr" in the	*/
+/* database writer "dbw".  Return the index of the hash table	*/
+/* slot, which holds -1 if the object is not there.		*/
+/*--------------------------------------------------------------*/
+
+unsigned int db_find(dbwriter *dbw, void *ptr)
+{
+    unsigned long long hval;
+    unsigned int h;
+
+    hval = (unsigned long long)(size_t)ptr * 0x9E3779B97F4A7C15ULL;
+    for (h = (unsigned int)(hval >> 32) & dbw->mask; ; h = (h + 1) & dbw->mask)
+	if ((dbw->hash[h] < 0) || (dbw->objects[dbw->hash[h]] == ptr))
+	    return h;
+}
+
+/*--------------------------------------------------------------*/
+/* Add the object at "ptr" of "size" bytes and kind "kind" to	*/
+/* the database writer "dbw", if it is not NULL and not there	*/
+/* already.  Return 1 if the object was added.			*/
+/*--------------------------------------------------------------*/
+
+int db_add(dbwriter *dbw, void *ptr, unsigned long long size, int kind)
+{
+    unsigned int h;
+    int i;
+
+    if (ptr == NULL) return 0;
+
+    // Keep the hash table no more than half full
+
+    if (2 * (dbw->numrecords + 1) > dbw->mask) {
+	free(dbw->hash);
+	dbw->mask = 2 * (dbw->mask + 1) - 1;
+	dbw->hash = (int *)malloc((dbw->mask + 1) * sizeof(int));
+	for (h = 0; h <= dbw->mask; h++) dbw->hash[h] = -1;
+	for (i = 0; i < dbw->numrecords; i++)
+	    dbw->hash[db_find(dbw, dbw->objects[i])] = i;
+    }
+
+    h = db_find(dbw, ptr);
+    if (dbw->hash[h] >= 0) return 0;
+
+    if (dbw->numrecords == dbw->maxrecords) {
+	dbw->maxrecords <<= 1;
+	dbw->records = (dbrecord *)realloc(dbw->records,
+			dbw->maxrecords * sizeof(dbrecord));
+	dbw->objects = (void **)realloc(dbw->objects,
+			dbw->maxrecords * sizeof(void *));
+    }
+    i = dbw->numrecords++;
+    dbw->hash[h] = i;
+    dbw->objects[i] = ptr;
+    dbw->records[i].offset = dbw->size;
+    dbw->records[i].size = size;
+    dbw->records[i].kind = kind;
+    dbw->records[i].pad = 0;
+    dbw->size += (size + 7) & ~7ULL;
+    return 1;
+}
+
+/*--------------------------------------------------------------*/
+/* Add a string, a lookup table, or a connection and the	*/
+/* objects that they point to (other than instances and nets)	*/
+/* to the database writer "dbw".				*/
+/*--------------------------------------------------------------*/
+
+void db_add_string(dbwriter *dbw, char *str)
+{
+    if (str != NULL) db_add(dbw, str, strlen(str) + 1, DB_RAW);
+}
+
+void db_add_table(dbwriter *dbw, lutableptr table)
+{
+    int size2;
+
+    if (!db_add(dbw, table, sizeof(lutable), DB_TABLE)) return;
+    db_add_string(dbw, table->name);
+    db_add(dbw, table->idx1.times, table->size1 * sizeof(double), DB_RAW);
+    db_add(dbw, table->idx2.caps, table->size2 * sizeof(double), DB_RAW);
+    db_add(dbw, table->rspan1, table->size1 * sizeof(double), DB_RAW);
+    db_add(dbw, table->rspan2, table->size2 * sizeof(double), DB_RAW);
+    size2 = (table->size2 > 0) ? table->size2 : 1;
+    db_add(dbw, table->values, table->size1 * size2 * sizeof(double), DB_RAW);
+}
+
+void db_add_conn(dbwriter *dbw, connptr testconn)
+{
     pinptr testpin;
-    connlistptr newclocked;
 
-    numterms = 0;
+    if (!db_add(dbw, testconn, sizeof(connect), DB_CONN)) return;
+    db_add_string(dbw, testconn->pinname);
+    testpin = testconn->refpin;
+    if (testpin == NULL) return;
+    if (testpin->propdelr) {
+	db_add(dbw, testconn->prvector, testpin->propdelr->size1 * sizeof(double), DB_RAW);
+	db_add(dbw, testconn->prminvector, testpin->propdelr->size1 * sizeof(double), DB_RAW);
+    }
+    if (testpin->propdelf) {
+	db_add(dbw, testconn->pfvector, testpin->propdelf->size1 * sizeof(double), DB_RAW);
+	db_add(dbw, testconn->pfminvector, testpin->propdelf->size1 * sizeof(double), DB_RAW);
+    }
+    if (testpin->transr) {
+	db_add(dbw, testconn->trvector, testpin->transr->size1 * sizeof(double), DB_RAW);
+	db_add(dbw, testconn->trminvector, testpin->transr->size1 * sizeof(double), DB_RAW);
+    }
+    if (testpin->transf) {
+	db_add(dbw, testconn->tfvector, testpin->transf->size1 * sizeof(double), DB_RAW);
+	db_add(dbw, testconn->tfminvector, testpin->transf->size1 * sizeof(double), DB_RAW);
+    }
+}
 
-    for (testnet = netlist; testnet; testnet = testnet->next) {
-	for (i = 0; i < testnet->fanout; i++) {
-	    testrcvr = testnet->receivers[i];
-	    testpin = testrcvr->refpin;
-	    if (testpin == NULL)
-		testnet->type |= OUTTERM;
-	    else {
-		switch (testpin->type & (DFFMASK | LATCHMASK)) {
-		    case DFFCLK:
-			testnet->type |= CLOCK;
-			newclocked = (connlistptr)malloc(sizeof(connlist));
-			newclocked->connection = testrcvr;
-			newclocked->next = *clockedlist;
-			*clockedlist = newclocked;
-			numterms++;
-			break;
-		    case DFFIN:
-			testnet->type |= TERMINAL;
-			break;
-		    case DFFSET:
-		    case DFFRST:
-			testnet->type |= ASYNC;
-			break;
-		    case LATCHIN:
-			testnet->type |= LATCHTERM;
-			break;
-		    case LATCHEN:
-			testnet->type |= ENABLE;
-			break;
-		}
-	    }
-	}
+/*--------------------------------------------------------------*/
+/* Relocation functions for db_relocate():  Turn a pointer into	*/
+/* the offset of its object in the file being written, or an	*/
+/* offset into a pointer into the mapped file "data".		*/
+/*--------------------------------------------------------------*/
+
+void *db_to_offset(void *ptr, void *data)
+{
+    dbwriter *dbw = (dbwriter *)data;
+    unsigned int h;
+
+    if (ptr == NULL) return NULL;
+    h = db_find(dbw, ptr);
+    if (dbw->hash[h] < 0) {
+	dbw->errors++;
+	return NULL;
     }
-    return numterms;
+    return (void *)(size_t)dbw->records[dbw->hash[h]].offset;
+}
+
+void *db_to_pointer(void *ptr, void *data)
+{
+    if (ptr == NULL) return NULL;
+    return (char *)data + (size_t)ptr;
 }
 
 /*--------------------------------------------------------------*/
-/* Create the links representing the netlist connections.	*/
-/*								*/
-/* The verilogRead() routine added all nets and instances, and	*/
-/* for each instance, generated a list of net connections to	*/
-/* each pin.  To make the netlist easily traversible, this	*/
-/* routine does the following:					*/
-/*								*/
-/* For each instance, work through the list of pin		*/
-/*	connections.  If the pin is an output, then add the	*/
-/*	connection as the net's driver entry.  If the pin is	*/
-/*	an input, then add the connection to the list of the	*/
-/*	net's receivers, and increment the net's fanout.	*/
-/*								*/
-/* For each module input, add the input connection as the	*/
-/*	net's driver (flag an error if the net already has a	*/
-/*	driver).						*/
-/*								*/
-/* For each module output, add the output connection as one of	*/
-/*	the net's receivers (it may be the only one).		*/
+/* Save the linked and annotated timing graph to the file	*/
+/* "dbname":  All nets, instances, and connections, the cells,	*/
+/* pins, and tables that they use, the collapsed delay and	*/
+/* transition vectors, and the net types.  State that belongs	*/
+/* to one analysis (path tags, clock arrival times) is not	*/
+/* saved.							*/
 /*								*/
+/* Return 0 on success, 1 on failure.				*/
 /*--------------------------------------------------------------*/
 
-void
-createLinks(netptr netlist, instptr instlist, connptr inputlist, connptr outputlist)
+int save_db(char *dbname, netptr netlist, instptr instlist, connptr inputlist,
+		connptr outputlist, cellptr cells, lutableptr tables)
 {
+    FILE *fdb;
+    dbwriter dbw;
+    dbheader *header;
+    lutableptr testtable;
+    cellptr testcell;
+    pinptr testpin;
     netptr testnet;
     instptr testinst;
     connptr testconn;
+    char *image, *obj;
+    int i, result;
 
-    for (testinst = instlist; testinst; testinst = testinst->next) {
-	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
-	    testnet = testconn->refnet;
-	    testnet->fanout++;
-	    if (testnet->receivers == NULL)
-		testnet->receivers = (connptr *)malloc(sizeof(connptr));
-
-	    else
-		testnet->receivers = (connptr *)realloc(testnet->receivers,
-				testnet->fanout * sizeof(connptr));
-
-	    testnet->receivers[testnet->fanout - 1] = testconn;
-	} 
-
-	for (testconn = testinst->out_connects; testconn; testconn = testconn->next) {
-	    testnet = testconn->refnet;
-	    testnet->driver = testconn;
-	} 
+    fdb = fopen(dbname, "w");
+    if (fdb == NULL) {
+	fprintf(stderr, "Cannot open %s for writing\n", dbname);
+	return 1;
     }
 
-    for (testconn = inputlist; testconn; testconn = testconn->next) {
-	testnet = testconn->refnet;
-	if (testnet->driver != NULL)
-	    fprintf(stderr, "Error:  Input pin \"%s\" has an internal driver!\n",
-			testnet->name);
-	// else
-	//    testnet->driver = testconn;	// Don't do this, makes connectivity circular
+    dbw.numrecords = 0;
+    dbw.maxrecords = 1024;
+    dbw.records = (dbrecord *)malloc(dbw.maxrecords * sizeof(dbrecord));
+    dbw.objects = (void **)malloc(dbw.maxrecords * sizeof(void *));
+    dbw.mask = 2047;
+    dbw.hash = (int *)malloc((dbw.mask + 1) * sizeof(int));
+    for (i = 0; i <= dbw.mask; i++) dbw.hash[i] = -1;
+    dbw.size = (sizeof(dbheader) + 7) & ~7ULL;
+    dbw.errors = 0;
+
+    // Lay out every object in the file
+
+    for (testtable = tables; testtable; testtable = testtable->next)
+	db_add_table(&dbw, testtable);
+    for (testcell = cells; testcell; testcell = testcell->next) {
+	db_add(&dbw, testcell, sizeof(cell), DB_CELL);
+	db_add_string(&dbw, testcell->name);
+	db_add_string(&dbw, testcell->function);
+	for (testpin = testcell->pins; testpin; testpin = testpin->next) {
+	    db_add(&dbw, testpin, sizeof(pin), DB_PIN);
+	    db_add_string(&dbw, testpin->name);
+	    db_add_string(&dbw, testpin->alias);
+	    db_add_table(&dbw, testpin->propdelr);
+	    db_add_table(&dbw, testpin->propdelf);
+	    db_add_table(&dbw, testpin->transr);
+	    db_add_table(&dbw, testpin->transf);
+	    db_add_table(&dbw, testpin->minpropdelr);
+	    db_add_table(&dbw, testpin->minpropdelf);
+	    db_add_table(&dbw, testpin->mintransr);
+	    db_add_table(&dbw, testpin->mintransf);
+	    db_add_table(&dbw, testpin->recovery);
+	    db_add_table(&dbw, testpin->removal);
+	}
+    }
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	db_add(&dbw, testnet, sizeof(net), DB_NET);
+	db_add_string(&dbw, testnet->name);
+	db_add(&dbw, testnet->receivers, testnet->fanout * sizeof(connptr), DB_PTRS);
+    }
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	db_add(&dbw, testinst, sizeof(instance), DB_INST);
+	db_add_string(&dbw, testinst->name);
+	db_add_string(&dbw, testinst->cellname);
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+	    db_add_conn(&dbw, testconn);
+	for (testconn = testinst->out_connects; testconn; testconn = testconn->next)
+	    db_add_conn(&dbw, testconn);
+    }
+    for (testconn = inputlist; testconn; testconn = testconn->next)
+	db_add_conn(&dbw, testconn);
+    for (testconn = outputlist; testconn; testconn = testconn->next)
+	db_add_conn(&dbw, testconn);
+    db_add(&dbw, toporder, numtoporder * sizeof(instptr), DB_PTRS);
+    db_add_string(&dbw, topmodule);
+
+    // Copy the objects into the image and convert their pointers
+
+    image = (char *)calloc(dbw.size, 1);
+    for (i = 0; i < dbw.numrecords; i++) {
+	obj = image + dbw.records[i].offset;
+	memcpy(obj, dbw.objects[i], dbw.records[i].size);
+	switch (dbw.records[i].kind) {
+	    case DB_TABLE:
+		((lutableptr)obj)->vecfunc = NULL;
+		((lutableptr)obj)->binfunc = NULL;
+		break;
+	    case DB_CELL:
+		((cellptr)obj)->libindex = -1;
+		break;
+	    case DB_NET:
+		((netptr)obj)->clkdata = NULL;
+		break;
+	    case DB_CONN:
+		((connptr)obj)->tag = NULL;
+		((connptr)obj)->worst = NULL;
+		break;
+	}
+	db_relocate(obj, dbw.records[i].kind, dbw.records[i].size,
+			db_to_offset, &dbw);
     }
 
-    for (testconn = outputlist; testconn; testconn = testconn->next) {
-	testnet = testconn->refnet;
-	testnet->fanout++;
-	if (testnet->receivers == NULL)
-	    testnet->receivers = (connptr *)malloc(sizeof(connptr));
+    header = (dbheader *)image;
+    memcpy(header->magic, DB_MAGIC, 8);
+    header->sizes[0] = sizeof(lutable);
+    header->sizes[1] = sizeof(pin);
+    header->sizes[2] = sizeof(cell);
+    header->sizes[3] = sizeof(net);
+    header->sizes[4] = sizeof(connect);
+    header->sizes[5] = sizeof(instance);
+    header->records = dbw.size;
+    header->numrecords = dbw.numrecords;
+    header->size = dbw.size + dbw.numrecords * sizeof(dbrecord);
+    header->netlist = (size_t)db_to_offset(netlist, &dbw);
+    header->instlist = (size_t)db_to_offset(instlist, &dbw);
+    header->inputlist = (size_t)db_to_offset(inputlist, &dbw);
+    header->outputlist = (size_t)db_to_offset(outputlist, &dbw);
+    header->cells = (size_t)db_to_offset(cells, &dbw);
+    header->tables = (size_t)db_to_offset(tables, &dbw);
+    header->toporder = (size_t)db_to_offset(toporder, &dbw);
+    header->topmodule = (size_t)db_to_offset(topmodule, &dbw);
+    header->numtoporder = numtoporder;
+
+    result = 0;
+    if (dbw.errors > 0) {
+	fprintf(stderr, "Timing database has %d pointers to unsaved objects.\n",
+			dbw.errors);
+	result = 1;
+    }
+    else if ((fwrite(image, 1, dbw.size, fdb) != dbw.size) ||
+		(fwrite(dbw.records, sizeof(dbrecord), dbw.numrecords, fdb) !=
+		dbw.numrecords)) {
+	fprintf(stderr, "Error writing %s\n", dbname);
+	result = 1;
+    }
+    fclose(fdb);
 
-	else 
-	    testnet->receivers = (connptr *)realloc(testnet->receivers,
-			testnet->fanout * sizeof(connptr));
+    if (result == 0)
+	fprintf(stdout, "Saved timing database to %s (%d objects, %llu bytes).\n",
+			dbname, dbw.numrecords, header->size);
 
-	testnet->receivers[testnet->fanout - 1] = testconn;
+    free(image);
+    free(dbw.records);
+    free(dbw.objects);
+    free(dbw.hash);
+    return result;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the size that an object of kind "kind" must have in	*/
+/* a timing database, given its recorded "size".  Strings and	*/
+/* values may have any size, and arrays of pointers any whole	*/
+/* number of pointers.  Return (unsigned long long)-1 for a	*/
+/* kind that does not exist.					*/
+/*--------------------------------------------------------------*/
+
+unsigned long long db_kind_size(int kind, unsigned long long size)
+{
+    switch (kind) {
+	case DB_RAW:
+	    return size;
+	case DB_PTRS:
+	    return size - (size % sizeof(void *));
+	case DB_TABLE:
+	    return sizeof(lutable);
+	case DB_PIN:
+	    return sizeof(pin);
+	case DB_CELL:
+	    return sizeof(cell);
+	case DB_NET:
+	    return sizeof(net);
+	case DB_CONN:
+	    return sizeof(connect);
+	case DB_INST:
+	    return sizeof(instance);
     }
+    return (unsigned long long)-1;
 }
 
 /*--------------------------------------------------------------*/
-/* Delay comparison used by qsort() to sort paths in order from	*/
-/* longest to shortest propagation delay.			*/
+/* Load a timing database saved by save_db() from the file	*/
+/* "dbname".  The file is mapped privately into memory, so the	*/
+/* objects in it can be modified by the analysis, and only the	*/
+/* pointers are converted.					*/
+/*								*/
+/* Return 0 on success, 1 on failure.				*/
 /*--------------------------------------------------------------*/
 
-int
-compdelay(ddataptr *a, ddataptr *b)
+int load_db(char *dbname, netptr *netlist, instptr *instlist, connptr *inputlist,
+		connptr *outputlist, cellptr *cells, lutableptr *tables)
 {
-    ddataptr p = *a;
-    ddataptr q = *b;
+    struct stat st;
+    dbheader *header;
+    dbrecord *records;
+    char *image;
+    unsigned long long i;
+    int fd;
+
+    fd = open(dbname, O_RDONLY);
+    if (fd < 0) {
+	fprintf(stderr, "Cannot open %s for reading\n", dbname);
+	return 1;
+    }
+    if ((fstat(fd, &st) < 0) || (st.st_size < sizeof(dbheader))) {
+	fprintf(stderr, "%s is not a timing database\n", dbname);
+	close(fd);
+	return 1;
+    }
+    image = (char *)mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+	fprintf(stderr, "Cannot map %s: %s\n", dbname, strerror(errno));
+	return 1;
+    }
 
-    if (p->delay < q->delay)
-	return (1);
-    if (p->delay > q->delay)
-	return (-1);
-    return (0);
+    header = (dbheader *)image;
+    if (memcmp(header->magic, DB_MAGIC, 8) || (header->size != st.st_size)) {
+	fprintf(stderr, "%s is not a timing database\n", dbname);
+	munmap(image, st.st_size);
+	return 1;
+    }
+    if ((header->sizes[0] != sizeof(lutable)) || (header->sizes[1] != sizeof(pin)) ||
+		(header->sizes[2] != sizeof(cell)) || (header->sizes[3] != sizeof(net)) ||
+		(header->sizes[4] != sizeof(connect)) ||
+		(header->sizes[5] != sizeof(instance))) {
+	fprintf(stderr, "Timing database %s was written by a different"
+			" version of vesta\n", dbname);
+	munmap(image, st.st_size);
+	return 1;
+    }
+
+    // Check the record table and every record against the file
+    // before converting anything, so that a truncated or damaged
+    // file cannot point outside of the image.
+
+    if ((header->records < sizeof(dbheader)) || (header->records > st.st_size) ||
+		(header->records & 7) || (header->numrecords >
+		(st.st_size - header->records) / sizeof(dbrecord))) {
+	fprintf(stderr, "Timing database %s is damaged (bad record table)\n",
+			dbname);
+	munmap(image, st.st_size);
+	return 1;
+    }
+    records = (dbrecord *)(image + header->records);
+    for (i = 0; i < header->numrecords; i++) {
+	if ((records[i].offset < sizeof(dbheader)) ||
+			(records[i].offset > header->records) ||
+			(records[i].size > header->records - records[i].offset) ||
+			(db_kind_size(records[i].kind, records[i].size) !=
+			records[i].size)) {
+	    fprintf(stderr, "Timing database %s is damaged (bad record %llu)\n",
+			dbname, i);
+	    munmap(image, st.st_size);
+	    return 1;
+	}
+    }
+
+    for (i = 0; i < header->numrecords; i++) {
+	db_relocate(image + records[i].offset, records[i].kind, records[i].size,
+			db_to_pointer, image);
+	if (records[i].kind == DB_TABLE)
+	    table_set_kernels((lutableptr)(image + records[i].offset));
+    }
+
+    *netlist = db_to_pointer((void *)(size_t)header->netlist, image);
+    *instlist = db_to_pointer((void *)(size_t)header->instlist, image);
+    *inputlist = db_to_pointer((void *)(size_t)header->inputlist, image);
+    *outputlist = db_to_pointer((void *)(size_t)header->outputlist, image);
+    *cells = db_to_pointer((void *)(size_t)header->cells, image);
+    *tables = db_to_pointer((void *)(size_t)header->tables, image);
+    toporder = db_to_pointer((void *)(size_t)header->toporder, image);
+    numtoporder = header->numtoporder;
+    topmodule = db_to_pointer((void *)(size_t)header->topmodule, image);
+
+    fprintf(stdout, "Loaded timing database %s (%llu objects).\n", dbname,
+		header->numrecords);
+    return 0;
 }
 
 /*--------------------------------------------------------------*/
@@ -2968,32 +10844,69 @@ main(int objc, char *argv[])
     double outLoad = 0.0;
     double inTrans = 0.0;
     char *delayfile = NULL;
+    char *wlname = NULL;
+    char *drcfile = NULL;
+    char *conespec = NULL;
+    char *conefile = NULL;
+    char *clockfile = NULL;
+    char *deratefile = NULL;
+    char *critfile = NULL;
+    char *slackfile = NULL;
+    char *speffile = NULL;
+    char *pifile = NULL;
+    char *sdffile = NULL;
+    char **pinqueries = NULL;
+    int numqueries = 0;
+    char *savedb = NULL;
+    char *loaddb = NULL;
+    char lazy = 0;
+    char **breaklist = NULL;
+    int numbreaks = 0;
+    char **flatlist = NULL;
+    int numflat = 0;
+    FILE *fdrc, *fclock, *fcrit, *fslack, *fsdf;
     int ival, firstarg = 1;
 
     // Liberty database
 
     lutable *tables = NULL;
     cell *cells = NULL;
+    wireload *wireloads = NULL;
+    wlselect *wlselections = NULL;
+    wireloadptr wlmodel;
+    libreadargs libargs;
+    pthread_t libthread;
+    char libthreaded;
 
     // Verilog netlist database
 
+    moduleptr   modlist = NULL, topmod;
     instptr     instlist = NULL;
-    netptr      netlist = NULL;
+    netptr      netlist = NULL, testnet;
     connlistptr clockconnlist = NULL;
     connlistptr newinputconn, inputconnlist = NULL;
     connptr     testconn, inputlist = NULL;
     connptr     outputlist = NULL;
+    connptr     *clocksinks;
+    instptr     testinst;
+    int		numsinks;
 
     // Timing path database
     ddataptr	pathlist = NULL;
+    groupptr	grouplist = NULL;
     ddataptr	freeddata, testddata, *orderedpaths;
-    btptr	freebt, testbt;
-    int		numpaths, numterms, i;
+    btptr	freebt;
+    int		numpaths, numterms, numasync, numgating, i;
     char	badtiming;
-    double	slack;
+    double	worstdelay, dmax;
 
     verbose = 0;
     exhaustive = 0;
+    cppr = 0;
+    maxpaths = 20;
+    pbapaths = 0;
+    numthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numthreads < 1) numthreads = 1;
 
     while ((firstarg < objc) && (*argv[firstarg] == '-')) {
        if (!strcmp(argv[firstarg], "-d") || !strcmp(argv[firstarg], "--delay")) {
@@ -3004,6 +10917,11 @@ main(int objc, char *argv[])
 	  period = strtod(argv[firstarg + 1], NULL);
 	  firstarg += 2;
        }
+       else if (!strcmp(argv[firstarg], "-n") || !strcmp(argv[firstarg], "--paths")) {
+	  maxpaths = atoi(argv[firstarg + 1]);
+	  if (maxpaths < 1) maxpaths = 1;
+	  firstarg += 2;
+       }
        else if (!strcmp(argv[firstarg], "-l") || !strcmp(argv[firstarg], "--load")) {
 	  outLoad = strtod(argv[firstarg + 1], NULL);
 	  firstarg += 2;
@@ -3012,11 +10930,100 @@ main(int objc, char *argv[])
 	  inTrans = strtod(argv[firstarg + 1], NULL);
 	  firstarg += 2;
        }
+       else if (!strcmp(argv[firstarg], "-w") || !strcmp(argv[firstarg], "--wireload")) {
+	  wlname = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-r") || !strcmp(argv[firstarg], "--drc")) {
+	  drcfile = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-x") || !strcmp(argv[firstarg], "--extract-cone")) {
+	  conespec = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-o") || !strcmp(argv[firstarg], "--cone-out")) {
+	  conefile = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-k") || !strcmp(argv[firstarg], "--clock-report")) {
+	  clockfile = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
        else if (!strcmp(argv[firstarg], "-v") || !strcmp(argv[firstarg], "--verbose")) {
 	  sscanf(argv[firstarg + 1], "%d", &ival);
 	  verbose = (unsigned char)ival;
 	  firstarg += 2;
        }
+       else if (!strcmp(argv[firstarg], "-T") || !strcmp(argv[firstarg], "--fixed-time")) {
+	  fixedtime = 1;
+	  firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-A") || !strcmp(argv[firstarg], "--pba")) {
+	  pbapaths = atoi(argv[firstarg + 1]);
+	  if (pbapaths < 0) pbapaths = 0;
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-j") || !strcmp(argv[firstarg], "--threads")) {
+	  numthreads = atoi(argv[firstarg + 1]);
+	  if (numthreads < 1) numthreads = 1;
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-b") || !strcmp(argv[firstarg], "--break-loop")) {
+	  breaklist = (char **)realloc(breaklist, (numbreaks + 1) * sizeof(char *));
+	  breaklist[numbreaks++] = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-F") || !strcmp(argv[firstarg], "--flatten")) {
+	  flatlist = (char **)realloc(flatlist, (numflat + 1) * sizeof(char *));
+	  flatlist[numflat++] = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-D") || !strcmp(argv[firstarg], "--derate")) {
+	  deratefile = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-s") || !strcmp(argv[firstarg], "--save-db")) {
+	  savedb = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-S") || !strcmp(argv[firstarg], "--load-db")) {
+	  loaddb = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-C") || !strcmp(argv[firstarg], "--criticality")) {
+	  critfile = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-z") || !strcmp(argv[firstarg], "--slack")) {
+	  slackfile = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-P") || !strcmp(argv[firstarg], "--pin-slack")) {
+	  pinqueries = (char **)realloc(pinqueries, (numqueries + 1) * sizeof(char *));
+	  pinqueries[numqueries++] = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-a") || !strcmp(argv[firstarg], "--spef")) {
+	  speffile = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-m") || !strcmp(argv[firstarg], "--pi-model")) {
+	  pifile = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-f") || !strcmp(argv[firstarg], "--sdf")) {
+	  sdffile = strdup(argv[firstarg + 1]);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-c") || !strcmp(argv[firstarg], "--cppr")) {
+	  cppr = 1;
+	  firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-L") || !strcmp(argv[firstarg], "--lazy")) {
+	  lazy = 1;
+	  firstarg++;
+       }
        else if (!strcmp(argv[firstarg], "-e") || !strcmp(argv[firstarg], "--exhaustive")) {
 	  exhaustive = 1;
 	  firstarg++;
@@ -3031,14 +11038,37 @@ main(int objc, char *argv[])
        }
     }
 
-    if (objc - firstarg != 2) {
+    if ((objc - firstarg != 2) && ((loaddb == NULL) || (objc != firstarg))) {
 	fprintf(stderr, "Usage:  vesta [options] <name.v> <name.lib>\n");
+	fprintf(stderr, "        vesta [options] --load-db <file>\n");
 	fprintf(stderr, "Options:\n");
 	fprintf(stderr, "--delay <delay_file>	or	-d <delay_file>\n");
 	fprintf(stderr, "--period <period>	or	-p <period>\n");
+	fprintf(stderr, "--paths <number>	or	-n <number>\n");
 	fprintf(stderr, "--load <load>		or	-l <load>\n");
+	fprintf(stderr, "--wireload <name>	or	-w <name>\n");
+	fprintf(stderr, "--drc <drc_file>	or	-r <drc_file>\n");
+	fprintf(stderr, "--extract-cone <endpoint|N>	or	-x <endpoint|N>\n");
+	fprintf(stderr, "--cone-out <file.v>	or	-o <file.v>\n");
+	fprintf(stderr, "--clock-report <file>	or	-k <file>\n");
 	fprintf(stderr, "--verbose <level>	or	-v <level>\n");
 	fprintf(stderr, "--exhaustive		or 	-e\n");
+	fprintf(stderr, "--lazy			or	-L\n");
+	fprintf(stderr, "--break-loop <inst/pin>	or	-b <inst/pin>\n");
+	fprintf(stderr, "--flatten <inst>	or	-F <inst>\n");
+	fprintf(stderr, "--derate <derate_file>	or	-D <derate_file>\n");
+	fprintf(stderr, "--cppr			or	-c\n");
+	fprintf(stderr, "--criticality <file>	or	-C <file>\n");
+	fprintf(stderr, "--slack <file>		or	-z <file>\n");
+	fprintf(stderr, "--pin-slack <inst/pin>	or	-P <inst/pin>\n");
+	fprintf(stderr, "--spef <file.spef>	or	-a <file.spef>\n");
+	fprintf(stderr, "--pi-model <file>	or	-m <file>\n");
+	fprintf(stderr, "--sdf <file.sdf>	or	-f <file.sdf>\n");
+	fprintf(stderr, "--save-db <file>	or	-s <file>\n");
+	fprintf(stderr, "--load-db <file>	or	-S <file>\n");
+	fprintf(stderr, "--pba <number>		or	-A <number>\n");
+	fprintf(stderr, "--fixed-time		or	-T\n");
+	fprintf(stderr, "--threads <number>	or	-j <number>\n");
 	fprintf(stderr, "--version		or	-V\n");
 	exit (1);
     }
@@ -3051,94 +11081,234 @@ main(int objc, char *argv[])
 	fflush(stdout);
     }
 
-    fsrc = fopen(argv[firstarg], "r");
-    if (fsrc == NULL) {
-	fprintf(stderr, "Cannot open %s for reading\n", argv[firstarg]);
-	exit (1);
+    if (loaddb != NULL) {
+
+	/*------------------------------------------------------------------*/
+	/* Load the linked and annotated timing graph from a		*/
+	/* database saved with --save-db, in place of the netlist	*/
+	/* and liberty files.						*/
+	/*------------------------------------------------------------------*/
+
+	if (load_db(loaddb, &netlist, &instlist, &inputlist, &outputlist,
+			&cells, &tables) != 0)
+	    exit (1);
+	if ((speffile != NULL) || (pifile != NULL) || (delayfile != NULL))
+	    fprintf(stderr, "Warning:  --spef, --pi-model, and --delay are "
+			"ignored with --load-db;  the saved loads are used.\n");
+	if (deratefile != NULL)
+	    fprintf(stderr, "Warning:  --derate is ignored with --load-db;  "
+			"the saved delays keep the derates they were saved with.\n");
     }
+    else {
 
-    flib = fopen(argv[firstarg + 1], "r");
-    if (flib == NULL) {
-	fprintf(stderr, "Cannot open %s for reading\n", argv[firstarg + 1]);
-	exit (1);
-    }
+	fsrc = fopen(argv[firstarg], "r");
+	if (fsrc == NULL) {
+	    fprintf(stderr, "Cannot open %s for reading\n", argv[firstarg]);
+	    exit (1);
+	}
 
-    /*------------------------------------------------------------------*/
-    /* Read the liberty format file.  This is not a rigorous parser!	*/
-    /*------------------------------------------------------------------*/
+	flib = fopen(argv[firstarg + 1], "r");
+	if (flib == NULL) {
+	    fprintf(stderr, "Cannot open %s for reading\n", argv[firstarg + 1]);
+	    exit (1);
+	}
 
-    fileCurrentLine = 0;
-    libertyRead(flib, &tables, &cells);
-    fflush(stdout);
-    fprintf(stdout, "Lib Read:  Processed %d lines.\n", fileCurrentLine);
-    if (flib != NULL) fclose(flib);
+	/*------------------------------------------------------------------*/
+	/* Read the liberty format file.  This is not a rigorous	*/
+	/* parser!  The liberty file is read on a separate thread	*/
+	/* while the verilog netlist is read, and cells are bound	*/
+	/* to instances afterwards.					*/
+	/*------------------------------------------------------------------*/
+
+	libargs.flib = flib;
+	libargs.lazy = lazy;
+	libargs.tables = NULL;
+	libargs.cells = NULL;
+	libargs.wireloads = NULL;
+	libargs.wlselections = NULL;
+	libargs.lines = 0;
+
+	libthreaded = 0;
+	if (numthreads > 1)
+	    if (pthread_create(&libthread, NULL, libertyReadThread, &libargs) == 0)
+		libthreaded = 1;
+	if (!libthreaded) libertyReadThread(&libargs);
+
+	/*------------------------------------------------------------------*/
+	/* Read verilog netlist.  This is also not a rigorous parser!	*/
+	/*------------------------------------------------------------------*/
+
+	fileCurrentLine = 0;
+	verilogRead(fsrc, &modlist);
+	if (fsrc != NULL) fclose(fsrc);
+	topmod = find_top_module(modlist);
+
+	if (libthreaded) pthread_join(libthread, NULL);
+	tables = libargs.tables;
+	cells = libargs.cells;
+	wireloads = libargs.wireloads;
+	wlselections = libargs.wlselections;
 
-    /*--------------------------------------------------*/
-    /* Debug:  Print summary of liberty database	*/
-    /*--------------------------------------------------*/
+	fflush(stdout);
+	fprintf(stdout, "Lib Read:  Processed %d lines.\n", libargs.lines);
+	if ((flib != NULL) && (lazylib == NULL)) fclose(flib);
 
-    if (verbose > 2) {
+	/*--------------------------------------------------*/
+	/* Debug:  Print summary of liberty database	*/
+	/*--------------------------------------------------*/
 
-	lutable *newtable;
-	cell *newcell;
-	pin *newpin;
+	if (verbose > 2) {
 
-	for (newtable = tables; newtable; newtable = newtable->next) {
-	    fprintf(stdout, "Table: %s\n", newtable->name);
-	}
+	    lutable *newtable;
+	    cell *newcell;
+	    pin *newpin;
 
-	for (newcell = cells; newcell; newcell = newcell->next) {
-	    fprintf(stdout, "Cell: %s\n", newcell->name);
-	    fprintf(stdout, "   Function: %s\n", newcell->function);
-	    for (newpin = newcell->pins; newpin; newpin = newpin->next) {
-		if (newpin->type == INPUT)
-		    fprintf(stdout, "   Pin: %s  cap=%g\n", newpin->name, newpin->capr);
+	    for (newtable = tables; newtable; newtable = newtable->next) {
+		fprintf(stdout, "Table: %s\n", newtable->name);
+	    }
+
+	    for (newcell = cells; newcell; newcell = newcell->next) {
+		fprintf(stdout, "Cell: %s\n", newcell->name);
+		fprintf(stdout, "   Function: %s\n", newcell->function);
+		for (newpin = newcell->pins; newpin; newpin = newpin->next) {
+		    if (newpin->type == INPUT)
+			fprintf(stdout, "   Pin: %s  cap=%g\n", newpin->name, newpin->capr);
+		}
+		fprintf(stdout, "\n");
 	    }
-	    fprintf(stdout, "\n");
 	}
-    }
 
-    /*------------------------------------------------------------------*/
-    /* Read verilog netlist.  This is also not a rigorous parser!	*/
-    /*------------------------------------------------------------------*/
+	/*------------------------------------------------------------------*/
+	/* Bind cell and pin names in the netlist to the liberty data	*/
+	/*------------------------------------------------------------------*/
 
-    fileCurrentLine = 0;
-    verilogRead(fsrc, cells, &netlist, &instlist, &inputlist, &outputlist);
-    fflush(stdout);
-    fprintf(stdout, "Verilog netlist read:  Processed %d lines.\n", fileCurrentLine);
-    if (fsrc != NULL) fclose(fsrc);
+	fflush(stdout);
+	fprintf(stdout, "Verilog netlist read:  Processed %d lines.\n", fileCurrentLine);
+
+	/*--------------------------------------------------*/
+	/* Read on-chip variation derates, which apply	*/
+	/* to the timing models of submodules		*/
+	/*--------------------------------------------------*/
+
+	if (deratefile != NULL)
+	    if (readDerates(deratefile, cells) > 0)
+		fprintf(stderr, "Errors found in derate file %s.\n", deratefile);
+
+	/*--------------------------------------------------*/
+	/* Replace instances of submodules by their	*/
+	/* timing models, or flatten them		*/
+	/*--------------------------------------------------*/
+
+	if (topmod != NULL) {
+	    if (expand_hierarchy(topmod, modlist, &cells, flatlist, numflat,
+			wireloads, wlselections, wlname) != 0)
+		exit (1);
+	    netlist = topmod->netlist;
+	    instlist = topmod->instlist;
+	    inputlist = topmod->inputlist;
+	    outputlist = topmod->outputlist;
+	}
+	bindCells(cells, &instlist);
 
-    /*--------------------------------------------------*/
-    /* Debug:  Print summary of verilog source		*/
-    /*--------------------------------------------------*/
+	if (lazylib != NULL) {
+	    fprintf(stdout, "Parsed %d of %d liberty cells.\n", lazylib->numparsed,
+		    lazylib->numcells);
+	    fclose(lazylib->file);
+	    lazylib->file = NULL;
+	}
 
-    if (verbose > 1) {
-	connect *testoutput;
-	connect *testinput;
-	net *testnet;
-	instance *testinst;
+	/*--------------------------------------------------*/
+	/* Debug:  Print summary of verilog source		*/
+	/*--------------------------------------------------*/
 
-	for (testinput = inputlist; testinput; testinput = testinput->next) {
-	    if (testinput->refnet)
-		fprintf(stdout, "   Input: %s\n", testinput->refnet->name);
-	}
-	for (testoutput = outputlist; testoutput; testoutput = testoutput->next) {
-	    if (testoutput->refnet)
-		fprintf(stdout, "   Output: %s\n", testoutput->refnet->name);
-	}
-	for (testnet = netlist; testnet; testnet = testnet->next) {
-	    fprintf(stdout, "   Net: %s\n", testnet->name);
+	if (verbose > 1) {
+	    connect *testoutput;
+	    connect *testinput;
+	    net *testnet;
+	    instance *testinst;
+
+	    for (testinput = inputlist; testinput; testinput = testinput->next) {
+		if (testinput->refnet)
+		    fprintf(stdout, "   Input: %s\n", testinput->refnet->name);
+	    }
+	    for (testoutput = outputlist; testoutput; testoutput = testoutput->next) {
+		if (testoutput->refnet)
+		    fprintf(stdout, "   Output: %s\n", testoutput->refnet->name);
+	    }
+	    for (testnet = netlist; testnet; testnet = testnet->next) {
+		fprintf(stdout, "   Net: %s\n", testnet->name);
+	    }
+	    for (testinst = instlist; testinst; testinst = testinst->next) {
+		fprintf(stdout, "   Gate: %s\n", testinst->name);
+	    }
 	}
-	for (testinst = instlist; testinst; testinst = testinst->next) {
-	    fprintf(stdout, "   Gate: %s\n", testinst->name);
+
+	/*--------------------------------------------------*/
+	/* Generate internal links representing the network	*/
+	/*--------------------------------------------------*/
+
+	createLinks(netlist, instlist, inputlist, outputlist);
+
+	/*--------------------------------------------------*/
+	/* Find and break combinational loops		*/
+	/*--------------------------------------------------*/
+
+	for (i = 0; i < numbreaks; i++) {
+	    char *pinname = strrchr(breaklist[i], '/');
+
+	    if (pinname != NULL) *pinname++ = '\0';
+	    for (testinst = instlist; testinst; testinst = testinst->next)
+		if (!strcmp(testinst->name, breaklist[i]))
+		    break;
+	    testconn = NULL;
+	    if ((testinst != NULL) && (pinname != NULL))
+		for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+		    if (!strcmp(testconn->refpin->name, pinname))
+			break;
+	    if (testconn == NULL)
+		fprintf(stderr, "No input pin \"%s/%s\" for --break-loop\n",
+			    breaklist[i], (pinname) ? pinname : "");
+	    else
+		testconn->flags |= CONN_PREFER;
 	}
+	i = break_loops(instlist);
+	if (i > 0)
+	    fprintf(stdout, "Broke %d combinational loop%s.\n", i, (i == 1) ? "" : "s");
+
+	/*--------------------------------------------------*/
+	/* Read wire parasitics, if given			*/
+	/*--------------------------------------------------*/
+
+	if (speffile != NULL)
+	    if (readSPEF(speffile, netlist, instlist, outLoad) != 0)
+		exit (1);
+	if (pifile != NULL)
+	    if (readPiModels(pifile, netlist) > 0)
+		fprintf(stderr, "Errors found in pi model file %s.\n", pifile);
+	if (delayfile != NULL)
+	    if (readDelays(delayfile, netlist) > 0)
+		fprintf(stderr, "Errors found in wire delay file %s.\n", delayfile);
+
+	/*--------------------------------------------------*/
+	/* Calculate total load on each net, including the	*/
+	/* parasitics from SPEF or the wire load model		*/
+	/* estimate, if there is one.				*/
+	/*--------------------------------------------------*/
+
+	wlmodel = select_wireload(wireloads, wlselections, wlname, instlist);
+	if (wlmodel != NULL)
+	    fprintf(stdout, "Using wire load model \"%s\".\n", wlmodel->name);
+
+	computeLoads(netlist, instlist, outLoad, wlmodel);
     }
 
-    /*--------------------------------------------------*/
-    /* Generate internal links representing the network	*/
-    /*--------------------------------------------------*/
+    /* Wire delays join the fixed time steps of the cell delays */
 
-    createLinks(netlist, instlist, inputlist, outputlist);
+    if (fixedtime)
+	for (testnet = netlist; testnet; testnet = testnet->next)
+	    for (i = 0; i < testnet->fanout; i++)
+		testnet->receivers[i]->wiredelay =
+			fixed_time(testnet->receivers[i]->wiredelay);
 
     /* Generate a connection list from inputlist */
 
@@ -3149,12 +11319,6 @@ main(int objc, char *argv[])
 	inputconnlist = newinputconn;
     }
 
-    /*--------------------------------------------------*/
-    /* Calculate total load on each net			*/
-    /* To do:  Add wire models or computed wire delays	*/
-    /*--------------------------------------------------*/
-
-    computeLoads(netlist, instlist, outLoad);
 
     /*--------------------------------------------------*/
     /* Assign net types, mainly to identify clocks	*/
@@ -3163,64 +11327,61 @@ main(int objc, char *argv[])
 
     numterms = assign_net_types(netlist, &clockconnlist);
 
+    /*--------------------------------------------------*/
+    /* Save the timing graph for later analysis		*/
+    /*--------------------------------------------------*/
+
+    if (savedb != NULL)
+	if (save_db(savedb, netlist, instlist, inputlist, outputlist, cells,
+			tables) != 0)
+	    fprintf(stderr, "Failed to save timing database %s.\n", savedb);
+
     if (verbose > 1) 
 	fprintf(stdout, "Number of terminals to check: %d\n", numterms);
 
     /*--------------------------------------------------*/
-    /* Identify all clock-to-terminal paths		*/
+    /* Propagate clock latencies through the clock	*/
+    /* network (also the latencies of generated	*/
+    /* clocks), and report insertion delay and skew	*/
     /*--------------------------------------------------*/
 
-    numpaths = find_clock_to_term_paths(clockconnlist, &pathlist, netlist, MAXIMUM_TIME);
-    fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
+    numsinks = compute_clock_network(instlist, &clocksinks);
+    if (clockfile != NULL) {
+	fclock = fopen(clockfile, "w");
+	if (fclock == NULL)
+	    fprintf(stderr, "Cannot open %s for writing\n", clockfile);
+	else {
+	    report_clocks(clocksinks, numsinks, fclock);
+	    fclose(fclock);
+	}
+    }
+    free(clocksinks);
+    compute_launch_times(instlist, period);
 
     /*--------------------------------------------------*/
-    /* Collect paths into a non-linked array so that	*/
-    /* they can be sorted by delay time			*/
+    /* Find the time borrowed through latches, which	*/
+    /* moves the start of the paths from their outputs	*/
     /*--------------------------------------------------*/
 
-    orderedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
+    compute_latch_timing(netlist, instlist, period);
 
-    i = 0;
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
-       orderedpaths[i] = testddata;
-       i++;
-    }
+    /*--------------------------------------------------*/
+    /* Identify all clock-to-terminal paths, grouped	*/
+    /* by clock and path type as they are found		*/
+    /*--------------------------------------------------*/
 
-    qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
+    numpaths = find_clock_to_term_paths(clockconnlist, &pathlist, netlist, &grouplist,
+		period, MAXIMUM_TIME);
+    fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
 
     /*--------------------------------------------------*/
-    /* Report on top 20 maximum delay paths		*/
+    /* Report on top maximum delay paths of each group	*/
     /*--------------------------------------------------*/
 
-    fprintf(stdout, "\nTop %d maximum delay paths:\n", (numpaths >= 20) ? 20 : numpaths);
-    badtiming = 0;
-    for (i = 0; ((i < 20) && (i < numpaths)); i++) {
-	testddata = orderedpaths[i];
-	for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
-		
-	if (testddata->backtrace->receiver->refinst != NULL) {
-	    fprintf(stdout, "Path %s/%s to %s/%s delay %g ps",
-			testbt->receiver->refinst->name,
-			testbt->receiver->refpin->name,
-			testddata->backtrace->receiver->refinst->name,
-			testddata->backtrace->receiver->refpin->name,
-			testddata->delay);
-	}
-	else {
-	    fprintf(stdout, "Path %s/%s to output pin %s delay %g ps",
-			testbt->receiver->refinst->name,
-			testbt->receiver->refpin->name,
-			testddata->backtrace->receiver->refnet->name,
-			testddata->delay);
-	}
-
-	if (period > 0.0) {
-	    slack = period - testddata->delay;
-	    fprintf(stdout, "   Slack = %g ps", slack);
-	    if (slack < 0.0) badtiming = 1;
-	}
-	fprintf(stdout, "\n");
-    }
+    badtiming = report_path_groups(grouplist, MAXIMUM_TIME, period, &worstdelay);
+    if (pbapaths > 0) report_pba(pathlist, MAXIMUM_TIME, period);
+    free_path_groups(grouplist);
+    grouplist = NULL;
 
     if (period > 0.0) {
 	if (badtiming) {
@@ -3230,13 +11391,46 @@ main(int objc, char *argv[])
 	    fprintf(stdout, "Design meets timing requirements.\n");
 	}
     }
-    else if (orderedpaths[0] != NULL) {
+    else if (worstdelay > 0.0) {
 	fprintf(stdout, "Computed maximum clock frequency (zero slack) = %g MHz\n",
-		(1.0E6 / orderedpaths[0]->delay));
+		(1.0E6 / worstdelay));
     }
     fprintf(stdout, "-----------------------------------------\n\n");
     fflush(stdout);
 
+    /*--------------------------------------------------*/
+    /* Extract the fan-in cone of the requested		*/
+    /* endpoints to a separate verilog netlist.  The	*/
+    /* paths are sorted by delay time to find the worst	*/
+    /* paths of the whole design.			*/
+    /*--------------------------------------------------*/
+
+    if (conespec != NULL) {
+	orderedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
+
+	i = 0;
+	for (testddata = pathlist; testddata; testddata = testddata->next) {
+	   orderedpaths[i] = testddata;
+	   i++;
+	}
+
+	qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
+
+	if (conefile == NULL) {
+	    char *dotptr;
+	    char *srcname = (loaddb != NULL) ? loaddb : argv[firstarg];
+	    conefile = (char *)malloc(strlen(srcname) + 8);
+	    strcpy(conefile, srcname);
+	    dotptr = strrchr(conefile, '.');
+	    if ((dotptr != NULL) && !strcmp(dotptr, ".v")) *dotptr = '\0';
+	    strcat(conefile, "_cone.v");
+	}
+	extract_cone(conespec, orderedpaths, numpaths, netlist, instlist,
+		outputlist, conefile);
+	fprintf(stdout, "\n");
+	free(orderedpaths);
+    }
+
     /*--------------------------------------------------*/
     /* Clean up the path list				*/
     /*--------------------------------------------------*/
@@ -3253,58 +11447,23 @@ main(int objc, char *argv[])
 	free(freeddata);
     }
 
-    free(orderedpaths);
-
     /*--------------------------------------------------*/
     /* Now calculate minimum delay paths		*/
     /*--------------------------------------------------*/
 
-    numpaths = find_clock_to_term_paths(clockconnlist, &pathlist, netlist, MINIMUM_TIME);
+    numpaths = find_clock_to_term_paths(clockconnlist, &pathlist, netlist, &grouplist,
+		period, MINIMUM_TIME);
     fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
 
     /*--------------------------------------------------*/
-    /* Collect paths into a non-linked array so that	*/
-    /* they can be sorted by delay time			*/
-    /*--------------------------------------------------*/
-
-    orderedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
-
-    i = 0;
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
-       orderedpaths[i] = testddata;
-       i++;
-    }
-
-    qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
-
-    /*--------------------------------------------------*/
-    /* Report on top 20 minimum delay paths		*/
+    /* Report on top minimum delay paths of each group	*/
     /*--------------------------------------------------*/
 
-    fprintf(stdout, "\nTop %d minimum delay paths:\n", (numpaths >= 20) ? 20 : numpaths);
-    badtiming = 0;
-    for (i = numpaths; (i > (numpaths - 20)) && (i > 0); i--) {
-	testddata = orderedpaths[i - 1];
-	for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
-		
-	if (testddata->backtrace->receiver->refinst != NULL) {
-	    fprintf(stdout, "Path %s/%s to %s/%s delay %g ps\n",
-			testbt->receiver->refinst->name,
-			testbt->receiver->refpin->name,
-			testddata->backtrace->receiver->refinst->name,
-			testddata->backtrace->receiver->refpin->name,
-			testddata->delay);
-	}
-	else {
-	    fprintf(stdout, "Path %s/%s to output pin %s delay %g ps\n",
-			testbt->receiver->refinst->name,
-			testbt->receiver->refpin->name,
-			testddata->backtrace->receiver->refnet->name,
-			testddata->delay);
-	}
+    badtiming = report_path_groups(grouplist, MINIMUM_TIME, period, &worstdelay);
+    if (pbapaths > 0) report_pba(pathlist, MINIMUM_TIME, period);
+    free_path_groups(grouplist);
+    grouplist = NULL;
 
-	if (testddata->delay < 0.0) badtiming = 1;
-    }
     if (badtiming)
 	fprintf(stdout, "ERROR:  Design fails minimum hold timing.\n");
     else
@@ -3329,8 +11488,6 @@ main(int objc, char *argv[])
 	free(freeddata);
     }
 
-    free(orderedpaths);
-
     for (testconn = inputlist; testconn; testconn = testconn->next) {
 	testconn->tag = NULL;
 	testconn->metric = -1;
@@ -3340,47 +11497,18 @@ main(int objc, char *argv[])
     /* Identify all input-to-terminal paths		*/
     /*--------------------------------------------------*/
 
-    numpaths = find_clock_to_term_paths(inputconnlist, &pathlist, netlist, MAXIMUM_TIME);
+    numpaths = find_clock_to_term_paths(inputconnlist, &pathlist, netlist, &grouplist,
+		period, MAXIMUM_TIME);
     fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
 
     /*--------------------------------------------------*/
-    /* Collect paths into a non-linked array so that	*/
-    /* they can be sorted by delay time			*/
-    /*--------------------------------------------------*/
-
-    orderedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
-
-    i = 0;
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
-       orderedpaths[i] = testddata;
-       i++;
-    }
-
-    qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
-
-    /*--------------------------------------------------*/
-    /* Report on top 20 maximum delay paths		*/
+    /* Report on top maximum delay paths of each group	*/
     /*--------------------------------------------------*/
 
-    fprintf(stdout, "\nTop %d maximum delay paths:\n", (numpaths >= 20) ? 20 : numpaths);
-    for (i = 0; ((i < 20) && (i < numpaths)); i++) {
-	testddata = orderedpaths[i];
-	for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
-		
-	if (testddata->backtrace->receiver->refinst != NULL) {
-	    fprintf(stdout, "Path input pin %s to %s/%s delay %g ps\n",
-			testbt->receiver->refnet->name,
-			testddata->backtrace->receiver->refinst->name,
-			testddata->backtrace->receiver->refpin->name,
-			testddata->delay);
-	}
-	else {
-	    fprintf(stdout, "Path input pin %s to output pin %s delay %g ps\n",
-			testbt->receiver->refnet->name,
-			testddata->backtrace->receiver->refnet->name,
-			testddata->delay);
-	}
-    }
+    report_path_groups(grouplist, MAXIMUM_TIME, period, &worstdelay);
+    if (pbapaths > 0) report_pba(pathlist, MAXIMUM_TIME, period);
+    free_path_groups(grouplist);
+    grouplist = NULL;
 
     fprintf(stdout, "-----------------------------------------\n\n");
     fflush(stdout);
@@ -3401,8 +11529,6 @@ main(int objc, char *argv[])
 	free(freeddata);
     }
 
-    free(orderedpaths);
-
     for (testconn = inputlist; testconn; testconn = testconn->next) {
 	testconn->tag = NULL;
 	testconn->metric = 1E50;
@@ -3412,47 +11538,18 @@ main(int objc, char *argv[])
     /* Now calculate minimum delay paths from inputs	*/
     /*--------------------------------------------------*/
 
-    numpaths = find_clock_to_term_paths(inputconnlist, &pathlist, netlist, MINIMUM_TIME);
+    numpaths = find_clock_to_term_paths(inputconnlist, &pathlist, netlist, &grouplist,
+		period, MINIMUM_TIME);
     fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
 
     /*--------------------------------------------------*/
-    /* Collect paths into a non-linked array so that	*/
-    /* they can be sorted by delay time			*/
-    /*--------------------------------------------------*/
-
-    orderedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
-
-    i = 0;
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
-       orderedpaths[i] = testddata;
-       i++;
-    }
-
-    qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
-
-    /*--------------------------------------------------*/
-    /* Report on top 20 minimum delay paths		*/
+    /* Report on top minimum delay paths of each group	*/
     /*--------------------------------------------------*/
 
-    fprintf(stdout, "\nTop %d minimum delay paths:\n", (numpaths >= 20) ? 20 : numpaths);
-    for (i = numpaths; (i > (numpaths - 20)) && (i > 0); i--) {
-	testddata = orderedpaths[i - 1];
-	for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
-		
-	if (testddata->backtrace->receiver->refinst != NULL) {
-	    fprintf(stdout, "Path input pin %s to %s/%s delay %g ps\n",
-			testbt->receiver->refnet->name,
-			testddata->backtrace->receiver->refinst->name,
-			testddata->backtrace->receiver->refpin->name,
-			testddata->delay);
-	}
-	else {
-	    fprintf(stdout, "Path input pin %s to output pin %s delay %g ps\n",
-			testbt->receiver->refnet->name,
-			testddata->backtrace->receiver->refnet->name,
-			testddata->delay);
-	}
-    }
+    report_path_groups(grouplist, MINIMUM_TIME, period, &worstdelay);
+    if (pbapaths > 0) report_pba(pathlist, MINIMUM_TIME, period);
+    free_path_groups(grouplist);
+    grouplist = NULL;
 
     fprintf(stdout, "-----------------------------------------\n\n");
     fflush(stdout);
@@ -3473,7 +11570,88 @@ main(int objc, char *argv[])
 	free(freeddata);
     }
 
-    free(orderedpaths);
+    /*--------------------------------------------------*/
+    /* Report design rule violations, with the worst	*/
+    /* transition times from the arrival time pass	*/
+    /*--------------------------------------------------*/
+
+    compute_arrival_times(netlist, instlist);
+
+    fdrc = NULL;
+    if (drcfile != NULL) {
+	fdrc = fopen(drcfile, "w");
+	if (fdrc == NULL)
+	    fprintf(stderr, "Cannot open %s for writing\n", drcfile);
+    }
+    report_drc(netlist, fdrc);
+    if (fdrc != NULL) fclose(fdrc);
+
+    /*--------------------------------------------------*/
+    /* Check recovery and removal times at the		*/
+    /* asynchronous set and reset inputs of flops	*/
+    /*--------------------------------------------------*/
+
+    numasync = check_async_timing(netlist, instlist, period);
+
+    /*--------------------------------------------------*/
+    /* Check setup and hold at clock gating inputs	*/
+    /*--------------------------------------------------*/
+
+    numgating = check_gating_timing(netlist, instlist, period, numasync);
+
+    /*--------------------------------------------------*/
+    /* Propagate arrival times forward and required	*/
+    /* times backward, and write the criticality of	*/
+    /* each net and the slack of each pin		*/
+    /*--------------------------------------------------*/
+
+    if ((critfile != NULL) || (slackfile != NULL) || (numqueries > 0) ||
+		(sdffile != NULL)) {
+	if ((numasync == 0) && (numgating == 0)) compute_arrival_times(netlist, instlist);
+	dmax = compute_required_times(netlist, period);
+
+	if (sdffile != NULL) {
+	    fsdf = fopen(sdffile, "w");
+	    if (fsdf == NULL)
+		fprintf(stderr, "Cannot open %s for writing\n", sdffile);
+	    else {
+		setvbuf(fsdf, NULL, _IOFBF, 1 << 20);
+		write_sdf(netlist, instlist, fsdf);
+		fclose(fsdf);
+	    }
+	}
+
+	if (critfile != NULL) {
+	    fcrit = fopen(critfile, "w");
+	    if (fcrit == NULL)
+		fprintf(stderr, "Cannot open %s for writing\n", critfile);
+	    else {
+		write_criticality(netlist, dmax, fcrit);
+		fclose(fcrit);
+	    }
+	}
+
+	if (slackfile != NULL) {
+	    fslack = fopen(slackfile, "w");
+	    if (fslack == NULL)
+		fprintf(stderr, "Cannot open %s for writing\n", slackfile);
+	    else {
+		write_slack(instlist, inputlist, outputlist, fslack);
+		fclose(fslack);
+	    }
+	}
+
+	if (numqueries > 0)
+	    fprintf(stdout, "# pin\tedge\tarrival\trequired\tslack"
+			"\tmin_arrival\tmin_required\thold_slack\n");
+	for (i = 0; i < numqueries; i++) {
+	    testconn = find_pin(pinqueries[i], instlist, inputlist, outputlist);
+	    if (testconn == NULL)
+		fprintf(stderr, "No pin \"%s\" for --pin-slack\n", pinqueries[i]);
+	    else
+		write_pin_slack(testconn, stdout);
+	}
+    }
 
     return 0;
 }